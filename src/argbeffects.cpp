@@ -0,0 +1,118 @@
+#include "argbeffects.h"
+
+/* argbeffects.cpp */
+
+static const char* const effectNames[EFFECT_COUNT] = {
+    "SOLID", "BREATHE", "CHASE", "STROBE", "BLINK", "FADE", "RAINBOW"
+};
+
+static const uint16_t effectPeriods[EFFECT_SPEEDS] = {
+    8000, 6000, 4000, 3000, 2000, 1500, 1000, 750, 500, 400, 300, 250, 200, 150, 100, 50
+};
+
+const char* effectName(uint8_t effect) {
+    return (effect < EFFECT_COUNT) ? effectNames[effect] : "?";
+}
+
+uint16_t effectPeriodMs(uint8_t speed) {
+    return effectPeriods[speed & (EFFECT_SPEEDS - 1)];
+}
+
+uint8_t effectPhaseAt(uint32_t clockMs, uint8_t speed) {
+    const uint32_t period = effectPeriodMs(speed);
+    return (uint8_t)(((clockMs % period) * EFFECT_PHASE_STEPS) / period);
+}
+
+uint32_t effectOrigin(uint32_t rxMs, uint8_t phase, uint8_t speed) {
+    const uint32_t period = effectPeriodMs(speed);
+    return rxMs - ((uint32_t)(phase & (EFFECT_PHASE_STEPS - 1)) * period) / EFFECT_PHASE_STEPS;
+}
+
+bool encodeEffectFrame(uint32_t node, const EffectCommand& cmd, uint8_t out[EFFECT_FRAME_DLC]) {
+    if (cmd.effect >= EFFECT_COUNT || cmd.speed >= EFFECT_SPEEDS) return false;
+    if (cmd.colourA >= 32 || cmd.colourB >= 32 || cmd.phase >= EFFECT_PHASE_STEPS) return false;
+
+    out[0] = (uint8_t)(node >> 24);
+    out[1] = (uint8_t)(node >> 16);
+    out[2] = (uint8_t)(node >> 8);
+    out[3] = (uint8_t)node;
+    out[4] = cmd.stripMask;
+    out[5] = (uint8_t)((cmd.effect << 4) | cmd.speed);
+    out[6] = (uint8_t)((cmd.colourA << 3) | (cmd.phase >> 3));
+    out[7] = (uint8_t)((cmd.colourB << 3) | (cmd.phase & 0x07));
+    return true;
+}
+
+bool decodeEffectFrame(const uint8_t* data, uint8_t dlc, uint32_t* node, EffectCommand* cmd) {
+    if (dlc < EFFECT_FRAME_DLC) return false;
+    if ((data[5] >> 4) >= EFFECT_COUNT) return false;
+
+    *node = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+    cmd->stripMask = data[4];
+    cmd->effect = data[5] >> 4;
+    cmd->speed = data[5] & 0x0F;
+    cmd->colourA = data[6] >> 3;
+    cmd->colourB = data[7] >> 3;
+    cmd->phase = (uint8_t)(((data[6] & 0x07) << 3) | (data[7] & 0x07));
+    return true;
+}
+
+/** @brief b + (a - b) * level / 255 per channel */
+static EffectRgb mix(const EffectRgb& a, const EffectRgb& b, uint8_t level) {
+    EffectRgb c;
+    c.r = (uint8_t)(b.r + ((int16_t)(a.r - b.r) * level) / 255);
+    c.g = (uint8_t)(b.g + ((int16_t)(a.g - b.g) * level) / 255);
+    c.b = (uint8_t)(b.b + ((int16_t)(a.b - b.b) * level) / 255);
+    return c;
+}
+
+/** @brief Hue 0..255 around the wheel at full saturation and value */
+static EffectRgb wheel(uint8_t hue) {
+    const uint8_t sector = hue / 43;
+    const uint8_t f = (uint8_t)((hue - sector * 43) * 6);
+    EffectRgb c;
+    switch (sector) {
+        case 0:  c.r = 255;     c.g = f;       c.b = 0;       break;
+        case 1:  c.r = 255 - f; c.g = 255;     c.b = 0;       break;
+        case 2:  c.r = 0;       c.g = 255;     c.b = f;       break;
+        case 3:  c.r = 0;       c.g = 255 - f; c.b = 255;     break;
+        case 4:  c.r = f;       c.g = 0;       c.b = 255;     break;
+        default: c.r = 255;     c.g = 0;       c.b = 255 - f; break;
+    }
+    return c;
+}
+
+EffectRgb effectPixel(uint8_t effect, uint8_t speed, const EffectRgb& a, const EffectRgb& b,
+                      uint32_t tMs, uint16_t pixel, uint16_t pixels) {
+    const uint32_t period = effectPeriodMs(speed);
+    const uint32_t pos = tMs % period;            /* 0..period-1 */
+    const uint32_t p256 = (pos * 256) / period;   /* 0..255 */
+    if (pixels == 0) pixels = 1;
+
+    switch (effect) {
+        case EFFECT_BREATHE: {
+            const uint32_t tri = (p256 < 128) ? p256 * 2 : (255 - p256) * 2 + 1; /* 0..255..0 */
+            return mix(a, b, (uint8_t)((tri * tri) / 255)); /* eased: dwell dim, swell bright */
+        }
+        case EFFECT_CHASE: {
+            const uint16_t width = (pixels >= 8) ? pixels / 8 : 1;
+            const uint32_t head = (pos * pixels) / period;
+            const uint32_t behind = (head + pixels - pixel) % pixels; /* 0 = head */
+            if (behind > width) return b;
+            return mix(a, b, (uint8_t)(255 - (behind * 255) / (width + 1)));
+        }
+        case EFFECT_STROBE:
+            return (p256 < 32) ? a : b;
+        case EFFECT_BLINK:
+            return (p256 < 128) ? a : b;
+        case EFFECT_FADE: {
+            const uint32_t tri = (p256 < 128) ? p256 * 2 : (255 - p256) * 2 + 1;
+            return mix(b, a, (uint8_t)tri); /* A at the cycle start, B half way */
+        }
+        case EFFECT_RAINBOW:
+            return wheel((uint8_t)(p256 + (pixel * 256UL) / pixels));
+        case EFFECT_SOLID:
+        default:
+            return a;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef ARGBEFFECTS_H_
+#define ARGBEFFECTS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* argbeffects.h - parametric ARGB strip effects, rendered on the node.
+ *
+ * One command frame starts an effect on any set of a node's strips; the
+ * node then animates locally, so the bus carries one frame per change
+ * instead of a colour frame per animation step:
+ *
+ *   EFFECT [0..3]=node ID, big endian [4]=strip mask (bit n = strip n)
+ *          [5]=effect (bits 7..4) | speed (bits 3..0)
+ *          [6]=colour A palette index (bits 7..3) | phase bits 5..3
+ *          [7]=colour B palette index (bits 7..3) | phase bits 2..0
+ *
+ * Phase: the sender stamps where its own effect clock is in the period,
+ * in 64ths (effectPhaseAt()). The node starts the effect at that phase on
+ * receipt, so every node commanded from the same sender runs in step,
+ * whenever its frame went out, to within 1/64 of a period plus bus latency.
+ *
+ * effectPixel() is the reference the nodes and the CYD preview share:
+ * integer arithmetic only, so both compute the same colours. No Arduino
+ * dependency.
+ */
+
+#define EFFECT_FRAME_DLC    8
+#define EFFECT_SPEEDS       16
+#define EFFECT_PHASE_STEPS  64
+#define EFFECT_MAX_STRIPS   8   /**< Bits in the strip mask */
+
+/** --- Effects --- */
+enum EffectType { EFFECT_SOLID = 0,  /**< Colour A */
+                  EFFECT_BREATHE,    /**< B -> A -> B, eased */
+                  EFFECT_CHASE,      /**< Segment of A with a fading tail running over B */
+                  EFFECT_STROBE,     /**< A for 1/8 of the period, B otherwise */
+                  EFFECT_BLINK,      /**< A for half the period, B for the other half */
+                  EFFECT_FADE,       /**< Linear A <-> B */
+                  EFFECT_RAINBOW,    /**< Hue wheel across the strip; colours unused */
+                  EFFECT_COUNT
+                };
+
+/**
+ * @struct EffectRgb
+ * @brief One LED colour
+ */
+struct EffectRgb {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+/**
+ * @struct EffectCommand
+ * @brief Decoded content of an effect frame
+ */
+struct EffectCommand {
+    uint8_t stripMask;
+    uint8_t effect;   /**< EffectType */
+    uint8_t speed;    /**< 0 (slowest) .. 15 */
+    uint8_t colourA;  /**< Palette index 0..31 */
+    uint8_t colourB;
+    uint8_t phase;    /**< 0..63, in 64ths of the period */
+};
+
+/** @brief Short effect name for the UI */
+const char* effectName(uint8_t effect);
+
+/** @brief Period of one effect cycle for a speed step, 8000 ms down to 50 ms. */
+uint16_t effectPeriodMs(uint8_t speed);
+
+/** @brief Phase (0..63) of a free-running clock at clockMs; the sender's stamp. */
+uint8_t effectPhaseAt(uint32_t clockMs, uint8_t speed);
+
+/**
+ * @brief Local time that counts as phase 0, for a command received at rxMs.
+ * @details Effect time for effectPixel() is then (now - origin).
+ */
+uint32_t effectOrigin(uint32_t rxMs, uint8_t phase, uint8_t speed);
+
+/**
+ * @brief Builds an effect frame.
+ * @return false if a field is out of range.
+ */
+bool encodeEffectFrame(uint32_t node, const EffectCommand& cmd, uint8_t out[EFFECT_FRAME_DLC]);
+
+/** @brief Parses an effect frame; false if it is short or malformed. */
+bool decodeEffectFrame(const uint8_t* data, uint8_t dlc, uint32_t* node, EffectCommand* cmd);
+
+/**
+ * @brief Colour of one LED.
+ * @param a Colour A as RGB, b colour B as RGB (the caller resolves palette indices)
+ * @param tMs Time since the effect origin
+ * @param pixel LED index, pixels LEDs on the strip
+ */
+EffectRgb effectPixel(uint8_t effect, uint8_t speed, const EffectRgb& a, const EffectRgb& b,
+                      uint32_t tMs, uint16_t pixel, uint16_t pixels);
+
+/**
+ * @brief Whether an effect can change from one moment to the next (SOLID cannot).
+ */
+inline bool effectAnimates(uint8_t effect) { return effect != EFFECT_SOLID && effect < EFFECT_COUNT; }
+
+#endif /* END ARGBEFFECTS_H_ */
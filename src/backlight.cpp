@@ -0,0 +1,252 @@
+#include "backlight.h"
+
+#if defined(ARDUINO)
+#include "espcyd.h"
+#include "driver/ledc.h"
+#endif
+
+/* backlight.cpp */
+
+uint16_t AmbientFilter::update(uint32_t sampleSum, uint16_t sampleCount) {
+    if (sampleCount == 0) return value();
+
+    int32_t mean = (int32_t)((sampleSum << 8) / sampleCount); /* Q8 */
+    if (!_primed) {
+        _acc = mean;
+        _primed = true;
+    } else {
+        _acc += (mean - _acc) >> _shift;
+    }
+    return value();
+}
+
+BacklightCurve::BacklightCurve(const BacklightCurvePoint* points, uint8_t count, uint16_t hysteresis)
+    : _count(0), _hysteresis(hysteresis), _heldLevel(0), _held(false) {
+    set(points, count);
+}
+
+void BacklightCurve::set(const BacklightCurvePoint* points, uint8_t count) {
+    if (count > BL_MAX_CURVE_POINTS) count = BL_MAX_CURVE_POINTS;
+    for (uint8_t i = 0; i < count; i++) _points[i] = points[i];
+    _count = count;
+    _held = false; /* re-evaluate immediately with the new curve */
+}
+
+uint16_t BacklightCurve::interpolate(uint16_t level) const {
+    if (_count == 0) return BL_DUTY_FULL;
+    if (level <= _points[0].level) return _points[0].duty;
+    if (level >= _points[_count - 1].level) return _points[_count - 1].duty;
+
+    for (uint8_t i = 1; i < _count; i++) {
+        if (level <= _points[i].level) {
+            const BacklightCurvePoint& a = _points[i - 1];
+            const BacklightCurvePoint& b = _points[i];
+            int32_t span = b.level - a.level;
+            if (span <= 0) return b.duty;
+            return (uint16_t)(a.duty + ((int32_t)(b.duty - a.duty) * (level - a.level)) / span);
+        }
+    }
+    return _points[_count - 1].duty;
+}
+
+uint16_t BacklightCurve::map(uint16_t level) {
+    int32_t drift = (int32_t)level - (int32_t)_heldLevel;
+    if (drift < 0) drift = -drift;
+
+    if (!_held || drift > _hysteresis) {
+        _heldLevel = level;
+        _held = true;
+    }
+    return interpolate(_heldLevel);
+}
+
+uint16_t backlightStageDuty(uint16_t ambientDuty, BacklightStage stage,
+                            uint16_t dimPermille, uint16_t offPermille, uint16_t minDuty) {
+    uint32_t duty = ambientDuty;
+    switch (stage) {
+        case BL_STAGE_ACTIVE: break;
+        case BL_STAGE_DIM:    duty = (duty * dimPermille) / 1000; break;
+        case BL_STAGE_OFF:    duty = (duty * offPermille) / 1000; break;
+    }
+
+    if (duty > BL_DUTY_FULL) duty = BL_DUTY_FULL;
+    if (duty != 0 && duty < minDuty) duty = minDuty;
+    return (uint16_t)duty;
+}
+
+#if defined(ARDUINO)
+
+/** Default curve: ambient level (0 dark .. 4095 bright) -> duty permille */
+static const BacklightCurvePoint defaultCurve[] = {
+    {0,    40},   /* dark cab at night */
+    {200,  120},
+    {800,  350},
+    {2000, 700},
+    {3500, 1000}  /* direct sunlight */
+};
+
+static AmbientFilter  blFilter(BL_FILTER_SHIFT);
+static BacklightCurve blCurve(defaultCurve, sizeof(defaultCurve) / sizeof(defaultCurve[0]), BL_HYSTERESIS);
+
+static volatile BacklightStage blStage = BL_STAGE_ACTIVE; /**< Requested by any task */
+static BacklightStage blAppliedStage = BL_STAGE_ACTIVE;   /**< Stage the current target was built for */
+static uint32_t blLastSample = 0;
+static uint16_t blTarget = 0;      /**< Duty (permille) we want */
+static uint16_t blFading = 0;      /**< Duty (permille) the hardware is fading to */
+static uint32_t blFadeEnd = 0;     /**< millis() when the running fade completes */
+static bool     blFastFade = false; /**< Next fade is a wake-up and uses BL_WAKE_FADE_MS */
+static bool     blStarted = false;
+
+/* A curve from another task is parked here and applied by backlightService() */
+static portMUX_TYPE        blCurveMux = portMUX_INITIALIZER_UNLOCKED;
+static BacklightCurvePoint blPendingCurve[BL_MAX_CURVE_POINTS];
+static uint8_t             blPendingCount = 0;
+static bool                blCurvePending = false;
+
+/**
+ * @brief Reads BL_OVERSAMPLE LDR samples and feeds the filter.
+ * @return Filtered ambient level, 0 dark .. BL_ADC_MAX bright.
+ */
+static uint16_t backlightReadAmbient() {
+    uint32_t sum = 0;
+    for (int i = 0; i < BL_OVERSAMPLE; i++) {
+        sum += analogRead(CYD_LDR);
+    }
+#if CYD_LDR_DARK_HIGH
+    /* The CYD divider reads higher in the dark; flip so larger means brighter */
+    sum = ((uint32_t)BL_ADC_MAX * BL_OVERSAMPLE) - sum;
+#endif
+    return blFilter.update(sum, BL_OVERSAMPLE);
+}
+
+static uint32_t backlightToLedc(uint16_t permille) {
+    return ((uint32_t)permille * LEDC_13BIT_100PCT) / BL_DUTY_FULL;
+}
+
+/**
+ * @brief Starts a hardware fade to the current target if the previous one has finished.
+ * @details LEDC fades run from the fade ISR with no CPU per step. Starting a new fade
+ *          while one is running blocks in the driver, so changes wait for the running one.
+ */
+static bool backlightStartFade(uint32_t now, uint32_t fadeMs) {
+    if (blTarget == blFading) return false;
+    if ((int32_t)(now - blFadeEnd) < 0) return false; /* previous fade still running */
+
+    ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, (ledc_channel_t)CYD_BL_LEDC_CHANNEL,
+                            backlightToLedc(blTarget), fadeMs);
+    ledc_fade_start(LEDC_LOW_SPEED_MODE, (ledc_channel_t)CYD_BL_LEDC_CHANNEL, LEDC_FADE_NO_WAIT);
+    blFading = blTarget;
+    blFadeEnd = now + fadeMs;
+    return true;
+}
+
+void backlightBegin() {
+    ledc_timer_config_t timerCfg = {};
+    timerCfg.speed_mode = LEDC_LOW_SPEED_MODE;
+    timerCfg.duty_resolution = LEDC_TIMER_13_BIT;
+    timerCfg.timer_num = (ledc_timer_t)CYD_BL_LEDC_TIMER;
+    timerCfg.freq_hz = CYD_BACKLIGHT_PWM_HZ;
+    timerCfg.clk_cfg = LEDC_AUTO_CLK;
+    ledc_timer_config(&timerCfg);
+
+    /* Seed the filter so the first frame is lit at the right level */
+    analogSetPinAttenuation(CYD_LDR, ADC_0db);
+    uint16_t level = backlightReadAmbient();
+    blTarget = backlightStageDuty(blCurve.map(level), blStage, BL_DIM_PERMILLE, BL_OFF_PERMILLE, BL_MIN_DUTY);
+    blAppliedStage = blStage;
+
+    ledc_channel_config_t chanCfg = {};
+    chanCfg.gpio_num = CYD_BACKLIGHT;
+    chanCfg.speed_mode = LEDC_LOW_SPEED_MODE;
+    chanCfg.channel = (ledc_channel_t)CYD_BL_LEDC_CHANNEL;
+    chanCfg.intr_type = LEDC_INTR_DISABLE;
+    chanCfg.timer_sel = (ledc_timer_t)CYD_BL_LEDC_TIMER;
+    chanCfg.duty = backlightToLedc(blTarget);
+    chanCfg.hpoint = 0;
+    ledc_channel_config(&chanCfg);
+
+    ledc_fade_func_install(0);
+    blFading = blTarget;
+    blLastSample = millis();
+    blStarted = true;
+}
+
+/**
+ * @brief Moves a curve set by backlightSetCurve() into blCurve.
+ * @return true if the curve changed.
+ */
+static bool backlightTakeCurve() {
+    BacklightCurvePoint points[BL_MAX_CURVE_POINTS];
+    uint8_t count = 0;
+    bool pending;
+
+    portENTER_CRITICAL(&blCurveMux);
+    pending = blCurvePending;
+    if (pending) {
+        count = blPendingCount;
+        for (uint8_t i = 0; i < count; i++) points[i] = blPendingCurve[i];
+        blCurvePending = false;
+    }
+    portEXIT_CRITICAL(&blCurveMux);
+
+    if (pending) blCurve.set(points, count);
+    return pending;
+}
+
+void backlightService(uint32_t now) {
+    if (!blStarted) return;
+
+    BacklightStage stage = blStage;
+    bool stageChanged = (stage != blAppliedStage);
+    if (backlightTakeCurve()) stageChanged = true; /* re-target now, not at the next sample */
+    bool sampleDue = (now - blLastSample >= BL_SAMPLE_MS);
+
+    if (sampleDue) {
+        blLastSample = now;
+        backlightReadAmbient();
+    }
+
+    if (sampleDue || stageChanged) {
+        if (stageChanged && stage == BL_STAGE_ACTIVE) blFastFade = true;
+        blTarget = backlightStageDuty(blCurve.map(blFilter.value()), stage,
+                                      BL_DIM_PERMILLE, BL_OFF_PERMILLE, BL_MIN_DUTY);
+        blAppliedStage = stage;
+    }
+
+    /* Waking up should feel instant; ambient drift and dimming ramp slowly */
+    if (backlightStartFade(now, blFastFade ? BL_WAKE_FADE_MS : BL_FADE_MS)) {
+        blFastFade = false;
+    }
+}
+
+void backlightSetStage(BacklightStage stage) {
+    blStage = stage;
+}
+
+void backlightSetCurve(const BacklightCurvePoint* points, uint8_t count) {
+    if (count > BL_MAX_CURVE_POINTS) count = BL_MAX_CURVE_POINTS;
+
+    /* blCurve belongs to the task running backlightService(); hand the copy over */
+    portENTER_CRITICAL(&blCurveMux);
+    for (uint8_t i = 0; i < count; i++) blPendingCurve[i] = points[i];
+    blPendingCount = count;
+    blCurvePending = true;
+    portEXIT_CRITICAL(&blCurveMux);
+}
+
+bool backlightFadeDone(uint32_t now) {
+    if (!blStarted) return true;
+    if (blAppliedStage != blStage) return false;               /* stage not picked up yet */
+    if (blFading != blTarget) return false;                    /* fade deferred behind a running one */
+    return (int32_t)(now - blFadeEnd) >= 0;
+}
+
+uint16_t backlightAmbientLevel() {
+    return blFilter.value();
+}
+
+uint16_t backlightTargetDuty() {
+    return blTarget;
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef BACKLIGHT_H_
+#define BACKLIGHT_H_
+
+#include <stdint.h>
+
+/* backlight.h - ambient-light adaptive backlight.
+ * The filter, curve and stage logic are plain C++ so recorded LDR traces
+ * can be replayed on a host; the LEDC fade driver is device-only. */
+
+#define BL_ADC_MAX          4095 /**< 12-bit ADC full scale */
+#define BL_DUTY_FULL        1000 /**< Duty values are in permille */
+#define BL_MAX_CURVE_POINTS 8
+
+/** --- Inactivity stages, applied as multipliers on the ambient duty --- */
+enum BacklightStage { BL_STAGE_ACTIVE = 0,
+                      BL_STAGE_DIM,
+                      BL_STAGE_OFF  /**< Idle; a zero multiplier turns the backlight off */
+                    };
+
+/**
+ * @struct BacklightCurvePoint
+ * @brief One point of the ambient level -> duty curve.
+ */
+struct BacklightCurvePoint {
+    uint16_t level; /**< Filtered ambient level, 0 (dark) .. BL_ADC_MAX (bright) */
+    uint16_t duty;  /**< Backlight duty in permille */
+};
+
+/**
+ * @class AmbientFilter
+ * @brief Averages an oversampled burst, then low-passes it with a 1/2^shift IIR.
+ */
+class AmbientFilter {
+public:
+    explicit AmbientFilter(uint8_t shift) : _shift(shift), _acc(0), _primed(false) {}
+
+    /**
+     * @brief Feeds one burst of ADC readings.
+     * @param sampleSum Sum of the raw readings in the burst
+     * @param sampleCount Number of readings summed
+     * @return The filtered level
+     */
+    uint16_t update(uint32_t sampleSum, uint16_t sampleCount);
+
+    uint16_t value() const { return (uint16_t)(_acc >> 8); }
+    void reset() { _acc = 0; _primed = false; }
+
+private:
+    uint8_t  _shift;
+    int32_t  _acc;    /**< Filter state, Q8 fixed point */
+    bool     _primed; /**< First burst seeds the filter directly */
+};
+
+/**
+ * @class BacklightCurve
+ * @brief Piecewise-linear ambient level -> duty mapping with hysteresis.
+ * @details The input only moves the output once it has drifted more than
+ *          hysteresis counts from the level the output was last computed for,
+ *          so a level sitting on a boundary does not make the panel pump.
+ */
+class BacklightCurve {
+public:
+    BacklightCurve(const BacklightCurvePoint* points, uint8_t count, uint16_t hysteresis);
+
+    /** @brief Replaces the curve; points must be sorted by level. */
+    void set(const BacklightCurvePoint* points, uint8_t count);
+
+    /** @brief Maps a filtered level to a duty, honouring hysteresis. */
+    uint16_t map(uint16_t level);
+
+    /** @brief Stateless interpolation of the curve at level. */
+    uint16_t interpolate(uint16_t level) const;
+
+private:
+    BacklightCurvePoint _points[BL_MAX_CURVE_POINTS];
+    uint8_t  _count;
+    uint16_t _hysteresis;
+    uint16_t _heldLevel;
+    bool     _held;
+};
+
+/**
+ * @brief Applies the inactivity stage multiplier to an ambient duty.
+ * @param ambientDuty Duty from the curve, permille
+ * @param stage Current inactivity stage
+ * @param dimPermille Multiplier for BL_STAGE_DIM
+ * @param offPermille Multiplier for BL_STAGE_OFF
+ * @param minDuty Floor applied to non-zero results so the panel stays legible
+ */
+uint16_t backlightStageDuty(uint16_t ambientDuty, BacklightStage stage,
+                            uint16_t dimPermille, uint16_t offPermille, uint16_t minDuty);
+
+#if defined(ARDUINO)
+/**
+ * @brief Configures the LEDC channel and fade service, and lights the panel
+ *        at the current ambient level without a fade.
+ */
+void backlightBegin();
+
+/**
+ * @brief Samples the LDR and updates the fade target. Call periodically from
+ *        one task; it only does work every BL_SAMPLE_MS.
+ */
+void backlightService(uint32_t now);
+
+/** @brief Requests an inactivity stage; safe to call from any task. */
+void backlightSetStage(BacklightStage stage);
+
+/**
+ * @brief Replaces the ambient curve at runtime; safe to call from any task.
+ * @details The points are copied and take effect on the next backlightService().
+ */
+void backlightSetCurve(const BacklightCurvePoint* points, uint8_t count);
+
+/**
+ * @brief True once the hardware has finished fading to the duty of the
+ *        requested stage, e.g. the backlight is really dark after BL_STAGE_OFF.
+ */
+bool backlightFadeDone(uint32_t now);
+
+/** @brief Last filtered ambient level (0 dark .. BL_ADC_MAX bright). */
+uint16_t backlightAmbientLevel();
+
+/** @brief Duty (permille) the backlight is currently fading towards. */
+uint16_t backlightTargetDuty();
+#endif
+
+#endif /* END BACKLIGHT_H_ */
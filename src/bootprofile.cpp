@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include "bootprofile.h"
+
+/* bootprofile.cpp */
+
+static BootClockFn bootClock = NULL;
+static volatile uint32_t bootStamps[BOOT_STAGE_COUNT]; /**< 0 = not reached */
+
+static const char* const bootStageNames[BOOT_STAGE_COUNT] = {
+    "init", "tasks", "registry", "touch", "panel", "splash", "interactive"
+};
+
+void bootProfileReset(BootClockFn clock) {
+    bootClock = clock;
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) bootStamps[i] = 0;
+}
+
+void bootMark(BootStage stage) {
+    if (bootClock == NULL || stage >= BOOT_STAGE_COUNT) return;
+    if (bootStamps[stage] != 0) return;
+
+    uint32_t now = bootClock();
+    bootStamps[stage] = (now == 0) ? 1 : now; /* keep 0 reserved for "not reached" */
+}
+
+bool bootStageDone(BootStage stage) {
+    return (stage < BOOT_STAGE_COUNT) && (bootStamps[stage] != 0);
+}
+
+uint32_t bootStageUs(BootStage stage) {
+    return (stage < BOOT_STAGE_COUNT) ? bootStamps[stage] : 0;
+}
+
+uint32_t bootElapsedUs(BootStage stage) {
+    if (!bootStageDone(BOOT_INIT_START) || !bootStageDone(stage)) return 0;
+    return bootStamps[stage] - bootStamps[BOOT_INIT_START];
+}
+
+const char* bootStageName(BootStage stage) {
+    return (stage < BOOT_STAGE_COUNT) ? bootStageNames[stage] : "?";
+}
+
+/**
+ * @brief True if stage is unmarked, or was marked no earlier than its dependency.
+ */
+static bool bootAfter(BootStage stage, BootStage dependency) {
+    if (!bootStageDone(stage)) return true;
+    if (!bootStageDone(dependency)) return false;
+    return (int32_t)(bootStamps[stage] - bootStamps[dependency]) >= 0;
+}
+
+bool bootSequenceValid() {
+    return bootAfter(BOOT_TASKS_STARTED, BOOT_INIT_START) &&
+           bootAfter(BOOT_SPLASH_SHOWN, BOOT_PANEL_READY) &&
+           bootAfter(BOOT_INTERACTIVE, BOOT_SPLASH_SHOWN) &&
+           bootAfter(BOOT_INTERACTIVE, BOOT_TOUCH_READY) &&
+           bootAfter(BOOT_INTERACTIVE, BOOT_REGISTRY_READY);
+}
+
+size_t bootFormatReport(char* out, size_t cap) {
+    size_t used = 0;
+    if (out == NULL || cap == 0) return 0;
+    out[0] = '\0';
+
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        BootStage stage = (BootStage)i;
+        if (!bootStageDone(stage)) continue;
+
+        uint32_t us = bootElapsedUs(stage);
+        int n = snprintf(out + used, cap - used, "%-12s +%lu.%03lu ms\n", bootStageName(stage),
+                         (unsigned long)(us / 1000), (unsigned long)(us % 1000));
+        if (n < 0 || (size_t)n >= cap - used) break; /* truncated */
+        used += n;
+    }
+    return used;
+}
@@ -0,0 +1,62 @@
+#ifndef BOOTPROFILE_H_
+#define BOOTPROFILE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* bootprofile.h - timestamps for each stage of the CYD startup.
+ * No Arduino dependency: the clock is injected so the sequencing can be
+ * checked on a host with a fake time source. */
+
+/** --- Boot stages, in the order they are expected to complete --- */
+enum BootStage { BOOT_INIT_START = 0,    /**< initCYD() entered */
+                 BOOT_TASKS_STARTED,     /**< Touch and display tasks created */
+                 BOOT_REGISTRY_READY,    /**< Node table restored from flash */
+                 BOOT_TOUCH_READY,       /**< Touch SPI and controller configured */
+                 BOOT_PANEL_READY,       /**< tft.begin() and rotation done */
+                 BOOT_SPLASH_SHOWN,      /**< Splash blitted and backlight on */
+                 BOOT_INTERACTIVE,       /**< Keypad drawn, touches are handled */
+                 BOOT_STAGE_COUNT
+               };
+
+/** @brief Clock used for stage timestamps, in microseconds */
+typedef uint32_t (*BootClockFn)(void);
+
+/**
+ * @brief Selects the clock and clears all recorded stages.
+ */
+void bootProfileReset(BootClockFn clock);
+
+/**
+ * @brief Records the completion time of a stage. Only the first mark counts.
+ * @details Safe to call from different tasks: each stage is written by one owner.
+ */
+void bootMark(BootStage stage);
+
+/** @brief True if the stage has been marked */
+bool bootStageDone(BootStage stage);
+
+/** @brief Absolute timestamp of a stage in us, or 0 if not yet marked */
+uint32_t bootStageUs(BootStage stage);
+
+/** @brief Time from BOOT_INIT_START to the stage in us, or 0 if either is missing */
+uint32_t bootElapsedUs(BootStage stage);
+
+/** @brief Human readable stage name */
+const char* bootStageName(BootStage stage);
+
+/**
+ * @brief Checks the dependencies of the startup sequence.
+ * @details The keypad must not become interactive before the panel, touch
+ *          and registry are ready, and the splash must follow the panel.
+ * @return true if every marked stage respects its dependencies.
+ */
+bool bootSequenceValid();
+
+/**
+ * @brief Writes one line per marked stage ("name  +12.345 ms") into out.
+ * @return Number of characters written (excluding the terminator).
+ */
+size_t bootFormatReport(char* out, size_t cap);
+
+#endif /* END BOOTPROFILE_H_ */
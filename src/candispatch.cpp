@@ -0,0 +1,28 @@
+#include <string.h>
+#include "candispatch.h"
+
+/* candispatch.cpp */
+
+CanDispatch::CanDispatch() : _count(0), _unhandled(0) {
+    memset(_index, 0, sizeof(_index));
+}
+
+bool CanDispatch::add(uint16_t first, uint16_t last, CanFrameHandler fn, void* ctx) {
+    if (fn == NULL || first > last || last >= CAN_STD_ID_COUNT) return false;
+    if (_count == CAN_DISPATCH_MAX) return false;
+
+    for (uint16_t id = first; id <= last; id++) {
+        if (_index[id] != 0) return false; /* one owner per ID */
+    }
+
+    Entry& e = _entries[_count];
+    e.fn = fn;
+    e.ctx = ctx;
+    e.frames = 0;
+    e.first = first;
+    e.last = last;
+    _count++;
+
+    for (uint16_t id = first; id <= last; id++) _index[id] = _count;
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef CANDISPATCH_H_
+#define CANDISPATCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* candispatch.h - table-driven dispatch of received CAN frames.
+ *
+ * Handlers are registered per 11-bit ID or ID range. Every standard ID owns
+ * one byte in a direct index (2 KB), so dispatch is a bounds check, one load
+ * and an indirect call whatever the number of handlers or how the ranges
+ * are laid out. Handlers get the caller's data pointer; nothing is copied.
+ *
+ * Registration is not synchronised with dispatch: register everything
+ * before the receive task starts calling dispatch(). No Arduino dependency.
+ */
+
+#define CAN_STD_ID_COUNT    2048 /**< 11-bit identifiers */
+#define CAN_DISPATCH_MAX    32   /**< Registered handlers */
+
+/**
+ * @brief Frame handler; data is only valid during the call.
+ * @param id Received identifier (useful for range registrations)
+ */
+typedef void (*CanFrameHandler)(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx);
+
+/**
+ * @class CanDispatch
+ * @brief ID -> handler table for the receive path.
+ */
+class CanDispatch {
+public:
+    CanDispatch();
+
+    /**
+     * @brief Routes IDs first..last (inclusive) to fn.
+     * @return false if the range is invalid, overlaps a registration, or the table is full.
+     */
+    bool add(uint16_t first, uint16_t last, CanFrameHandler fn, void* ctx);
+    bool add(uint16_t id, CanFrameHandler fn, void* ctx) { return add(id, id, fn, ctx); }
+
+    /**
+     * @brief Calls the handler registered for id.
+     * @return false if no handler owns id (the frame is left to the caller).
+     */
+    bool dispatch(uint16_t id, const uint8_t* data, uint8_t dlc) {
+        const uint8_t e = (id < CAN_STD_ID_COUNT) ? _index[id] : 0;
+        if (e == 0) {
+            _unhandled++;
+            return false;
+        }
+        Entry& h = _entries[e - 1];
+        h.frames++;
+        h.fn(id, data, dlc, h.ctx);
+        return true;
+    }
+
+    uint8_t count() const { return _count; }
+    uint32_t unhandled() const { return _unhandled; }
+
+    /** @brief Frames delivered to handler i (registration order). */
+    uint32_t frames(uint8_t i) const { return (i < _count) ? _entries[i].frames : 0; }
+    uint16_t first(uint8_t i) const { return (i < _count) ? _entries[i].first : 0; }
+    uint16_t last(uint8_t i) const { return (i < _count) ? _entries[i].last : 0; }
+
+private:
+    struct Entry {
+        CanFrameHandler fn;
+        void*    ctx;
+        uint32_t frames;
+        uint16_t first;
+        uint16_t last;
+    };
+
+    Entry    _entries[CAN_DISPATCH_MAX];
+    uint8_t  _index[CAN_STD_ID_COUNT]; /**< Entry number + 1 per ID, 0 = unhandled */
+    uint8_t  _count;
+    uint32_t _unhandled;
+};
+
+#endif /* END CANDISPATCH_H_ */
@@ -0,0 +1,77 @@
+#include "clocksvc.h"
+
+/* clocksvc.cpp */
+
+ClockService::ClockService(uint32_t syncTimeoutMs, uint32_t rebaseMs)
+    : _state(CLOCK_UNSYNCED), _syncTimeoutMs(syncTimeoutMs), _rebaseMs(rebaseMs), _syncStartMs(0),
+      _haveBase(false), _baseMs(0), _baseWallMs(0), _syncs(0) {
+}
+
+void ClockService::startSync(uint32_t nowMs) {
+    if (state() != CLOCK_UNSYNCED) return;
+    _syncStartMs = nowMs;
+    _state.store(CLOCK_SYNCING, std::memory_order_relaxed);
+}
+
+void ClockService::stopSync() {
+    if (state() == CLOCK_SYNCING) _state.store(CLOCK_UNSYNCED, std::memory_order_relaxed);
+}
+
+bool ClockService::poll(uint32_t nowMs, int64_t wallMs) {
+    const ClockState was = state();
+
+    if (wallMs >= CLOCK_VALID_EPOCH * 1000) {
+        if (was != CLOCK_SYNCED || !_haveBase || (nowMs - _baseMs) >= _rebaseMs) {
+            _baseMs = nowMs;
+            _baseWallMs = wallMs;
+            _haveBase = true;
+        }
+        if (was != CLOCK_SYNCED) {
+            _syncs++;
+            _state.store(CLOCK_SYNCED, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    if (was == CLOCK_SYNCING && (nowMs - _syncStartMs) >= _syncTimeoutMs) {
+        _state.store(CLOCK_UNSYNCED, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ClockService::now(uint32_t nowMs, int64_t* wallMs) const {
+    if (!_haveBase) return false;
+    *wallMs = _baseWallMs + (uint32_t)(nowMs - _baseMs);
+    return true;
+}
+
+void clockFormatHms(uint32_t secondOfDay, char* out) {
+    const uint32_t h = (secondOfDay / 3600) % 24;
+    const uint32_t m = (secondOfDay / 60) % 60;
+    const uint32_t s = secondOfDay % 60;
+    out[0] = (char)('0' + h / 10);
+    out[1] = (char)('0' + h % 10);
+    out[2] = ':';
+    out[3] = (char)('0' + m / 10);
+    out[4] = (char)('0' + m % 10);
+    out[5] = ':';
+    out[6] = (char)('0' + s / 10);
+    out[7] = (char)('0' + s % 10);
+    out[8] = '\0';
+}
+
+uint16_t ClockDigits::update(const char* text) {
+    uint16_t changed = 0;
+    bool ended = false;
+    for (uint8_t i = 0; i < CLOCK_TEXT_LEN; i++) {
+        const char c = ended ? '\0' : text[i];
+        if (c == '\0') ended = true;
+        if (c != _shown[i]) {
+            changed |= (uint16_t)(1U << i);
+            _shown[i] = c;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,107 @@
+#ifndef CLOCKSVC_H_
+#define CLOCKSVC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/* clocksvc.h - wall clock for the UI that never waits for SNTP.
+ *
+ * The owner polls the system time (which on the ESP32 reads as 1970 until
+ * SNTP has set it) without blocking and tells the service when the network
+ * comes and goes. Once a valid time is seen, wall time is carried from the
+ * monotonic millisecond counter and re-based every CLOCK_REBASE_MS, so
+ * reading the clock is arithmetic only. States:
+ *
+ *   UNSYNCED --startSync()--> SYNCING --valid time--> SYNCED
+ *      ^                         |
+ *      +--timeout / stopSync()---+
+ *
+ * A valid time seen in any state goes straight to SYNCED, and SYNCED is
+ * kept when the network drops: the clock free-runs from its last base.
+ * Single owner task; state() may be read from any task. No Arduino dependency.
+ */
+
+#define CLOCK_VALID_EPOCH  1704067200LL /**< 2024-01-01 UTC: earlier system time means "not set" */
+#define CLOCK_TEXT_LEN     8            /**< "HH:MM:SS" */
+
+enum ClockState { CLOCK_UNSYNCED = 0, /**< No time known, not trying */
+                  CLOCK_SYNCING,      /**< Network up, waiting for the first valid time */
+                  CLOCK_SYNCED        /**< Wall time known */
+                };
+
+/**
+ * @class ClockService
+ * @brief Sync state machine plus a monotonic base for wall time
+ */
+class ClockService {
+public:
+    /**
+     * @param syncTimeoutMs SYNCING gives up (back to UNSYNCED) after this long
+     * @param rebaseMs Interval at which a valid system time replaces the base
+     */
+    ClockService(uint32_t syncTimeoutMs, uint32_t rebaseMs);
+
+    /** @brief Network is up and SNTP running. */
+    void startSync(uint32_t nowMs);
+
+    /** @brief Network lost; only leaves SYNCING. */
+    void stopSync();
+
+    /**
+     * @brief Feeds the system time read without waiting.
+     * @param wallMs Milliseconds since 1970-01-01 UTC as the system reports them
+     * @return true if the state changed.
+     */
+    bool poll(uint32_t nowMs, int64_t wallMs);
+
+    ClockState state() const { return (ClockState)_state.load(std::memory_order_relaxed); }
+    bool synced() const { return state() == CLOCK_SYNCED; }
+
+    /**
+     * @brief Current wall time from the base.
+     * @return false if the time was never known.
+     */
+    bool now(uint32_t nowMs, int64_t* wallMs) const;
+
+    uint32_t syncs() const { return _syncs; }
+
+private:
+    std::atomic<uint8_t> _state;
+    uint32_t _syncTimeoutMs;
+    uint32_t _rebaseMs;
+    uint32_t _syncStartMs;
+    bool     _haveBase;
+    uint32_t _baseMs;      /**< Monotonic time of the base */
+    int64_t  _baseWallMs;  /**< Wall time at _baseMs */
+    uint32_t _syncs;       /**< Transitions into SYNCED */
+};
+
+/**
+ * @brief Formats the time of day as "HH:MM:SS".
+ * @param out At least CLOCK_TEXT_LEN + 1 bytes
+ */
+void clockFormatHms(uint32_t secondOfDay, char* out);
+
+/**
+ * @class ClockDigits
+ * @brief What a clock widget currently shows, for repainting changed characters only
+ */
+class ClockDigits {
+public:
+    ClockDigits() { invalidate(); }
+
+    /** @brief Forget the shown text, e.g. after the area was painted over. */
+    void invalidate() { for (uint8_t i = 0; i <= CLOCK_TEXT_LEN; i++) _shown[i] = '\0'; }
+
+    /**
+     * @brief Records text as shown.
+     * @return Bit i set if character i differs from what was shown before.
+     */
+    uint16_t update(const char* text);
+
+private:
+    char _shown[CLOCK_TEXT_LEN + 1];
+};
+
+#endif /* END CLOCKSVC_H_ */
@@ -1,5 +1,25 @@
 #include <WiFi.h>
 #include "espcyd.h"
+#include "nodestore.h"
+#include "bootprofile.h"
+#include "backlight.h"
+#include "powerctl.h"
+#include "screens.h"
+#include "splash.h"
+#include "keypadlayout.h"
+#include "keypadxfer.h"
+#include "keypadstore.h"
+#include "touchtrace.h"
+#include "fbcapture.h"
+#include "spsc.h"
+#include "nodelist.h"
+#include "statemodel.h"
+#include "candispatch.h"
+#include "rtosdiag.h"
+#include "imgasset.h"
+#include "argbeffects.h"
+#include "freertos/event_groups.h"
+#include <sys/time.h>
 
 /* espcyd.cpp */
 
@@ -10,11 +30,32 @@ XPT2046_Touchscreen touchscreen(XPT2046_CS, XPT2046_IRQ);
 SemaphoreHandle_t spiSemaphore;
 QueueHandle_t touchQueue;
 QueueHandle_t timeQueue;
+EventGroupHandle_t bootEvents; /**< Startup readiness bits, see BOOT_BIT_* */
+
+/* Startup readiness bits, set by whichever task finishes that stage */
+#define BOOT_BIT_TOUCH     (1 << 0)
+#define BOOT_BIT_REGISTRY  (1 << 1)
+#define BOOT_WAIT_MS       500 /**< Time allowed for touch/registry before a late-start warning */
 
 /* Forward declarations for tasks */
 void TaskReadTouch(void * pvParameters);
 void TaskUpdateDisplay(void * pvParameters);
 
+/* Screen registry helpers, defined with the screen table */
+const char* currentTitle();
+const char* screenTitle(uint8_t id);
+void navPush(DisplayMode mode);
+void drawPageButton(const char* label);
+bool pageButtonHit(int x, int y);
+
+/* Latency tracing, defined with sendUiMessage() */
+void sendUiMessage(uint16_t msgid, uint8_t* data, uint8_t dlc, uint32_t ackNode, int16_t ackKey = -1);
+void traceAckKey(uint8_t key, uint32_t stamp);
+
+#if CYD_HEADER_CLOCK
+void drawHeaderClock(uint32_t now);
+#endif
+
 // Touchscreen coordinates: (x, y) and pressure (z)
 int x, y, z;
 
@@ -22,17 +63,80 @@ int x, y, z;
 volatile int globalX, globalY, globalZ;
 volatile bool newData = false;
 
-/* Match the header exactly: volatile and explicit size */
-volatile int discoveredNodeCount = 0;
-volatile int selectedNodeIdx = 0;
+/* Node table selection and the dim state belong to the display task; other
+ * tasks reach it through nodeEvents/touchContacts, never through these */
+int discoveredNodeCount = 0;
+int selectedNodeIdx = 0;
 
 uint32_t tsLastTouch; /**< Timestamp of last cyd touch event */
-bool screenDim; /**< True if screen is dimmed */
-bool screenOff; /**< True if screen is off */
+bool screenDim; /**< True if screen is dimmed, display task only */
+std::atomic<bool> screenOff(false);   /**< True if screen is off; display task writes, touch task reads */
+std::atomic<bool> panelAsleep(false); /**< ILI9341 is in sleep-in mode, rendering suspended */
+uint32_t panelSleptAt = 0;         /**< millis() of the last SLPIN */
+uint32_t wakeRequestUs = 0;        /**< micros() of the touch that woke the panel */
+uint32_t lastWakeLatencyUs = 0;    /**< Touch to repainted, lit panel, last wake */
+
+/**
+ * @struct TouchContact
+ * @brief Latest finger contact, touch task -> display task (dimming and wake)
+ */
+struct TouchContact {
+    uint32_t ms;      /**< millis() of the contact */
+    uint32_t wakeUs;  /**< micros() of the first contact while the panel slept, 0 if awake */
+};
+SpscLatest<TouchContact> touchContacts;
+uint32_t touchContactSeq = 0; /**< Last contact consumed by the display task */
+
+/**
+ * @struct NodeEvent
+ * @brief Node table change from the CAN receive task, applied by the display task
+ */
+enum NodeEventType { NODE_EVT_HEARTBEAT = 0, NODE_EVT_STRIPS };
+struct NodeEvent {
+    uint32_t id;
+    uint32_t atMs;     /**< millis() at receipt */
+    uint32_t stamp;    /**< Trace clock at receipt (acknowledgement timing) */
+    uint8_t  type;     /**< NodeEventType */
+    uint8_t  value;    /**< Strip count for NODE_EVT_STRIPS */
+};
+SpscQueue<NodeEvent, NODE_EVENT_QUEUE_LEN> nodeEvents;
+
+uint32_t uiEvents = 0;      /**< Pending UI_EVT_* bits, owned by the display task */
+uint32_t screenLastTick = 0; /**< Last periodic refresh of the current screen */
 
 
 ARGBNode discoveredNodes[MAX_ARGB_NODES];
 
+/**
+ * @class ArgbNodeSource
+ * @brief Exposes discoveredNodes to the node list view
+ */
+class ArgbNodeSource : public NodeListSource {
+public:
+    uint8_t  slotCount() const { return MAX_ARGB_NODES; }
+    uint32_t nodeId(uint8_t slot) const { return discoveredNodes[slot].id; }
+    uint32_t nodeLastSeen(uint8_t slot) const { return discoveredNodes[slot].lastSeen; }
+    uint16_t nodeActivity(uint8_t slot) const { return discoveredNodes[slot].activity; }
+};
+
+/* Node selector list, display task only */
+ArgbNodeSource nodeSource;
+uint8_t nodeListOrder[MAX_ARGB_NODES];
+uint8_t nodeListPosition[MAX_ARGB_NODES];
+NodeListView nodeList(nodeListOrder, nodeListPosition, MAX_ARGB_NODES,
+                      NODE_LIST_TOP, NODE_LIST_ROW_H, NODE_LIST_ROWS);
+bool nodeListResort = true; /**< Table membership, sort or filter changed since the last rebuild */
+bool nodeFilterEdit = false; /**< Hex pad for the ID filter is shown instead of the rows */
+
+uint32_t nodeTableReadyMs = 0; /**< millis() when the node list became usable */
+uint32_t firstHeartbeatMs = 0; /**< millis() of the first heartbeat after boot */
+
+/* Node table persistence */
+uint8_t nodeStoreBuf[NODESTORE_BLOB_LEN(MAX_ARGB_NODES)];
+NvsNodeStore nodeStoreBackend(NODE_STORE_NVS_NS);
+NodeTablePersister nodePersister(nodeStoreBackend, nodeStoreBuf, sizeof(nodeStoreBuf),
+                                 NODE_STORE_DEBOUNCE_MS, NODE_STORE_MIN_INTERVAL_MS);
+
 /* CAN interface status from main.cpp */
 extern volatile bool can_suspended;
 extern volatile bool can_driver_installed;
@@ -47,15 +151,64 @@ DisplayMode currentMode = MODE_HOME; /**< Current display mode */
 /* can tx function from main.cpp */
 extern void send_message(uint16_t msgid, uint8_t *data, uint8_t dlc);
 
-/* hardware pwm function from main.cpp */
-extern void handleHardwareBlink(uint8_t submodIdx, uint8_t pin, uint32_t freq, uint32_t duty = (LEDC_13BIT_50PCT));
-
-
 /* node ID for the data payload from main CPP */
 extern volatile uint8_t myNodeID[4];
 
 extern bool wifi_connected;
 
+/* Latency tracing: the touch being dispatched, and the send awaiting a reply (display task) */
+uint16_t dispatchTraceId = 0;  /**< Set by the display task around onTouch */
+uint16_t ackTraceId = 0;       /**< Trace waiting for its target node */
+uint32_t ackTraceNode = 0;     /**< Node whose next frame completes ackTraceId */
+int16_t  ackTraceKey = -1;     /**< Or: switch whose next status completes ackTraceId */
+
+/* Keypad layout: downloaded over CAN and cached in flash, built-in default otherwise */
+KeypadLayout keypadLayout;          /**< Views into flash or keypadDefaultBuf, never copied */
+uint8_t keypadPage = 0;             /**< Page shown on the keypad screen */
+uint8_t keypadDefaultBuf[384];      /**< Built-in layout, see buildDefaultKeypad() */
+uint8_t keypadRxBuf[KPL_MAX_LEN];   /**< Reassembly buffer for downloads */
+SemaphoreHandle_t keypadXferMutex;  /**< CAN receive path vs. display task */
+
+/* Switch state on stateful keypad buttons: gated in the CAN receive task, applied by the display task */
+struct StateEvent {
+    uint8_t    key;
+    StateValue value;
+    uint32_t   stamp; /**< Trace clock at receipt (acknowledgement timing) */
+};
+StateGate statusGate;               /**< CAN receive task; expect() from the display task */
+SpscQueue<StateEvent, STATE_EVENT_QUEUE_LEN> stateEvents;
+StateModel keypadState;             /**< Display task only; widgets are button indices on keypadPage */
+
+EffectCommand effectCmd = { 0x01, EFFECT_BREATHE, 6, 25, 0, 0 }; /**< Effect editor state: strip 1, red */
+bool effectEditB = false;           /**< Palette row sets colour B instead of A */
+TFT_eSprite effectSprite(&tft);     /**< Preview strip, allocated on first use and kept */
+EffectRgb effectShown[FX_PREVIEW_LEDS]; /**< LED colours in the sprite */
+uint32_t effectFramesSent = 0;
+
+ClockService cydClock(CLOCK_SYNC_TIMEOUT_MS, CLOCK_REBASE_MS); /**< Polled by the display task */
+ClockDigits infoClock;              /**< System info clock, as drawn */
+int8_t infoClockCaption = -1;       /**< ClockState its caption shows, -1 = none */
+#if CYD_HEADER_CLOCK
+ClockDigits headerClock;
+#endif
+
+/**
+ * @brief xSemaphoreTake() with a timeout that is counted on the diagnostics page when it expires.
+ */
+static inline bool takeCounted(SemaphoreHandle_t lock, TickType_t wait, DiagCounterId counter) {
+    if (xSemaphoreTake(lock, wait) == pdTRUE) return true;
+    diagCounters.add(counter);
+    return false;
+}
+
+/** @brief Flow control out to the layout sender */
+static void keypadXferSend(const uint8_t* frame, uint8_t len, void* ctx) {
+    send_message(KEYPAD_XFER_FC_ID, (uint8_t*)frame, len);
+}
+
+KeypadXferRx keypadRx(keypadRxBuf, sizeof(keypadRxBuf), KEYPAD_XFER_BLOCK,
+                      KEYPAD_XFER_TIMEOUT_MS, KEYPAD_XFER_RETRIES, keypadXferSend, NULL);
+
 KeypadButton buttons[4] = {
     {10,  50,  145, 70, "LIGHTS", 0, TFT_BLUE},
     {165, 50,  145, 70, "WIPERS", 1, TFT_DARKGREEN},
@@ -64,43 +217,410 @@ KeypadButton buttons[4] = {
 };
 
 /**
- * @brief Menu items for the hamburger menu
+ * @brief Restores the node table from flash so the UI has targets before any heartbeat.
+ * @details Restored nodes are inactive and unconfirmed until registerARGBNode() sees them.
+ */
+void restoreNodeTable() {
+    static NodeRecord recs[MAX_ARGB_NODES]; /* too large for the caller's stack */
+    int n = nodePersister.restore(recs, MAX_ARGB_NODES);
+
+    for (int i = 0; i < n; i++) {
+        discoveredNodes[i].id = recs[i].id;
+        discoveredNodes[i].lastColorIdx = recs[i].lastColorIdx;
+        discoveredNodes[i].stripCount = recs[i].stripCount;
+        discoveredNodes[i].lastSeen = 0;
+        discoveredNodes[i].active = false;
+        discoveredNodes[i].confirmed = false;
+        discoveredNodes[i].activity = 0;
+    }
+    discoveredNodeCount = n;
+    nodeListResort = true;
+    nodeTableReadyMs = millis();
+
+    Serial.printf("CYD: Node table ready at %lu ms (%d restored)\n", (unsigned long)nodeTableReadyMs, n);
+}
+
+/**
+ * @brief Hands the node table to the persister; writes only when debounced and changed.
+ */
+void persistNodeTable(uint32_t now) {
+    if (!nodePersister.isDirty()) return;
+
+    static NodeRecord recs[MAX_ARGB_NODES]; /* too large for the display task stack */
+    uint8_t count = 0;
+    for (int i = 0; i < MAX_ARGB_NODES; i++) {
+        if (discoveredNodes[i].id == 0) continue;
+        recs[count].id = discoveredNodes[i].id;
+        recs[count].lastColorIdx = (int8_t)discoveredNodes[i].lastColorIdx;
+        recs[count].stripCount = discoveredNodes[i].stripCount;
+        recs[count].reserved[0] = 0;
+        recs[count].reserved[1] = 0;
+        count++;
+    }
+
+    if (nodePersister.service(recs, count, now)) {
+        Serial.printf("CYD: Node table saved (%d nodes, write #%lu)\n", count, (unsigned long)nodePersister.writeCount());
+    }
+}
+
+/**
+ * @brief Builds the built-in keypad (the original four buttons) into keypadDefaultBuf.
+ * @return Blob length, 0 on error.
+ */
+static size_t buildDefaultKeypad() {
+    static const struct { const char* label; uint16_t color; uint8_t icon; } items[4] = {
+        {"LT BAR",      TFT_BLUE,      KPL_ICON_LIGHTBAR},
+        {"SEAT WARMER", TFT_MAROON,    KPL_ICON_SEAT_WARMER},
+        {"WTR PUMP",    TFT_DARKGREEN, KPL_ICON_WATER_PUMP},
+        {"DEFROST",     TFT_ORANGE,    KPL_ICON_DEFROSTER}
+    };
+
+    KeypadLayoutWriter writer(keypadDefaultBuf, sizeof(keypadDefaultBuf), 1);
+    writer.beginPage("VEHICLE CONTROL");
+    for (int i = 0; i < 4; i++) {
+        uint8_t payload = (uint8_t)buttons[i].canID;
+        writer.addButton(buttons[i].x, buttons[i].y, buttons[i].w, buttons[i].h, items[i].color,
+                         SW_MOM_PRESS_ID, items[i].icon, KPL_FLAG_PREFIX_NODE_ID | KPL_FLAG_STATEFUL,
+                         &payload, 1, items[i].label);
+    }
+    return writer.finish();
+}
+
+/**
+ * @brief Opens the cached layout straight from the flash mapping, or the built-in one.
+ */
+void loadKeypadLayout() {
+    size_t len = 0;
+    const uint8_t* cached = keypadStoreMapped(&len);
+
+    if (cached != NULL && keypadLayout.open(cached, len)) {
+        Serial.printf("CYD: Keypad layout from flash (%d pages, %u bytes)\n",
+                      keypadLayout.pageCount(), (unsigned)keypadLayout.length());
+    } else if (!keypadLayout.open(keypadDefaultBuf, buildDefaultKeypad())) {
+        Serial.println("CYD Error: built-in keypad layout is invalid.");
+    }
+    if (keypadPage >= keypadLayout.pageCount()) keypadPage = 0;
+}
+
+void handleKeypadXferFrame(const uint8_t* data, uint8_t dlc) {
+    if (!keypadStoreAvailable()) return; /* nowhere to keep it; warned at startup */
+
+    if (takeCounted(keypadXferMutex, pdMS_TO_TICKS(5), DIAG_XFER_LOCK_TIMEOUT)) {
+        keypadRx.onFrame(data, dlc, millis());
+        xSemaphoreGive(keypadXferMutex);
+    }
+}
+
+void handleStatusFrame(const uint8_t* data, uint8_t dlc) {
+    uint8_t key;
+    StateValue value;
+    if (!decodeStatusFrame(data, dlc, &key, &value)) return;
+    if (!statusGate.pass(key, value)) return; /* renders as the last one, answers no press */
+
+    StateEvent ev = { key, value, 0 };
+#if CYD_TRACE
+    ev.stamp = traceNow();
+#endif
+    if (!stateEvents.push(ev)) {
+        statusGate.forget(key); /* so the next report for this switch is not gated away */
+        diagCounters.add(DIAG_STATE_EVENT_DROP);
+    }
+}
+
+/**
+ * @brief Applies the state changes passed by the gate. Display task only.
+ */
+void drainStateEvents(uint32_t now) {
+    StateEvent ev;
+    while (stateEvents.pop(ev)) {
+        traceAckKey(ev.key, ev.stamp);
+        if (keypadState.apply(ev.key, ev.value)) uiEvents |= UI_EVT_STATE;
+    }
+    keypadState.service(now); /* expires pending presses; returns at once if none is due */
+}
+
+/**
+ * @brief State key of a stateful button: the switch number in its first payload byte.
+ */
+bool keypadStateKey(const KeypadButtonView& b, uint8_t* key) {
+    if (!(b.flags() & KPL_FLAG_STATEFUL) || b.payloadLen() == 0) return false;
+    *key = b.payload()[0];
+    return true;
+}
+
+/* Receive path: UI frames are routed by ID through a direct index (see candispatch.h) */
+CanDispatch canDispatch;
+
+bool cydCanDispatch(uint16_t id, const uint8_t* data, uint8_t dlc) {
+    return canDispatch.dispatch(id, data, dlc);
+}
+
+bool cydCanRegister(uint16_t first, uint16_t last, CanFrameHandler fn, void* ctx) {
+    return canDispatch.add(first, last, fn, ctx);
+}
+
+#if defined(CYD_NODE_HEARTBEAT_ID) || defined(CYD_NODE_STRIPS_ID)
+static uint32_t canNodeId(const uint8_t* data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+#endif
+
+static void onKeypadXferFrame(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx) {
+    handleKeypadXferFrame(data, dlc);
+}
+
+static void onStatusFrame(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx) {
+    handleStatusFrame(data, dlc);
+}
+
+#ifdef CYD_NODE_HEARTBEAT_ID
+static void onNodeHeartbeat(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx) {
+    if (dlc >= 4) registerARGBNode(canNodeId(data));
+}
+#endif
+
+#ifdef CYD_NODE_STRIPS_ID
+static void onNodeStrips(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx) {
+    if (dlc >= 5) setARGBNodeStripCount(canNodeId(data), data[4]);
+}
+#endif
+
+/**
+ * @brief Registers the frames the UI consumes itself.
+ */
+void registerCanHandlers() {
+    bool ok = canDispatch.add(KEYPAD_XFER_ID, onKeypadXferFrame, NULL);
+    ok = canDispatch.add(KEYPAD_STATUS_ID, onStatusFrame, NULL) && ok;
+#ifdef CYD_NODE_HEARTBEAT_ID
+    ok = canDispatch.add(CYD_NODE_HEARTBEAT_ID, onNodeHeartbeat, NULL) && ok;
+#endif
+#ifdef CYD_NODE_STRIPS_ID
+    ok = canDispatch.add(CYD_NODE_STRIPS_ID, onNodeStrips, NULL) && ok;
+#endif
+    if (!ok) Serial.println("CYD Error: conflicting CAN handler IDs.");
+}
+
+/**
+ * @brief Runs transfer timeouts and installs a completed layout. Display task only.
+ * @details The receive buffer is stable while the transfer is COMPLETE (new
+ *          transfers are told to WAIT), so it is written to flash without the mutex.
+ *          The active layout is closed first: it may point into the mapping.
+ */
+void serviceKeypadXfer(uint32_t now) {
+    if (!keypadStoreAvailable()) return;
+
+    KeypadXferRx::State state;
+    if (!takeCounted(keypadXferMutex, pdMS_TO_TICKS(5), DIAG_XFER_LOCK_TIMEOUT)) return;
+    keypadRx.poll(now);
+    state = keypadRx.state();
+    xSemaphoreGive(keypadXferMutex);
+
+    if (state == KeypadXferRx::FAILED) {
+        Serial.printf("CYD Warning: keypad layout transfer failed (%lu gaps, %lu retries)\n",
+                      (unsigned long)keypadRx.gapCount(), (unsigned long)keypadRx.retryCount());
+    } else if (state == KeypadXferRx::COMPLETE) {
+        KeypadLayout incoming;
+        if (!incoming.open(keypadRx.data(), keypadRx.length())) {
+            Serial.println("CYD Warning: downloaded keypad layout rejected (invalid blob).");
+        } else {
+            keypadLayout.close();
+            if (!keypadStoreCommit(keypadRx.data(), keypadRx.length())) {
+                Serial.println("CYD Error: keypad layout flash write failed.");
+            }
+            loadKeypadLayout(); /* falls back to the built-in layout if the write failed */
+            keypadPage = 0;
+            uiEvents |= UI_EVT_LAYOUT;
+        }
+    } else {
+        return;
+    }
+
+    if (xSemaphoreTake(keypadXferMutex, portMAX_DELAY) == pdTRUE) {
+        keypadRx.release();
+        xSemaphoreGive(keypadXferMutex);
+    }
+}
+
+/**
+ * @brief Capture rows come straight from the panel's GRAM. Caller holds spiSemaphore.
+ */
+class TftRowSource : public FbcPixelSource {
+public:
+    void readRow(int y, uint16_t* out, int width) override {
+        tft.readRect(0, y, width, 1, out);
+    }
+};
+
+/**
+ * @brief Any Arduino Print (Serial, a WiFiClient) as a capture sink
+ * @details Print::availableForWrite() is 0 unless the class overrides it, and
+ *          WiFiClient does not. A Print that has never reported room gets a fixed
+ *          budget per pass instead of stalling the capture; one that has (Serial)
+ *          is waited on while its buffer is full, so it never blocks.
+ */
+class PrintCaptureSink : public FbcSink {
+public:
+    PrintCaptureSink() : _out(NULL), _reportsRoom(false) {}
+    void bind(Print* out) { _out = out; _reportsRoom = false; }
+    size_t room() override {
+        if (_out == NULL) return 0;
+        int n = _out->availableForWrite();
+        if (n > 0) {
+            _reportsRoom = true;
+            return (size_t)n;
+        }
+        return _reportsRoom ? 0 : CAPTURE_CHUNK_BUDGET;
+    }
+    size_t write(const uint8_t* data, size_t len) override { return _out->write(data, len); }
+
+private:
+    Print* _out;
+    bool   _reportsRoom; /**< availableForWrite() has been non-zero since bind() */
+};
+
+/** --- Screen capture state, owned by the display task --- */
+enum CaptureMode { CAPTURE_OFF = 0, CAPTURE_SINGLE, CAPTURE_MIRROR };
+
+/* readRect() returns byte-swapped RGB565 while setSwapBytes() is off (the default here) */
+FrameCapture screenCapture(SCREEN_WIDTH, SCREEN_HEIGHT, FBC_FLAG_SWAPPED);
+TftRowSource captureSource;
+PrintCaptureSink captureSink;
+CaptureMode captureMode = CAPTURE_OFF;
+std::atomic<Print*> captureRequestOut(NULL);
+std::atomic<uint8_t> captureRequest(0); /**< CAPTURE_* + 1 requested by another task, 0 = none */
+uint32_t captureNextAt = 0;             /**< millis() the next mirrored frame may start */
+uint32_t captureFrames = 0;             /**< Frames sent since the capture started */
+uint32_t captureFrameUs = 0;            /**< Encode time (panel reads included) of this frame */
+
+void captureScreen(Print& out, bool continuous) {
+    captureRequestOut.store(&out, std::memory_order_relaxed);
+    captureRequest.store((continuous ? CAPTURE_MIRROR : CAPTURE_SINGLE) + 1, std::memory_order_release);
+}
+
+void captureStop() {
+    captureRequest.store(CAPTURE_OFF + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Advances the screen capture by a few rows. Display task only.
+ * @details Reads are bounded by CAPTURE_ROWS_PER_STEP and by the sink's free
+ *          space, so a slow link stretches the frame instead of the loop.
  */
-const char* menuLabels[] = {"HOME", "COLOR PICKER", "NODE SELECT", "SYSTEM INFO", "HAMBURGER MENU"};
+void serviceCapture(uint32_t now) {
+    uint8_t request = captureRequest.exchange(0, std::memory_order_acquire);
+    if (request != 0) {
+        CaptureMode mode = (CaptureMode)(request - 1);
+
+        screenCapture.abort(); /* a new request restarts with a keyframe */
+        captureMode = CAPTURE_OFF;
+        Print* out = captureRequestOut.load(std::memory_order_relaxed);
+        if (mode != CAPTURE_OFF && out != NULL) {
+            captureSink.bind(out);
+            captureMode = mode;
+            captureFrames = 0;
+            captureNextAt = now;
+        }
+    }
+    if (captureMode == CAPTURE_OFF) return;
+
+    if (!screenCapture.busy()) {
+        if ((int32_t)(now - captureNextAt) < 0) return;
+        screenCapture.begin((captureFrames % CAPTURE_KEYFRAME_EVERY) == 0);
+        captureFrameUs = 0;
+    }
+
+    if (!takeCounted(spiSemaphore, pdMS_TO_TICKS(5), DIAG_SPI_TIMEOUT)) return;
+    uint32_t t0 = micros();
+    bool done = screenCapture.step(captureSource, captureSink, CAPTURE_ROWS_PER_STEP);
+    captureFrameUs += micros() - t0;
+    xSemaphoreGive(spiSemaphore);
+
+    if (!done) return;
+
+    captureFrames++;
+    Serial.printf("CYD: Capture #%u %lu -> %lu bytes, %u rows unchanged, %lu us\n",
+                  screenCapture.sequence(), (unsigned long)screenCapture.frameRawBytes(),
+                  (unsigned long)screenCapture.frameCodedBytes(), screenCapture.frameRowsSkipped(),
+                  (unsigned long)captureFrameUs);
+
+    if (captureMode == CAPTURE_SINGLE) captureMode = CAPTURE_OFF;
+    else captureNextAt = now + CAPTURE_INTERVAL_MS;
+}
 
+/** @brief Boot profiler clock */
+static uint32_t bootClockUs() {
+    return micros();
+}
+
+/**
+ * @brief Starts the CYD UI.
+ * @details Returns quickly so WiFi/CAN bring-up in main.cpp overlaps with the UI start:
+ *          - DisplayTask initialises the panel, blits the splash, then draws the keypad
+ *          - TouchTask configures the touch controller on its own SPI bus
+ *          - the node table is restored here while the panel is initialising
+ */
 void initCYD() {
+    bootProfileReset(bootClockUs);
+    bootMark(BOOT_INIT_START);
+
     spiSemaphore = xSemaphoreCreateBinary(); /* semaphore to control SPI access */
     xSemaphoreGive(spiSemaphore); /* unlock SPI access */
     
-    touchQueue = xQueueCreate(5, sizeof(TouchData));
+    touchQueue = xQueueCreate(TOUCH_QUEUE_LEN, sizeof(TouchData));
     timeQueue = xQueueCreate(1, 10 * sizeof(char));
+    bootEvents = xEventGroupCreate();
+    keypadXferMutex = xSemaphoreCreateMutex();
+    registerCanHandlers(); /* before the receive task can dispatch into them */
+    diagWatchQueue(touchQueue, "touch", TOUCH_QUEUE_LEN);
 
     Serial.println("CYD: Init");
 
+    /* DFS: the UI holds the CPU at full speed until the panel goes idle */
+    powerBegin();
+
     screenOff = false; /* clear the screen off flag */
     screenDim = false; /* clear the screen dim flag */
 
     /* Clear the discovered nodes array to prevent garbage data on UI */
     memset(discoveredNodes, 0, sizeof(discoveredNodes));
 
-    /* Power on the backlight */
+    /* Keep the backlight off until the splash is on the panel (no white flash) */
     pinMode(CYD_BACKLIGHT, OUTPUT);
-    digitalWrite(CYD_BACKLIGHT, HIGH);
-
-    tft.begin(); /* initialize the display */
-    tft.setRotation(1);
-    /* Clear the screen before writing to it */
-    tft.fillScreen(TFT_WHITE);
-    tft.setTextColor(TFT_BLACK, TFT_WHITE);
+    digitalWrite(CYD_BACKLIGHT, LOW);
+
+    /* Start the tasks: panel and touch init run inside them */
+    /* Both UI tasks share CYD_UI_CORE, away from WiFi and TWAI on the other core */
+    xTaskCreatePinnedToCore(TaskReadTouch, "TouchTask", CYD_TOUCH_STACK, NULL, CYD_TOUCH_PRIO, &xTouchHandle, CYD_UI_CORE);
+    xTaskCreatePinnedToCore(TaskUpdateDisplay, "DisplayTask", CYD_DISPLAY_STACK, NULL, CYD_DISPLAY_PRIO, &xDisplayHandle, CYD_UI_CORE);
+    diagWatchTask(xTouchHandle); /* stack fallback when the full task list is not compiled in */
+    diagWatchTask(xDisplayHandle);
+    bootMark(BOOT_TASKS_STARTED);
+
+    /* Bring back the nodes seen before the last power cycle, before the first frame */
+    restoreNodeTable();
+    keypadStoreBegin();
+    loadKeypadLayout();
+    bootMark(BOOT_REGISTRY_READY);
+    xEventGroupSetBits(bootEvents, BOOT_BIT_REGISTRY);
+}
 
-    /* Setup the touchscreen */
-    touchscreenSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS); /* configure SPI interface for touchscreen */
-    touchscreen.begin(touchscreenSPI);
-    touchscreen.setRotation(1);
-  
-    /* Start the tasks */
-    xTaskCreate(TaskReadTouch, "TouchTask", 4096, NULL, 2, &xTouchHandle);          /* assign task handles */
-    xTaskCreate(TaskUpdateDisplay, "DisplayTask", 6144, NULL, 1, &xDisplayHandle);
+/**
+ * @brief Prints the boot stage timings and checks them against CYD_BOOT_TARGET_MS.
+ */
+void reportBootProfile() {
+    char report[256];
+    bootFormatReport(report, sizeof(report));
+    Serial.print("CYD: Boot profile\n");
+    Serial.print(report);
+
+    uint32_t totalMs = bootElapsedUs(BOOT_INTERACTIVE) / 1000;
+    if (!bootSequenceValid()) {
+        Serial.println("CYD Warning: boot stages completed out of order.");
+    }
+    if (totalMs > CYD_BOOT_TARGET_MS) {
+        Serial.printf("CYD Warning: boot-to-interactive %lu ms exceeds target %d ms\n",
+                      (unsigned long)totalMs, CYD_BOOT_TARGET_MS);
+    }
 }
 
 /**
@@ -231,10 +751,34 @@ void drawHeader(const char* title) {
         tft.drawString(nodeLbl, 80, 28, 1);
     }
 
+#if CYD_HEADER_CLOCK
+    headerClock.invalidate();
+    drawHeaderClock(millis());
+#endif
+
     /* Right: Hamburger Menu Icon */
     drawHamburgerIcon(); /**< Hamburger icon at x=280 */
 }
 
+/**
+ * @brief Draws one grid button: body, icon in the upper half, label in the lower half
+ */
+void drawGridButton(int bx, int by, int bw, int bh, uint16_t color,
+                    const char* label, void (*drawIcon)(int x, int y)) {
+    /* Draw Button Body */
+    tft.fillRoundRect(bx, by, bw, bh, 8, color);
+    tft.drawRoundRect(bx, by, bw, bh, 8, TFT_WHITE);
+
+    /* Draw Icon (Upper half) */
+    if (drawIcon != NULL) {
+        drawIcon(bx + (bw / 2), by + (bh / 2) - 10);
+    }
+
+    /* Draw Label (Lower half) */
+    tft.setTextColor(TFT_WHITE);
+    tft.drawCentreString(label, bx + (bw / 2), by + bh - 22, 2);
+}
+
 /**
  * @brief Draws a 2x2 grid of buttons based on the provided items
  * @param title The header title for the screen
@@ -246,38 +790,100 @@ void drawUnifiedGrid(const char* title, GridItem* items) {
     drawFooter();
 
     for (int i = 0; i < 4; i++) {
-        int bx = buttons[i].x;
-        int by = buttons[i].y;
-        int bw = buttons[i].w;
-        int bh = buttons[i].h;
-
-        /* Draw Button Body */
-        tft.fillRoundRect(bx, by, bw, bh, 8, items[i].color);
-        tft.drawRoundRect(bx, by, bw, bh, 8, TFT_WHITE);
-        
-        /* Draw Icon (Upper half) */
-        if (items[i].drawIcon != NULL) {
-            items[i].drawIcon(bx + (bw / 2), by + (bh / 2) - 10);
-        }
+        drawGridButton(buttons[i].x, buttons[i].y, buttons[i].w, buttons[i].h,
+                       items[i].color, items[i].label, items[i].drawIcon);
+    }
+}
 
-        /* Draw Label (Lower half) */
-        tft.setTextColor(TFT_WHITE);
-        tft.drawCentreString(items[i].label, bx + (bw / 2), by + bh - 22, 2);
+/**
+ * @brief send_message() for UI actions: stamps the touch being dispatched.
+ * @param ackNode Node expected to answer (heartbeat), 0 for none
+ * @param ackKey Switch whose status echo answers instead, -1 for none
+ */
+void sendUiMessage(uint16_t msgid, uint8_t* data, uint8_t dlc, uint32_t ackNode, int16_t ackKey) {
+    send_message(msgid, data, dlc);
+    TRACE_MARK(dispatchTraceId, TRACE_SENT);
+
+    if (dispatchTraceId != 0 && (ackNode != 0 || ackKey >= 0)) {
+        ackTraceId = dispatchTraceId;
+        ackTraceNode = ackNode;
+        ackTraceKey = (ackNode != 0) ? -1 : ackKey;
+    }
+}
+
+/**
+ * @brief A frame from node id arrived at stamp: completes the trace waiting on it, if any.
+ */
+void traceAck(uint32_t id, uint32_t stamp) {
+    if (ackTraceNode != 0 && ackTraceNode == id) {
+#if CYD_TRACE
+        touchTrace.mark(ackTraceId, TRACE_ACK, stamp);
+#endif
+        ackTraceNode = 0;
+    }
+}
+
+/**
+ * @brief A status for switch key arrived at stamp: completes the keypad press waiting on it, if any.
+ */
+void traceAckKey(uint8_t key, uint32_t stamp) {
+    if (ackTraceKey >= 0 && ackTraceKey == key) {
+#if CYD_TRACE
+        touchTrace.mark(ackTraceId, TRACE_ACK, stamp);
+#else
+        (void)stamp;
+#endif
+        ackTraceKey = -1;
     }
 }
 
 /**
- * @brief Logic to register or update a discovered ARGB node
+ * @brief Queues a heartbeat for the display task (CAN receive task side)
  * @param id The 32-bit Node ID extracted from the CAN frame
  */
 void registerARGBNode(uint32_t id) {
+    NodeEvent ev = { id, (uint32_t)millis(), 0, NODE_EVT_HEARTBEAT, 0 };
+#if CYD_TRACE
+    ev.stamp = traceNow();
+#endif
+    if (!nodeEvents.push(ev)) diagCounters.add(DIAG_NODE_EVENT_DROP);
+}
+
+/**
+ * @brief Queues a strip count report for the display task (CAN receive task side)
+ * @param id The 32-bit Node ID
+ * @param stripCount Number of ARGB strips on the node
+ */
+void setARGBNodeStripCount(uint32_t id, uint8_t stripCount) {
+    NodeEvent ev = { id, (uint32_t)millis(), 0, NODE_EVT_STRIPS, stripCount };
+    if (!nodeEvents.push(ev)) diagCounters.add(DIAG_NODE_EVENT_DROP);
+}
+
+/**
+ * @brief Logic to register or update a discovered ARGB node (display task)
+ */
+void applyHeartbeat(const NodeEvent& ev) {
+    const uint32_t id = ev.id;
     int emptySlot = -1;
 
-    for (int i = 0; i < 5; i++) {
+    traceAck(id, ev.stamp);
+
+    if (firstHeartbeatMs == 0) {
+        firstHeartbeatMs = ev.atMs;
+        Serial.printf("CYD: First node heartbeat at %lu ms\n", (unsigned long)firstHeartbeatMs);
+    }
+
+    for (int i = 0; i < MAX_ARGB_NODES; i++) {
         /* Case 1: Node already exists in our table */
         if (discoveredNodes[i].id == id) {
-            discoveredNodes[i].lastSeen = millis();
+            if (!discoveredNodes[i].active || !discoveredNodes[i].confirmed) {
+                nodeList.markSlotDirty(i);
+                uiEvents |= UI_EVT_NODES;
+            }
+            if (discoveredNodes[i].activity < 0xFFFF) discoveredNodes[i].activity++;
+            discoveredNodes[i].lastSeen = ev.atMs;
             discoveredNodes[i].active = true;
+            discoveredNodes[i].confirmed = true;
             return;
         }
 
@@ -291,15 +897,104 @@ void registerARGBNode(uint32_t id) {
     if (emptySlot != -1) {
         discoveredNodes[emptySlot].id = id;
         discoveredNodes[emptySlot].active = true;
-        discoveredNodes[emptySlot].lastSeen = millis();
+        discoveredNodes[emptySlot].confirmed = true;
+        discoveredNodes[emptySlot].lastSeen = ev.atMs;
+        discoveredNodes[emptySlot].activity = 1;
+        discoveredNodeCount++;
+        nodeListResort = true;
+        uiEvents |= UI_EVT_NODES | UI_EVT_LIST;
+        nodePersister.markDirty(millis());
         
         Serial.printf("UI: Registered New ARGB Node [0x%08X] at slot %d\n", id, emptySlot);
-    } else {
-        /* Case 3: Project limit reached (5 nodes) */
+        return;
+    }
+
+    /* Case 3: Table full. Take over the slot of a node that is not being heard,
+     * so nodes restored from flash that never come back do not lock new ones out */
+    const int slot = nodeStoreEvictSlot(discoveredNodes, MAX_ARGB_NODES, ev.atMs);
+    if (slot < 0) {
         Serial.println("UI Warning: Discovered node ignored, table full.");
+        return;
+    }
+
+    Serial.printf("UI: Node [0x%08X] replaces %s node [0x%08X] at slot %d\n", id,
+                  discoveredNodes[slot].confirmed ? "silent" : "unconfirmed",
+                  discoveredNodes[slot].id, slot);
+    discoveredNodes[slot].id = id;
+    discoveredNodes[slot].lastColorIdx = 0;
+    discoveredNodes[slot].stripCount = 0;
+    discoveredNodes[slot].active = true;
+    discoveredNodes[slot].confirmed = true;
+    discoveredNodes[slot].lastSeen = ev.atMs;
+    discoveredNodes[slot].activity = 1;
+    nodeListResort = true;
+    uiEvents |= UI_EVT_NODES | UI_EVT_LIST;
+    nodePersister.markDirty(millis());
+}
+
+
+/**
+ * @brief Records the strip count reported by a node (display task)
+ */
+void applyStripCount(const NodeEvent& ev) {
+    for (int i = 0; i < MAX_ARGB_NODES; i++) {
+        if (discoveredNodes[i].id == ev.id) {
+            if (discoveredNodes[i].activity < 0xFFFF) discoveredNodes[i].activity++;
+            if (discoveredNodes[i].stripCount != ev.value) {
+                discoveredNodes[i].stripCount = ev.value;
+                nodePersister.markDirty(millis());
+                nodeList.markSlotDirty(i);
+                uiEvents |= UI_EVT_NODES;
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Applies the node events queued by the CAN receive task. Display task only.
+ */
+void drainNodeEvents() {
+    NodeEvent ev;
+    while (nodeEvents.pop(ev)) {
+        if (ev.type == NODE_EVT_HEARTBEAT) applyHeartbeat(ev);
+        else if (ev.type == NODE_EVT_STRIPS) applyStripCount(ev);
     }
 }
 
+/**
+ * @brief Decodes a compressed asset (see imgasset.h) straight into the panel window.
+ * @details IMG_BLIT_PIXELS at a time through one static buffer; display task only.
+ * @return Time taken in microseconds.
+ */
+uint32_t drawImgAsset(const ImgAsset& asset, int16_t x, int16_t y) {
+    static uint16_t block[IMG_BLIT_PIXELS];
+    ImgDecoder dec;
+    uint32_t t0 = micros();
+
+    dec.begin(asset);
+    bool swap = tft.getSwapBytes();
+    tft.setSwapBytes(true); /* palette entries are native-order RGB565 */
+    tft.startWrite();
+    tft.setAddrWindow(x, y, asset.width, asset.height);
+    size_t n;
+    while ((n = dec.read(block, IMG_BLIT_PIXELS)) > 0) tft.pushPixels(block, n);
+    tft.endWrite();
+    tft.setSwapBytes(swap);
+
+    if (dec.failed()) Serial.printf("CYD: Asset %ux%u is corrupt\n", asset.width, asset.height);
+    return micros() - t0;
+}
+
+/**
+ * @brief Shows the compressed boot splash (see splash.h).
+ */
+void drawBootSplash() {
+    tft.fillScreen(TFT_BLACK);
+    uint32_t us = drawImgAsset(splashAsset, centerX - (SPLASH_WIDTH / 2), centerY - (SPLASH_HEIGHT / 2));
+    Serial.printf("CYD: Splash %lu bytes flash, blit %lu us\n",
+                  (unsigned long)imgAssetBytes(splashAsset), (unsigned long)us);
+}
 
 /**
  * @brief Draws a simple splash screen while waiting for CAN sync
@@ -369,9 +1064,9 @@ void drawInfoIcon(int x, int y) {
 
 void drawColorPicker() {
     int swatchW = 40;
-    int swatchH = 45;
+    int swatchH = PICKER_SWATCH_H;
     int startY = 45;
-    drawHeader("COLOR PICKER");
+    drawHeader(currentTitle());
 
     /* Get the currently active color for the selected node */
     int activeIdx = discoveredNodes[selectedNodeIdx].lastColorIdx;
@@ -394,162 +1089,1168 @@ void drawColorPicker() {
             tft.drawRect(x, y, swatchW, swatchH, TFT_WHITE);
         }
     }
-}
-
-void drawHamburgerMenu() {
-    GridItem menuItems[4] = {
-        {"HOME",    TFT_BLUE,       drawHomeIcon},
-        {"COLORS",  TFT_DARKGREEN,  drawPaletteIcon},
-        {"NODES",   TFT_MAROON,     drawNetworkIcon},
-        {"SYSTEM",  TFT_NAVY,       drawInfoIcon}
-    };
-    drawUnifiedGrid("MAIN MENU", menuItems);
-}
 
-void drawKeypad() {
-    GridItem keypadItems[4] = {
-        {"LT BAR", TFT_BLUE,       drawLightbarIcon},
-        {"SEAT WARMER",   TFT_MAROON,     drawSeatWarmerIcon},
-        {"WTR PUMP",     TFT_DARKGREEN,  drawWaterPumpIcon},
-        {"DEFROST",  TFT_ORANGE,     drawDefrosterIcon}
-    };
-    
-    drawUnifiedGrid("VEHICLE CONTROL", keypadItems);
+    /* The grid stops short of the bottom: clear what the previous screen left below it */
+    const int gridBottom = startY + 4 * swatchH;
+    tft.fillRect(0, gridBottom, SCREEN_WIDTH, SCREEN_HEIGHT - gridBottom, TFT_BLACK);
+    drawPageButton("FX >");
 }
 
 /**
- * @brief Draws the node selection screen with color-coded node states.
- * - Yellow: Currently selected node.
- * - White: Active (but not selected) node.
- * - Light Grey: Inactive node.
+ * @struct MenuEntry
+ * @brief One main menu button; its label is the title of the screen it opens
  */
-void drawNodeSelector() {
-    /* 1. Draw the standard blue header */
-    // tft.fillRect(0, 0, 320, 43, TFT_BLUE);
-    // tft.setTextColor(TFT_WHITE, TFT_BLUE);
-    // tft.drawCentreString("SELECT TARGET NODE", 160, 10, 2);
-    drawHeader("SELECT TARGET NODE");
-    // drawPickerIcon();
-    // drawHamburgerIcon();
-
-    /* 2. Draw the Content Area */
-    tft.fillRect(0, 44, 320, 196, TFT_BLACK);
-
- /* 2. Content Area Setup */
-    const uint16_t headerHeight = 44;               /**< Space reserved for header */
-    const uint16_t contentHeight = 240 - headerHeight; /**< 196 pixels remaining */
-    
-    const uint8_t  cols = 4;
-    const uint8_t  rows = 2;
-    const uint16_t btnW = 320 / cols;               /**< 80 pixels wide */
-    const uint16_t btnH = contentHeight / rows;     /**< 98 pixels high */
-
-    tft.fillRect(0, headerHeight, 320, contentHeight, TFT_BLACK);
-
-    for (int i = 0; i < discoveredNodeCount; i++) {
-        /* Calculate grid coordinates relative to content area */
-        int col = i % cols;
-        int row = i / cols;
-        int x = col * btnW;
-        int y = headerHeight + (row * btnH);
-
-        /* Truncate Node ID to last 2 bytes */
-        char label[8];
-        sprintf(label, "0x%04X", (uint16_t)(discoveredNodes[i].id & 0xFFFF));
-
-        /* Resolve background color from the saved index */
-        uint16_t bgColor = TFT_BLACK;
-        int idx = discoveredNodes[i].lastColorIdx;
-        if (idx >= 0 && idx < COLOR_PALETTE_SIZE) {
-            bgColor = colorTo565(SystemPalette[idx]);
-        }
+struct MenuEntry {
+    DisplayMode screen;
+    uint16_t color;
+    void (*drawIcon)(int x, int y);
+};
 
-        /* Draw Button Body */
-        tft.fillRect(x + 2, y + 2, btnW - 4, btnH - 4, bgColor);
-        
-        /* Contrast border and selection highlight */
-        uint16_t borderColor = (i == selectedNodeIdx) ? TFT_YELLOW : 
-                               (bgColor < 0x2104) ? TFT_DARKGREY : TFT_WHITE;
-        
-        tft.drawRect(x + 2, y + 2, btnW - 4, btnH - 4, borderColor);
-        if (i == selectedNodeIdx) {
-            tft.drawRect(x + 3, y + 3, btnW - 6, btnH - 6, TFT_YELLOW); /**< Thicker highlight */
-        }
+const MenuEntry menuEntries[4] = {
+    {MODE_HOME,         TFT_BLUE,       drawHomeIcon},
+    {MODE_COLOR_PICKER, TFT_DARKGREEN,  drawPaletteIcon},
+    {MODE_NODE_SEL,     TFT_MAROON,     drawNetworkIcon},
+    {MODE_SYSTEM_INFO,  TFT_NAVY,       drawInfoIcon}
+};
 
-        /* Text Contrast Logic */
-        uint16_t textColor = (bgColor > 0x7BEF) ? TFT_BLACK : TFT_WHITE;
-        tft.setTextColor(textColor);
-        tft.setTextDatum(MC_DATUM);
-        tft.drawString(label, x + (btnW / 2), y + (btnH / 2), 2);
+void drawHamburgerMenu() {
+    GridItem menuItems[4];
+    for (int i = 0; i < 4; i++) {
+        menuItems[i].label = screenTitle(menuEntries[i].screen);
+        menuItems[i].color = menuEntries[i].color;
+        menuItems[i].drawIcon = menuEntries[i].drawIcon;
     }
-    
-    /* 3. Footer hint */
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.drawCentreString("Tap ID to select target", 160, 225, 1);
+    drawUnifiedGrid(currentTitle(), menuItems);
 }
 
+/**
+ * @brief Keypad layout icon IDs (KPL_ICON_*) mapped to drawing functions
+ */
+void (*const keypadIcons[KPL_ICON_COUNT])(int x, int y) = {
+    NULL,                /* KPL_ICON_NONE */
+    drawLightbarIcon,
+    drawSeatWarmerIcon,
+    drawWaterPumpIcon,
+    drawDefrosterIcon,
+    drawHomeIcon,
+    drawPaletteIcon,
+    drawNetworkIcon,
+    drawInfoIcon
+};
 
 /**
- * @brief Draws diagnostic info including the relocated clock and CAN metrics.
+ * @brief Draws one keypad button with the state of its switch, if it is stateful.
+ * - Green frame, "ON" or level: output on. White frame, "OFF": output off.
+ * - Yellow frame, "...": pressed, waiting for the node. Red frame, "FAULT": node reports a fault.
  */
-void drawSystemInfo() {
-    tft.fillScreen(TFT_BLACK);
-    drawHeader("SYSTEM INFO");
-
-    /* --- Relocated Clock --- */
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-        char timeStr[20];
-        strftime(timeStr, sizeof(timeStr), "%H:%M:%S", &timeinfo);
-        tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-        tft.drawCentreString(timeStr, 160, 60, 4); 
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        tft.drawCentreString("System Time (UTC/Local)", 160, 95, 1);
+void drawKeypadButton(const KeypadButtonView& b) {
+    void (*icon)(int, int) = (b.iconId() < KPL_ICON_COUNT) ? keypadIcons[b.iconId()] : NULL;
+    drawGridButton(b.x(), b.y(), b.w(), b.h(), b.color(), b.label(), icon);
+
+    uint8_t key;
+    if (!keypadStateKey(b, &key)) return;
+    const uint8_t visual = keypadState.visual(key);
+    if (!(visual & (STATE_FLAG_KNOWN | STATE_FLAG_PENDING))) return; /* never reported */
+
+    uint16_t frame = TFT_WHITE;
+    char badge[8] = "OFF";
+    if (visual & STATE_FLAG_FAULT) {
+        frame = TFT_RED;
+        strcpy(badge, "FAULT");
+    } else if (visual & STATE_FLAG_PENDING) {
+        frame = TFT_YELLOW;
+        strcpy(badge, "...");
+    } else if (visual & STATE_FLAG_ON) {
+        frame = TFT_GREEN;
+        if (stateVisualLevel(visual) != 0) sprintf(badge, "%d%%", stateVisualLevel(visual) * 10);
+        else strcpy(badge, "ON");
     }
 
-    /* --- Detailed CAN & Network Metrics --- */
-    twai_status_info_t status;
-    int yPos = 120;
-    
-    if (twai_get_status_info(&status) == ESP_OK) {
-        tft.setTextColor(TFT_CYAN, TFT_BLACK);
-        tft.drawString("CAN BUS STATUS:", 20, yPos, 2);
-        tft.setTextColor(TFT_WHITE, TFT_BLACK);
-        
-        tft.setCursor(30, yPos + 20);
-        tft.printf("State: %s", (status.state == TWAI_STATE_RUNNING) ? "RUNNING" : "ERROR");
-        tft.setCursor(30, yPos + 40);
-        tft.printf("TX Errs: %d | RX Errs: %d", status.tx_error_counter, status.rx_error_counter);
+    for (int i = 0; i < 3; i++) {
+        tft.drawRoundRect(b.x() + i, b.y() + i, b.w() - 2 * i, b.h() - 2 * i, 8 - i, frame);
     }
-
-    /* Network Info */
-    tft.setTextColor(TFT_GREEN, TFT_BLACK);
-    tft.drawString("NETWORK:", 20, yPos + 70, 2);
-    tft.setTextColor(TFT_WHITE, TFT_BLACK);
-    tft.setCursor(30, yPos + 90);
-    tft.printf("IP: %s", wifiIP.c_str());
-    tft.setCursor(30, yPos + 110);
-    tft.printf("RSSI: %d dBm", WiFi.RSSI());
+    tft.setTextColor(frame);
+    tft.drawRightString(badge, b.x() + b.w() - 8, b.y() + 6, 2);
 }
 
 /**
- * @brief Redraws the current screen based on the active mode. Keep this function below other draw functions
+ * @brief Draws the buttons of the current keypad page, read in place from the layout
+ * @details Also rebinds the page's stateful buttons to their switch state slots.
  */
-void refreshCurrentScreen() {
-    switch(currentMode) {
-        case MODE_HOME:           drawKeypad();        break;
-        case MODE_COLOR_PICKER:   drawColorPicker();   break;
-        case MODE_NODE_SEL:       drawNodeSelector();  break;
-        case MODE_SYSTEM_INFO:    drawSystemInfo();    break;
-        case MODE_HAMBURGER_MENU: drawHamburgerMenu(); break;
+void drawKeypadButtons() {
+    tft.fillRect(0, 45, 320, 165, TFT_BLACK);
+    keypadState.clearSubscriptions();
+
+    KeypadPageView page = keypadLayout.page(keypadPage);
+    if (!page.valid()) return;
+
+    KeypadButtonView b = page.first();
+    for (uint8_t i = 0; i < page.buttonCount(); i++, b = KeypadPageView::next(b)) {
+        uint8_t key;
+        if (keypadStateKey(b, &key)) keypadState.subscribe(i, key);
+        drawKeypadButton(b);
     }
+    keypadState.takeDirtyWidgets(); /* all drawn with their current state */
 }
 
-/** Task 1: Read Touch */
-void TaskReadTouch(void * pvParameters) {
-  TouchData currentTouch;
+/**
+ * @brief Repaints only the buttons whose switch state renders differently.
+ */
+void drawKeypadDirtyButtons() {
+    uint32_t dirty = keypadState.takeDirtyWidgets();
+    if (dirty == 0) return;
+
+    KeypadPageView page = keypadLayout.page(keypadPage);
+    if (!page.valid()) return;
+
+    KeypadButtonView b = page.first();
+    for (uint8_t i = 0; i < page.buttonCount() && dirty != 0; i++, b = KeypadPageView::next(b), dirty >>= 1) {
+        if (dirty & 1) drawKeypadButton(b);
+    }
+}
+
+/**
+ * @brief Page indicator in the middle of the footer; tapping its sides flips pages
+ */
+void drawKeypadPager() {
+    if (keypadLayout.pageCount() < 2) return;
+
+    char pager[16];
+    sprintf(pager, "<  %d/%d  >", keypadPage + 1, keypadLayout.pageCount());
+    tft.setTextColor(TFT_WHITE, TFT_DARKGREY);
+    tft.drawCentreString(pager, 160, 215, 2);
+}
+
+void drawKeypad() {
+    tft.fillScreen(TFT_BLACK);
+    drawHeader(currentTitle());
+    drawFooter();
+    drawKeypadPager();
+    drawKeypadButtons();
+}
+
+/**
+ * @brief Draws one row of the node list in place.
+ * - Yellow frame: Currently selected node.
+ * - White ID: Active node, light grey: timed out, "?": restored from flash, not yet seen.
+ */
+void drawNodeRow(uint8_t row) {
+    const int16_t y = nodeList.rowTop(row);
+    const int16_t h = nodeList.rowHeight();
+    const int slot = nodeList.slotAtRow(row);
+
+    if (slot < 0) {
+        tft.fillRect(0, y, 320, h, TFT_BLACK);
+        return;
+    }
+
+    const ARGBNode& node = discoveredNodes[slot];
+    const bool selected = (slot == selectedNodeIdx);
+    const uint16_t bg = selected ? TFT_NAVY : TFT_BLACK;
+
+    tft.fillRect(0, y, 320, h, bg);
+    if (selected) tft.drawRect(0, y, 320, h, TFT_YELLOW);
+    else tft.drawFastHLine(0, y + h - 1, 320, TFT_DARKGREY);
+
+    /* Swatch with the last colour sent to the node */
+    int idx = node.lastColorIdx;
+    if (idx >= 0 && idx < COLOR_PALETTE_SIZE) {
+        tft.fillRect(8, y + 4, 16, h - 8, colorTo565(SystemPalette[idx]));
+    }
+    tft.drawRect(8, y + 4, 16, h - 8, TFT_WHITE);
+
+    char text[16];
+    sprintf(text, "0x%08X%s", node.id, node.confirmed ? "" : "?");
+    tft.setTextColor(node.active ? TFT_WHITE : TFT_LIGHTGREY, bg);
+    tft.drawString(text, 34, y + 4, 2);
+
+    if (node.stripCount != 0) {
+        sprintf(text, "%u strip%s", node.stripCount, (node.stripCount == 1) ? "" : "s");
+        tft.drawString(text, 150, y + 4, 2);
+    }
+
+    const char* status = node.active ? "ONLINE" : (node.confirmed ? "OFFLINE" : "SAVED");
+    tft.setTextColor(node.active ? TFT_GREEN : TFT_DARKGREY, bg);
+    tft.drawRightString(status, 312, y + 4, 2);
+}
+
+/**
+ * @brief Hex pad for the ID prefix filter, drawn over the list rows.
+ * @details 4x4 digits on the left, DEL / CLR / OK in the right column.
+ */
+void drawNodeFilterPad() {
+    static const char* side[] = { "DEL", "CLR", "OK" };
+    const int16_t top = NODE_LIST_TOP;
+    const int16_t keyH = (nodeList.bottom() - top) / 4;
+    const int16_t sideH = (nodeList.bottom() - top) / 3;
+
+    tft.fillRect(0, top, 320, nodeList.bottom() - top, TFT_BLACK);
+    for (uint8_t d = 0; d < 16; d++) {
+        char label[2] = { "0123456789ABCDEF"[d], '\0' };
+        int16_t x = (d % 4) * 60;
+        int16_t y = top + (d / 4) * keyH;
+        tft.drawRoundRect(x + 2, y + 2, 56, keyH - 4, 6, TFT_WHITE);
+        tft.setTextColor(TFT_WHITE, TFT_BLACK);
+        tft.drawCentreString(label, x + 30, y + (keyH / 2) - 8, 2);
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        int16_t y = top + i * sideH;
+        tft.fillRoundRect(242, y + 2, 76, sideH - 4, 6, (i == 2) ? TFT_DARKGREEN : TFT_DARKGREY);
+        tft.setTextColor(TFT_WHITE);
+        tft.drawCentreString(side[i], 280, y + (sideH / 2) - 8, 2);
+    }
+}
+
+/**
+ * @brief Toolbar under the list: "<  page/pages  >", sort key and ID filter.
+ */
+void drawNodeToolbar() {
+    static const char* sortNames[NODE_SORT_COUNT] = { "SORT: ID", "SORT: SEEN", "SORT: BUSY" };
+    const int16_t y = nodeList.bottom();
+    char text[20];
+
+    tft.fillRect(0, y, 320, 240 - y, TFT_DARKGREY);
+    tft.setTextColor(TFT_WHITE, TFT_DARKGREY);
+
+    sprintf(text, "<  %d/%d  >", nodeList.page() + 1, nodeList.pageCount());
+    tft.drawCentreString(text, 80, y + 6, 2);
+    tft.drawCentreString(sortNames[nodeList.sort()], 200, y + 6, 2);
+
+    char prefix[NODELIST_ID_DIGITS + 1];
+    nodeList.formatFilter(prefix, sizeof(prefix));
+    sprintf(text, "ID: %s%s", prefix, (prefix[0] == '\0') ? "ALL" : (nodeFilterEdit ? "_" : "*"));
+    tft.setTextColor(nodeFilterEdit ? TFT_YELLOW : TFT_WHITE, TFT_DARKGREY);
+    tft.drawCentreString(text, 280, y + 6, 2);
+}
+
+/**
+ * @brief Rows of the current page only, or the filter pad while it is open.
+ */
+void drawNodeListBody() {
+    if (nodeFilterEdit) {
+        drawNodeFilterPad();
+        return;
+    }
+
+    for (uint8_t row = 0; row < nodeList.rows(); row++) drawNodeRow(row);
+
+    if (nodeList.count() == 0) {
+        char text[32];
+        char prefix[NODELIST_ID_DIGITS + 1];
+        nodeList.formatFilter(prefix, sizeof(prefix));
+        if (prefix[0] != '\0') sprintf(text, "No node ID starts with %s", prefix);
+        else strcpy(text, "Waiting for node heartbeats");
+        tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+        tft.drawCentreString(text, 160, NODE_LIST_TOP + 60, 2);
+    }
+}
+
+/**
+ * @brief Re-sorts and re-filters the node list if the table changed since the last rebuild.
+ */
+void refreshNodeList() {
+    if (!nodeListResort) return;
+    nodeList.rebuild(nodeSource, millis());
+    nodeListResort = false;
+}
+
+/**
+ * @brief Draws the node selection screen: a paged list, so only one page of
+ *        rows is ever drawn regardless of the number of nodes.
+ */
+void enterNodeSelector() {
+    nodeListResort = true; /* a freshly opened list takes a new snapshot of the order */
+}
+
+void drawNodeSelector() {
+    refreshNodeList();
+
+    drawHeader(currentTitle());
+    drawNodeListBody();
+    drawNodeToolbar();
+}
+
+/**
+ * @brief Node selector: list or toolbar changes repaint the page, node changes only their rows.
+ */
+void updateNodeScreen(uint32_t events) {
+    if (events & UI_EVT_SCREEN) events |= UI_EVT_HEADER | UI_EVT_LIST; /* same order, page and filter */
+    if (events & UI_EVT_HEADER) drawHeader(currentTitle());
+
+    if (events & UI_EVT_LIST) {
+        refreshNodeList();
+        drawNodeListBody();
+        drawNodeToolbar();
+        return;
+    }
+
+    uint32_t dirty = nodeList.takeDirtyRows();
+    if (nodeFilterEdit) return;
+    for (uint8_t row = 0; dirty != 0; row++, dirty >>= 1) {
+        if (dirty & 1) drawNodeRow(row);
+    }
+}
+
+
+/**
+ * @brief Bottom-right button linking the system info and diagnostics pages.
+ */
+void drawPageButton(const char* label) {
+    tft.fillRoundRect(PAGE_BTN_X, PAGE_BTN_Y, PAGE_BTN_W, PAGE_BTN_H, 6, TFT_DARKGREY);
+    tft.setTextColor(TFT_WHITE);
+    tft.drawCentreString(label, PAGE_BTN_X + PAGE_BTN_W / 2, PAGE_BTN_Y + 4, 2);
+}
+
+bool pageButtonHit(int x, int y) {
+    return x >= PAGE_BTN_X && x <= PAGE_BTN_X + PAGE_BTN_W &&
+           y >= PAGE_BTN_Y && y <= PAGE_BTN_Y + PAGE_BTN_H;
+}
+
+/**
+ * @brief Local time of day as "HH:MM:SS" from the clock service, "--:--:--" if never synced.
+ * @details Arithmetic plus localtime_r() only; never waits for SNTP.
+ */
+void clockText(uint32_t now, char* out) {
+    int64_t wallMs;
+    if (!cydClock.now(now, &wallMs)) {
+        strcpy(out, "--:--:--");
+        return;
+    }
+    time_t t = (time_t)(wallMs / 1000);
+    struct tm tmLocal;
+    localtime_r(&t, &tmLocal);
+    clockFormatHms(tmLocal.tm_hour * 3600UL + tmLocal.tm_min * 60UL + tmLocal.tm_sec, out);
+}
+
+/**
+ * @brief Draws the characters of text that differ from what widget shows, in fixed cells.
+ */
+void drawClockDigits(ClockDigits& widget, const char* text, int16_t x, int16_t y,
+                     uint8_t font, int16_t cellW, int16_t cellH, uint16_t fg, uint16_t bg) {
+    uint16_t changed = widget.update(text);
+    tft.setTextColor(fg, bg);
+    for (uint8_t i = 0; i < CLOCK_TEXT_LEN && text[i] != '\0'; i++) {
+        if (!(changed & (1U << i))) continue;
+        char ch[2] = { text[i], '\0' };
+        tft.fillRect(x + i * cellW, y, cellW, cellH, bg);
+        tft.drawCentreString(ch, x + i * cellW + cellW / 2, y, font);
+    }
+}
+
+#if CYD_HEADER_CLOCK
+/**
+ * @brief Small clock right of the header title; only changed digits are redrawn.
+ */
+void drawHeaderClock(uint32_t now) {
+    char text[CLOCK_TEXT_LEN + 1];
+    clockText(now, text);
+    drawClockDigits(headerClock, text, 196, 30, 1, 6, 8, cydClock.synced() ? TFT_WHITE : TFT_LIGHTGREY, TFT_BLUE);
+}
+#endif
+
+/**
+ * @brief System info clock: changed digits, plus the caption when the sync state changes.
+ */
+void drawInfoClock(uint32_t now) {
+    char text[CLOCK_TEXT_LEN + 1];
+    clockText(now, text);
+    drawClockDigits(infoClock, text, 160 - (CLOCK_TEXT_LEN * 16) / 2, 60, 4, 16, 26,
+                    cydClock.synced() ? TFT_YELLOW : TFT_DARKGREY, TFT_BLACK);
+
+    const ClockState state = cydClock.state();
+    if (infoClockCaption == state) return;
+    infoClockCaption = state;
+    static const char* const captions[] = { "Time not set (no network)", "Waiting for time sync", "System Time (Local)" };
+    tft.fillRect(0, 95, 320, 10, TFT_BLACK);
+    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    tft.drawCentreString(captions[state], 160, 95, 1);
+}
+
+/**
+ * @brief CAN, network and latency figures; repainted in place every second.
+ */
+void drawSystemMetrics() {
+    tft.fillRect(0, 118, 320, 92, TFT_BLACK);
+    tft.fillRect(0, 210, PAGE_BTN_X - 4, 30, TFT_BLACK);
+
+    /* --- Detailed CAN & Network Metrics --- */
+    twai_status_info_t status;
+    int yPos = 120;
+    
+    if (twai_get_status_info(&status) == ESP_OK) {
+        tft.setTextColor(TFT_CYAN, TFT_BLACK);
+        tft.drawString("CAN BUS STATUS:", 20, yPos, 2);
+        tft.setTextColor(TFT_WHITE, TFT_BLACK);
+        
+        tft.setCursor(30, yPos + 20);
+        tft.printf("State: %s", (status.state == TWAI_STATE_RUNNING) ? "RUNNING" : "ERROR");
+        tft.setCursor(30, yPos + 40);
+        tft.printf("TX Errs: %d | RX Errs: %d", status.tx_error_counter, status.rx_error_counter);
+    }
+
+    /* Network Info */
+    tft.setTextColor(TFT_GREEN, TFT_BLACK);
+    tft.drawString("NETWORK:", 20, yPos + 70, 2);
+    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    tft.setCursor(30, yPos + 90);
+    tft.printf("IP: %s", wifiIP.c_str());
+    tft.setCursor(30, yPos + 110);
+    tft.printf("RSSI: %d dBm", WiFi.RSSI());
+
+#if CYD_TRACE
+    /* Touch-to-bus latency, p50/p99 per stage */
+    TraceStat st[TRACE_STAGE_COUNT];
+    touchTrace.summarize(st, CYD_PM_MAX_MHZ);
+
+    tft.setTextColor(TFT_ORANGE, TFT_BLACK);
+    tft.drawString("LATENCY us", 200, yPos, 2);
+    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    for (int s = 1; s <= TRACE_STAGE_COUNT; s++) {
+        const int i = (s == TRACE_STAGE_COUNT) ? TRACE_STAT_TOTAL : s; /* total last */
+        tft.setCursor(200, yPos + 10 + s * 10);
+        if (st[i].count == 0) tft.printf("%-8s -", TraceRing::stageName((TraceStage)i));
+        else tft.printf("%-8s %lu/%lu", TraceRing::stageName((TraceStage)i),
+                        (unsigned long)st[i].p50Us, (unsigned long)st[i].p99Us);
+    }
+#endif
+}
+
+/**
+ * @brief Draws diagnostic info including the clock and CAN metrics.
+ */
+void drawSystemInfo() {
+    tft.fillScreen(TFT_BLACK);
+    drawHeader(currentTitle());
+
+    infoClock.invalidate();
+    infoClockCaption = -1;
+    drawInfoClock(millis());
+    drawSystemMetrics();
+    drawPageButton("DIAG >");
+}
+
+/**
+ * @brief System info: clock digits and metrics each second, without clearing the screen.
+ */
+void updateSystemInfo(uint32_t events) {
+    if (events & UI_EVT_SCREEN) {
+        drawSystemInfo();
+        return;
+    }
+    if (events & UI_EVT_HEADER) drawHeader(currentTitle());
+    if (events & UI_EVT_CLOCK) drawInfoClock(millis());
+    if (events & (UI_EVT_CLOCK | UI_EVT_NETWORK)) drawSystemMetrics();
+}
+
+/**
+ * @brief Flags UI_EVT_CLOCK once per displayed second (uptime second until synced).
+ * @details Redraws the header clock digits directly when enabled.
+ */
+void serviceClock(uint32_t now) {
+    static uint32_t lastSecond = 0xFFFFFFFF;
+    static uint8_t lastState = 0xFF;
+
+    int64_t wallMs;
+    const uint32_t second = cydClock.now(now, &wallMs) ? (uint32_t)(wallMs / 1000) : (now / 1000);
+    const uint8_t state = cydClock.state();
+    if (second == lastSecond && state == lastState) return;
+    lastSecond = second;
+    lastState = state;
+    uiEvents |= UI_EVT_CLOCK;
+
+#if CYD_HEADER_CLOCK
+    if (!panelAsleep && takeCounted(spiSemaphore, pdMS_TO_TICKS(10), DIAG_SPI_TIMEOUT)) {
+        drawHeaderClock(now);
+        xSemaphoreGive(spiSemaphore);
+    }
+#endif
+}
+
+/**
+ * @brief Puts the ILI9341 into sleep-in mode and lets the CPU clock down.
+ * @details GRAM is retained, so an unchanged screen needs no repaint on wake.
+ */
+void panelSleep() {
+    tft.writecommand(TFT_DISPOFF);
+    tft.writecommand(TFT_SLPIN);
+    panelSleptAt = millis();
+    panelAsleep = true;
+    powerIdle();
+}
+
+/**
+ * @brief Takes the ILI9341 out of sleep-in mode.
+ */
+void panelWake() {
+    powerActive();
+
+    /* ILI9341 requires 120 ms between SLPIN and SLPOUT */
+    uint32_t sinceSleep = millis() - panelSleptAt;
+    if (sinceSleep < 120) vTaskDelay(pdMS_TO_TICKS(120 - sinceSleep));
+
+    tft.writecommand(TFT_SLPOUT);
+    vTaskDelay(pdMS_TO_TICKS(5)); /* ILI9341 needs 5 ms after SLPOUT before the next command */
+    tft.writecommand(TFT_DISPON);
+    panelAsleep = false;
+}
+
+/**
+ * @section Screen touch handlers
+ * Content-area touches (y >= 45) for each registered screen.
+ */
+
+/**
+ * @brief Keypad: send the button's momentary press with visual feedback.
+ */
+bool touchKeypad(int x, int y) {
+    const uint8_t pages = keypadLayout.pageCount();
+
+    /* Footer: the left and right thirds flip pages */
+    if (y >= 210) {
+        if (pages < 2) return false;
+        if (x < 107) keypadPage = (keypadPage + pages - 1) % pages;
+        else if (x > 213) keypadPage = (keypadPage + 1) % pages;
+        else return false;
+        uiEvents |= UI_EVT_LAYOUT;
+        return true;
+    }
+
+    KeypadPageView page = keypadLayout.page(keypadPage);
+    if (!page.valid()) return false;
+
+    KeypadButtonView b = page.first();
+    for (uint8_t i = 0; i < page.buttonCount(); i++, b = KeypadPageView::next(b)) {
+        if (!b.contains(x, y)) continue;
+
+        /* Visual Feedback */
+        if (takeCounted(spiSemaphore, pdMS_TO_TICKS(10), DIAG_SPI_TIMEOUT)) {
+            tft.drawRoundRect(b.x(), b.y(), b.w(), b.h(), 8, TFT_RED);
+            xSemaphoreGive(spiSemaphore);
+        }
+
+        /* Payload, optionally behind our node ID, capped at one classic CAN frame */
+        uint8_t canData[8];
+        uint8_t dlc = 0;
+        if (b.flags() & KPL_FLAG_PREFIX_NODE_ID) {
+            memcpy(canData, (void*)myNodeID, 4);
+            dlc = 4;
+        }
+        uint8_t n = b.payloadLen();
+        if (dlc + n > 8) n = 8 - dlc;
+        memcpy(canData + dlc, b.payload(), n);
+        dlc += n;
+        /* Stateful buttons are answered by the status echo of their switch */
+        uint8_t key;
+        const bool stateful = keypadStateKey(b, &key);
+        if (stateful) statusGate.expect(key); /* the echo clears "pending" even if nothing changed */
+        sendUiMessage(b.canId(), canData, dlc, 0, stateful ? key : -1);
+
+        vTaskDelay(pdMS_TO_TICKS(150)); 
+
+        /* Stateful buttons show "pending" until the node reports the change */
+        if (stateful) {
+            keypadState.setPending(key, millis(), STATE_PENDING_MS);
+            keypadState.invalidate(i); /* repaint over the feedback outline */
+            uiEvents |= UI_EVT_STATE;
+        } else if (takeCounted(spiSemaphore, pdMS_TO_TICKS(10), DIAG_SPI_TIMEOUT)) {
+            tft.drawRoundRect(b.x(), b.y(), b.w(), b.h(), 8, TFT_WHITE);
+            xSemaphoreGive(spiSemaphore);
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Colour picker: set the selected node's colour and send it.
+ */
+bool touchColorPicker(int x, int y) {
+    if (pageButtonHit(x, y)) {
+        navPush(MODE_EFFECTS);
+        return true;
+    }
+
+    /* Ensure touch is within the palette grid area */
+    if (y < 45 || y >= 45 + 4 * PICKER_SWATCH_H) return false;
+
+    int col = x / 40;
+    int row = (y - 45) / PICKER_SWATCH_H;
+    
+    /* Clamp values to grid bounds */
+    if (col > 7) col = 7;
+    if (row > 3) row = 3;
+
+    int colorIdx = (row * 8) + col;
+    if (colorIdx < 0 || colorIdx >= 32) return false;
+
+    /* Update local state */
+    if (discoveredNodes[selectedNodeIdx].lastColorIdx != colorIdx) {
+        discoveredNodes[selectedNodeIdx].lastColorIdx = colorIdx;
+        nodePersister.markDirty(millis());
+        nodeList.markSlotDirty(selectedNodeIdx);
+    }
+
+    /* Construct and send CAN message */
+    uint32_t targetID = discoveredNodes[selectedNodeIdx].id;
+    uint8_t canData[6];
+    canData[0] = (targetID >> 24) & 0xFF;
+    canData[1] = (targetID >> 16) & 0xFF;
+    canData[2] = (targetID >> 8) & 0xFF;
+    canData[3] = targetID & 0xFF;
+    canData[4] = 0; // LED Strip/Index
+    canData[5] = (uint8_t)colorIdx;
+
+    sendUiMessage(SET_ARGB_STRIP_COLOR_ID, canData, SET_ARGB_STRIP_COLOR_DLC, targetID);
+
+    /* Selection highlight is repainted by the screen's UI_EVT_NODES policy */
+    uiEvents |= UI_EVT_NODES;
+    return true;
+}
+
+/**
+ * @brief Makes slot the target node; only the two affected list rows repaint.
+ */
+void selectNode(int slot) {
+    if (slot < 0 || slot >= MAX_ARGB_NODES || slot == selectedNodeIdx) return;
+    if (discoveredNodes[slot].id == 0) return;
+
+    nodeList.markSlotDirty(selectedNodeIdx);
+    nodeList.markSlotDirty(slot);
+    selectedNodeIdx = slot;
+    uiEvents |= UI_EVT_SELECTION;
+}
+
+/**
+ * @brief Node selector hex pad: edits the ID prefix, the list follows every digit.
+ */
+bool touchNodeFilterPad(int x, int y) {
+    const int16_t top = NODE_LIST_TOP;
+    const int16_t height = nodeList.bottom() - top;
+
+    if (x >= 240) {
+        switch ((y - top) * 3 / height) {
+            case 0: nodeList.popFilterDigit(); break;
+            case 1: nodeList.clearFilter(); break;
+            default: nodeFilterEdit = false; break;
+        }
+    } else {
+        uint8_t digit = (uint8_t)(((y - top) * 4 / height) * 4 + x / 60);
+        if (!nodeList.pushFilterDigit(digit)) return false;
+    }
+
+    nodeListResort = true;
+    uiEvents |= UI_EVT_LIST;
+    return true;
+}
+
+/**
+ * @brief Node selector toolbar: pager thirds, sort key, filter pad toggle.
+ */
+bool touchNodeToolbar(int x) {
+    if (x < 160) {
+        /* Same "<  n/m  >" split as the keypad pager */
+        bool changed = (x < 80) ? nodeList.prevPage() : nodeList.nextPage();
+        if (!changed) return false;
+    } else if (x < 240) {
+        nodeList.setSort((NodeSortKey)((nodeList.sort() + 1) % NODE_SORT_COUNT));
+        nodeListResort = true;
+    } else {
+        nodeFilterEdit = !nodeFilterEdit;
+    }
+    uiEvents |= UI_EVT_LIST;
+    return true;
+}
+
+/**
+ * @brief Node selector: pick the target node from the rows actually drawn.
+ */
+bool touchNodeSelector(int x, int y) {
+    if (y >= nodeList.bottom()) return touchNodeToolbar(x);
+    if (nodeFilterEdit) return touchNodeFilterPad(x, y);
+
+    int slot = nodeList.hitTest(y);
+    if (slot < 0) return false;
+    selectNode(slot);
+    return true;
+}
+
+void navReset(DisplayMode mode);
+void navReplace(DisplayMode mode);
+void navBack();
+
+/**
+ * @brief System info: the diagnostics page button.
+ */
+bool touchSystemInfo(int x, int y) {
+    if (!pageButtonHit(x, y)) return false;
+    navPush(MODE_DIAGNOSTICS);
+    return true;
+}
+
+/**
+ * @brief CPU share history as bars, one pixel column per sample, newest on the right.
+ */
+void drawDiagSparkline(const DiagRing<uint16_t>& cpu, int16_t x, int16_t y, int16_t h) {
+    tft.fillRect(x, y, DIAG_HISTORY, h, TFT_BLACK);
+    const uint8_t n = cpu.size();
+    for (uint8_t i = 0; i < n; i++) {
+        int16_t bar = (int16_t)((cpu.at(i) * h + 999) / 1000);
+        if (bar > 0) tft.drawFastVLine(x + DIAG_HISTORY - n + i, y + h - bar, bar, TFT_GREEN);
+    }
+}
+
+/**
+ * @brief Task, queue and lock health: the busiest tasks first, then queues and counters.
+ */
+void drawDiagnostics() {
+    tft.fillScreen(TFT_BLACK);
+    drawHeader(currentTitle());
+
+    /* Present tasks, busiest (latest sample) first */
+    uint8_t order[DIAG_MAX_TASKS];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < diagHistory.taskCount(); i++) {
+        if (!diagHistory.task(i).present) continue;
+        uint8_t j = n++;
+        while (j > 0 && diagHistory.task(order[j - 1]).cpu.latest() < diagHistory.task(i).cpu.latest()) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    const bool cpu = diagHistory.hasRunTime();
+    tft.setTextColor(TFT_CYAN, TFT_BLACK);
+    tft.setCursor(4, 48);
+    tft.printf("%-15s C  CPU%%  AVG%%  STACK", "TASK");
+
+    const uint8_t rows = (n > DIAG_SCREEN_TASKS) ? DIAG_SCREEN_TASKS : n;
+    for (uint8_t r = 0; r < rows; r++) {
+        const DiagTask& t = diagHistory.task(order[r]);
+        const int16_t y = 60 + r * 10;
+
+        tft.setTextColor(TFT_WHITE, TFT_BLACK);
+        tft.setCursor(4, y);
+        tft.printf("%-15s %c ", t.name, (t.core < 0) ? '-' : (char)('0' + t.core));
+        if (cpu && t.cpu.size() > 0) {
+            tft.printf("%3u.%u %3lu.%lu ", t.cpu.latest() / 10, t.cpu.latest() % 10,
+                       (unsigned long)(t.cpu.mean() / 10), (unsigned long)(t.cpu.mean() % 10));
+        } else {
+            tft.printf("    -     - ");
+        }
+        tft.setTextColor((t.stackFree < DIAG_STACK_WARN) ? TFT_RED : TFT_WHITE, TFT_BLACK);
+        tft.printf("%6lu", (unsigned long)t.stackFree);
+
+        if (cpu) drawDiagSparkline(t.cpu, 280, y, 8);
+    }
+
+    /* Queues and counters: lifetime total and the last sample's increment */
+    int16_t y = 64 + DIAG_SCREEN_TASKS * 10;
+    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
+    for (uint8_t q = 0; q < diagHistory.queueCount(); q++, y += 10) {
+        const DiagQueue& dq = diagHistory.queue(q);
+        tft.setCursor(4, y);
+        tft.printf("queue %-8s %u/%u peak %u", dq.name, dq.fill.latest(), dq.capacity, dq.peak);
+    }
+    for (uint8_t c = 0; c < DIAG_COUNTER_COUNT; c++) {
+        const int16_t cx = (c % 2) ? 124 : 4;
+        tft.setTextColor(diagHistory.counterTotal(c) ? TFT_ORANGE : TFT_WHITE, TFT_BLACK);
+        tft.setCursor(cx, y);
+        tft.printf("%-10s %lu (+%u)", diagCounterName(c), (unsigned long)diagHistory.counterTotal(c),
+                   diagHistory.counterHistory(c).latest());
+        if (c % 2) y += 10;
+    }
+
+    drawPageButton("< BACK");
+}
+
+/**
+ * @brief Diagnostics: back to the page that opened it.
+ */
+bool touchDiagnostics(int x, int y) {
+    if (!pageButtonHit(x, y)) return false;
+    navBack();
+    return true;
+}
+
+/**
+ * @brief Palette index -> LED colour, as the nodes resolve it.
+ */
+EffectRgb paletteRgb(uint8_t idx) {
+    const PaletteColor& p = SystemPalette[idx % COLOR_PALETTE_SIZE];
+    EffectRgb c = { p.R, p.G, p.B };
+    return c;
+}
+
+/**
+ * @brief Strips the selected node reports; at least one so a new node can be driven.
+ */
+uint8_t effectStripCount() {
+    uint8_t n = discoveredNodes[selectedNodeIdx].stripCount;
+    if (n == 0) n = 1;
+    return (n > EFFECT_MAX_STRIPS) ? EFFECT_MAX_STRIPS : n;
+}
+
+/**
+ * @brief Effect editor controls: effect, speed, colours A/B and strips. The preview is separate.
+ */
+void drawEffectControls() {
+    char text[24];
+
+    /* Effects, two rows of four */
+    for (uint8_t e = 0; e < EFFECT_COUNT; e++) {
+        const int16_t x = (e % 4) * 80;
+        const int16_t y = FX_EFFECT_Y + (e / 4) * 30;
+        const bool on = (e == effectCmd.effect);
+        tft.fillRoundRect(x + 2, y, 76, 26, 6, on ? TFT_DARKGREEN : TFT_DARKGREY);
+        tft.setTextColor(TFT_WHITE);
+        tft.drawCentreString(effectName(e), x + 40, y + 5, 2);
+    }
+
+    /* Speed: "<  period  >" */
+    tft.fillRect(0, FX_SPEED_Y, 320, 24, TFT_BLACK);
+    tft.setTextColor(TFT_WHITE, TFT_BLACK);
+    tft.drawCentreString("<", 30, FX_SPEED_Y + 4, 2);
+    tft.drawCentreString(">", 290, FX_SPEED_Y + 4, 2);
+    sprintf(text, "SPEED %u  (%u ms)", effectCmd.speed + 1, effectPeriodMs(effectCmd.speed));
+    tft.drawCentreString(text, 160, FX_SPEED_Y + 4, 2);
+
+    /* Palette row; the slot being edited is marked in it */
+    const uint8_t editing = effectEditB ? effectCmd.colourB : effectCmd.colourA;
+    for (uint8_t i = 0; i < COLOR_PALETTE_SIZE; i++) {
+        tft.fillRect(i * 10, FX_PALETTE_Y, 10, 16, colorTo565(SystemPalette[i]));
+        if (i == editing) tft.drawRect(i * 10, FX_PALETTE_Y, 10, 16, TFT_RED);
+    }
+
+    /* Colour slots A and B, and SEND */
+    const uint8_t slots[2] = { effectCmd.colourA, effectCmd.colourB };
+    for (uint8_t s = 0; s < 2; s++) {
+        const int16_t x = 2 + s * 80;
+        tft.fillRoundRect(x, FX_SLOT_Y, 76, 24, 6, colorTo565(SystemPalette[slots[s]]));
+        tft.drawRoundRect(x, FX_SLOT_Y, 76, 24, 6, (effectEditB == (s == 1)) ? TFT_RED : TFT_WHITE);
+        tft.setTextColor(TFT_WHITE);
+        tft.drawCentreString(s ? "B" : "A", x + 38, FX_SLOT_Y + 4, 2);
+    }
+    tft.fillRoundRect(242, FX_SLOT_Y, 76, 24, 6, TFT_BLUE);
+    tft.setTextColor(TFT_WHITE);
+    tft.drawCentreString("SEND", 280, FX_SLOT_Y + 4, 2);
+
+    /* Strip toggles */
+    tft.fillRect(0, FX_STRIP_Y, 320, 240 - FX_STRIP_Y, TFT_BLACK);
+    tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    tft.drawString("STRIPS", 4, FX_STRIP_Y + 8, 2);
+    for (uint8_t s = 0; s < effectStripCount(); s++) {
+        const int16_t x = FX_STRIP_X + s * 30;
+        const bool on = (effectCmd.stripMask & (1 << s)) != 0;
+        tft.fillRoundRect(x, FX_STRIP_Y + 2, 28, 26, 5, on ? TFT_DARKGREEN : TFT_DARKGREY);
+        sprintf(text, "%u", s + 1);
+        tft.setTextColor(TFT_WHITE);
+        tft.drawCentreString(text, x + 14, FX_STRIP_Y + 7, 2);
+    }
+}
+
+/**
+ * @brief Renders the preview strip into the cached sprite; pushes it only if a LED changed.
+ * @details Effect time is millis(), the clock the sent phase is stamped from, so the
+ *          preview runs in step with the nodes. SPI must be held by the caller.
+ */
+void drawEffectPreview(uint32_t now, bool force) {
+    if (!effectSprite.created()) {
+        effectSprite.setColorDepth(16);
+        if (effectSprite.createSprite(320, FX_PREVIEW_H) == NULL) return;
+    }
+
+    const EffectRgb a = paletteRgb(effectCmd.colourA);
+    const EffectRgb b = paletteRgb(effectCmd.colourB);
+    bool changed = force;
+    for (uint8_t i = 0; i < FX_PREVIEW_LEDS; i++) {
+        EffectRgb c = effectPixel(effectCmd.effect, effectCmd.speed, a, b, now, i, FX_PREVIEW_LEDS);
+        if (c.r != effectShown[i].r || c.g != effectShown[i].g || c.b != effectShown[i].b) {
+            effectShown[i] = c;
+            changed = true;
+        }
+    }
+    if (!changed) return;
+
+    const int16_t pitch = 320 / FX_PREVIEW_LEDS;
+    effectSprite.fillSprite(TFT_BLACK);
+    for (uint8_t i = 0; i < FX_PREVIEW_LEDS; i++) {
+        PaletteColor c(effectShown[i].r, effectShown[i].g, effectShown[i].b);
+        effectSprite.fillCircle(i * pitch + pitch / 2, FX_PREVIEW_H / 2, pitch / 2 - 2, colorTo565(c));
+        effectSprite.drawCircle(i * pitch + pitch / 2, FX_PREVIEW_H / 2, pitch / 2 - 2, TFT_DARKGREY);
+    }
+    effectSprite.pushSprite(0, FX_PREVIEW_Y);
+}
+
+void drawEffects() {
+    tft.fillScreen(TFT_BLACK);
+    drawHeader(currentTitle());
+    drawEffectControls();
+    drawEffectPreview(millis(), true);
+}
+
+/**
+ * @brief Effects: header and controls repaint in place; the preview has its own pace.
+ */
+void updateEffects(uint32_t events) {
+    if (events & UI_EVT_SCREEN) {
+        drawEffects();
+        return;
+    }
+    if (events & UI_EVT_HEADER) drawHeader(currentTitle());
+    if (events & (UI_EVT_EFFECT | UI_EVT_NODES | UI_EVT_SELECTION)) drawEffectControls();
+}
+
+/**
+ * @brief Effects tick (every FX_PREVIEW_MS): advances the preview animation.
+ */
+void tickEffects(uint32_t now) {
+    drawEffectPreview(now, false);
+}
+
+/**
+ * @brief Sends the effect to the selected strips of the target node: one frame, whatever the effect.
+ */
+void sendEffect() {
+    const uint32_t targetID = discoveredNodes[selectedNodeIdx].id;
+    /* The mask outlives a node change: drop strips this node does not have */
+    effectCmd.stripMask &= (uint8_t)((1 << effectStripCount()) - 1);
+    if (targetID == 0 || effectCmd.stripMask == 0) return;
+
+    uint8_t frame[EFFECT_FRAME_DLC];
+    effectCmd.phase = effectPhaseAt(millis(), effectCmd.speed);
+    if (!encodeEffectFrame(targetID, effectCmd, frame)) return;
+
+    sendUiMessage(ARGB_EFFECT_ID, frame, EFFECT_FRAME_DLC, targetID);
+    effectFramesSent++;
+    Serial.printf("CYD: Effect %s speed %u strips 0x%02X -> node 0x%08X (%lu effect frames sent)\n",
+                  effectName(effectCmd.effect), effectCmd.speed, effectCmd.stripMask,
+                  (unsigned int)targetID, (unsigned long)effectFramesSent);
+}
+
+bool touchEffects(int x, int y) {
+    if (y >= FX_EFFECT_Y && y < FX_EFFECT_Y + 60) {
+        uint8_t e = (uint8_t)(((y - FX_EFFECT_Y) / 30) * 4 + x / 80);
+        if (e >= EFFECT_COUNT) return false;
+        effectCmd.effect = e;
+    } else if (y >= FX_SPEED_Y && y < FX_SPEED_Y + 24) {
+        if (x < 80 && effectCmd.speed > 0) effectCmd.speed--;
+        else if (x >= 240 && effectCmd.speed < EFFECT_SPEEDS - 1) effectCmd.speed++;
+        else return false;
+    } else if (y >= FX_PALETTE_Y && y < FX_PALETTE_Y + 16) {
+        uint8_t idx = (uint8_t)(x / 10);
+        if (idx >= COLOR_PALETTE_SIZE) return false;
+        if (effectEditB) effectCmd.colourB = idx;
+        else effectCmd.colourA = idx;
+    } else if (y >= FX_SLOT_Y && y < FX_SLOT_Y + 24) {
+        if (x >= 240) {
+            sendEffect();
+            return true;
+        }
+        if (x >= 160) return false;
+        effectEditB = (x >= 80);
+    } else if (y >= FX_STRIP_Y && x >= FX_STRIP_X) {
+        uint8_t s = (uint8_t)((x - FX_STRIP_X) / 30);
+        if (s >= effectStripCount()) return false;
+        effectCmd.stripMask ^= (uint8_t)(1 << s);
+    } else {
+        return false;
+    }
+    uiEvents |= UI_EVT_EFFECT;
+    return true;
+}
+
+/**
+ * @brief Main menu: open the chosen screen in place of the menu.
+ */
+bool touchMenu(int x, int y) {
+    for (int i = 0; i < 4; i++) {
+        if (x >= buttons[i].x && x <= (buttons[i].x + buttons[i].w) &&
+            y >= buttons[i].y && y <= (buttons[i].y + buttons[i].h)) {
+            /* Back from the target returns to the opener */
+            if (menuEntries[i].screen == MODE_HOME) navReset(MODE_HOME);
+            else navReplace(menuEntries[i].screen);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Main menu: a full redraw when returned to, otherwise header and footer repaint in place.
+ */
+void updateGridScreen(uint32_t events) {
+    if (events & UI_EVT_SCREEN) {
+        drawHamburgerMenu();
+        return;
+    }
+    if (events & UI_EVT_HEADER) drawHeader(currentTitle());
+    if (events & UI_EVT_NETWORK) drawFooter();
+}
+
+/**
+ * @brief Keypad: the grid header/footer updates plus the pager and page body.
+ */
+void updateKeypadScreen(uint32_t events) {
+    if (events & UI_EVT_SCREEN) {
+        tft.fillScreen(TFT_BLACK);
+        events |= UI_EVT_NETWORK | UI_EVT_LAYOUT; /* same page */
+    }
+    if (events & (UI_EVT_HEADER | UI_EVT_LAYOUT)) drawHeader(currentTitle());
+    if (events & UI_EVT_NETWORK) drawFooter();
+    if (events & (UI_EVT_NETWORK | UI_EVT_LAYOUT)) drawKeypadPager();
+    if (events & UI_EVT_LAYOUT) drawKeypadButtons();
+    else if (events & UI_EVT_STATE) drawKeypadDirtyButtons();
+}
+
+/**
+ * @brief The screen registry. Adding a screen means adding a DisplayMode and one entry
+ *        here (plus a menuEntries slot if the main menu should open it).
+ */
+const ScreenDef screenTable[] = {
+    /* id,                 title,                onEnter,           onTouch,           onTick,      draw,              update,             refreshMs,    dirtyOn */
+    { MODE_HOME,           "VEHICLE CONTROL",    NULL,              touchKeypad,       NULL,        drawKeypad,        updateKeypadScreen, 0,            UI_EVT_NETWORK | UI_EVT_LAYOUT | UI_EVT_STATE },
+    { MODE_COLOR_PICKER,   "COLOR PICKER",       NULL,              touchColorPicker,  NULL,        drawColorPicker,   NULL,               0,            UI_EVT_NODES | UI_EVT_SELECTION },
+    { MODE_NODE_SEL,       "SELECT TARGET NODE", enterNodeSelector, touchNodeSelector, NULL,        drawNodeSelector,  updateNodeScreen,   0,            UI_EVT_NODES | UI_EVT_SELECTION | UI_EVT_LIST },
+    { MODE_SYSTEM_INFO,    "SYSTEM INFO",        NULL,              touchSystemInfo,   NULL,        drawSystemInfo,    updateSystemInfo,   0,            UI_EVT_CLOCK | UI_EVT_NETWORK },
+    { MODE_HAMBURGER_MENU, "MAIN MENU",          NULL,              touchMenu,         NULL,        drawHamburgerMenu, updateGridScreen,   0,            UI_EVT_NETWORK },
+    { MODE_DIAGNOSTICS,    "DIAGNOSTICS",        NULL,              touchDiagnostics,  NULL,        drawDiagnostics,   NULL,               1000,         0 },
+    { MODE_EFFECTS,        "STRIP EFFECTS",      NULL,              touchEffects,      tickEffects, drawEffects,       updateEffects,      FX_PREVIEW_MS, UI_EVT_NODES | UI_EVT_SELECTION | UI_EVT_EFFECT },
+};
+
+ScreenNav screenNav(screenTable, sizeof(screenTable) / sizeof(screenTable[0]));
+
+/**
+ * @brief Title of the screen on top of the navigation stack
+ * @details The keypad shows the title of its current layout page, if it has one.
+ */
+const char* currentTitle() {
+    const ScreenDef* def = screenNav.current();
+    if (def == NULL) return "";
+
+    if (def->id == MODE_HOME) {
+        KeypadPageView page = keypadLayout.page(keypadPage);
+        if (page.valid() && page.title()[0] != '\0') return page.title();
+    }
+    return def->title;
+}
+
+/**
+ * @brief Registered title of a screen, "" if it is not registered.
+ */
+const char* screenTitle(uint8_t id) {
+    const ScreenDef* def = screenNav.find(id);
+    return (def != NULL) ? def->title : "";
+}
+
+/**
+ * @brief Fully redraws the current screen. Caller holds spiSemaphore.
+ */
+void refreshCurrentScreen() {
+    const ScreenDef* def = screenNav.current();
+    if (def == NULL) return;
+
+    currentMode = (DisplayMode)def->id;
+    if (def->draw != NULL) def->draw();
+    screenLastTick = millis();
+    uiEvents = 0; /* a full draw covers every pending event */
+}
+
+/**
+ * @brief Runs the current screen's refresh policy. Caller holds spiSemaphore.
+ * @details Only the work the policy asks for is done: nothing, the shared header,
+ *          a partial update, or a periodic tick/redraw.
+ */
+void serviceScreen(uint32_t now) {
+    const ScreenDef* def = screenNav.current();
+    if (def == NULL) return;
+
+    ScreenWork work = screenWorkFor(*def, uiEvents, now, screenLastTick);
+    if (work == SCREEN_WORK_TICK) {
+        screenLastTick = now;
+        if (def->onTick == NULL) {
+            if (def->draw != NULL) def->draw();
+            uiEvents = 0; /* the periodic full draw covers every pending event */
+            return;
+        }
+        /* onTick repaints only its own parts; pending events are still served below */
+        def->onTick(now);
+        work = screenWorkFor(*def, uiEvents, now, screenLastTick);
+    }
+
+    switch (work) {
+        case SCREEN_WORK_HEADER:
+            drawHeader(currentTitle());
+            break;
+        case SCREEN_WORK_UPDATE:
+            if (def->update != NULL) def->update(uiEvents);
+            else if (def->draw != NULL) def->draw();
+            break;
+        default:
+            break;
+    }
+    uiEvents = 0;
+}
+
+/**
+ * @brief Shows the screen now on top of the stack.
+ * @param enter true for a newly entered screen (runs onEnter, full draw), false when
+ *        returning via back: the screen's state was kept, so its update hook repaints
+ *        it from that state on the next serviceScreen() pass.
+ */
+void showTopScreen(bool enter) {
+    const ScreenDef* def = screenNav.current();
+    if (def == NULL) return;
+
+    currentMode = (DisplayMode)def->id;
+    if (!enter) {
+        uiEvents |= UI_EVT_SCREEN | UI_EVT_HEADER;
+        screenLastTick = millis();
+        return;
+    }
+    if (def->onEnter != NULL) def->onEnter();
+
+    if (takeCounted(spiSemaphore, pdMS_TO_TICKS(100), DIAG_SPI_TIMEOUT)) {
+        refreshCurrentScreen();
+        xSemaphoreGive(spiSemaphore);
+    }
+}
+
+/** @brief Makes mode the root screen, discarding the back stack */
+void navReset(DisplayMode mode) {
+    if (screenNav.reset(mode)) showTopScreen(true);
+}
+
+/** @brief Opens mode on top of the current screen */
+void navPush(DisplayMode mode) {
+    if (screenNav.push(mode)) showTopScreen(true);
+}
+
+/** @brief Swaps the current screen for mode, keeping the back stack below it */
+void navReplace(DisplayMode mode) {
+    if (screenNav.replace(mode)) showTopScreen(true);
+}
+
+/** @brief Returns to the previous screen; its state is kept and repainted through update() */
+void navBack() {
+    if (screenNav.back()) showTopScreen(false);
+}
+
+/** Task 1: Read Touch */
+void TaskReadTouch(void * pvParameters) {
+  TouchData currentTouch;
+  bool fingerDown = false;   /**< Contact seen on the previous poll */
+  uint16_t pendingTrace = 0; /**< Trace opened at finger-down, sent with the first queued sample */
+  uint32_t wakeUs = 0;       /**< First contact since the panel went to sleep */
   Serial.println("CYD: Touch Task Started");
 
+  /* Setup the touchscreen (own SPI bus, runs while the panel initialises) */
+  touchscreenSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS); /* configure SPI interface for touchscreen */
+  touchscreen.begin(touchscreenSPI);
+  touchscreen.setRotation(1);
+  bootMark(BOOT_TOUCH_READY);
+  xEventGroupSetBits(bootEvents, BOOT_BIT_TOUCH);
+
   for(;;) {
     /* Only process touch if CAN is healthy and not suspended */
     if (can_driver_installed && !can_suspended) {
@@ -557,33 +2258,135 @@ void TaskReadTouch(void * pvParameters) {
 
       /* Try to take the mutex (wait up to 10ms if busy) */
       if (touchscreen.tirqTouched() && touchscreen.touched()) {
-        if (spiSemaphore != NULL && xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
+        const bool asleep = panelAsleep.load(std::memory_order_acquire);
+
+        /* Trace from finger-down; wake touches are discarded, so they are not traced */
+        if (!fingerDown && !asleep) pendingTrace = TRACE_BEGIN();
+        fingerDown = true;
+
+        /* Any contact un-dims; the display task owns the dim state and the backlight */
+        if (!asleep) wakeUs = 0;
+        else if (wakeUs == 0) wakeUs = micros();
+        TouchContact contact = { (uint32_t)millis(), wakeUs };
+        touchContacts.publish(contact);
+
+        if (spiSemaphore != NULL && takeCounted(spiSemaphore, pdMS_TO_TICKS(10), DIAG_SPI_TIMEOUT)) {
           TS_Point p = touchscreen.getPoint();
           currentTouch.x = map(p.x, 200, 3700, 1, SCREEN_WIDTH);
           currentTouch.y = map(p.y, 240, 3800, 1, SCREEN_HEIGHT);
           currentTouch.z = p.z;
+          currentTouch.traceId = 0;
           
-          if (p.z > 800) { /* Only queue if the press is firm enough */
-            xQueueSend(touchQueue, &currentTouch, 0);
+          if (asleep && screenOff.load(std::memory_order_acquire)) {
+            xQueueSend(touchQueue, &currentTouch, 0); /* any contact wakes; the display task discards it */
+          } else if (p.z > 800) { /* Only queue if the press is firm enough */
+            currentTouch.traceId = pendingTrace;
+            if (xQueueSend(touchQueue, &currentTouch, 0) == pdTRUE) {
+              TRACE_MARK(pendingTrace, TRACE_QUEUED);
+              pendingTrace = 0;
+            } else {
+              diagCounters.add(DIAG_TOUCH_QUEUE_FULL);
+            }
           }
 
           /* Always give the mutex back! */
           xSemaphoreGive(spiSemaphore);
-
-          /* If the screen is dimmed or off, turn it back on */
-          if (screenDim || screenOff) {
-              screenDim = false;
-              screenOff = false;
-              /* Turn screen back on */
-              handleHardwareBlink(CYD_BACKLIGHT_IDX, CYD_BACKLIGHT, CYD_BACKLIGHT_PWM_HZ, LEDC_13BIT_100PCT);
-          }
         }
+      } else {
+        fingerDown = false;
       }
     } else {
       /* Optional: Clear queue if bus drops to prevent latent actions */
       xQueueReset(touchQueue);
     }
-    vTaskDelay(pdMS_TO_TICKS(20)); /* High polling rate for touch */
+    /* High polling rate for touch, relaxed when idle */
+    vTaskDelay(pdMS_TO_TICKS(screenOff.load(std::memory_order_relaxed) ? 50 : 20));
+  }
+}
+
+/**
+ * @brief Picks up the newest finger contact from the touch task: restarts the
+ *        dim timer and brings the backlight back. The panel wake itself runs
+ *        in wakeFromIdle().
+ */
+void serviceTouchContact() {
+  TouchContact contact;
+  if (!touchContacts.read(contact, touchContactSeq)) return;
+
+  tsLastTouch = contact.ms;
+  if (contact.wakeUs != 0 && wakeRequestUs == 0) wakeRequestUs = contact.wakeUs;
+
+  if (screenDim || screenOff) {
+      screenDim = false;
+      screenOff = false;
+      /* Back to the ambient level; the backlight runs the fade */
+      if (!panelAsleep) backlightSetStage(BL_STAGE_ACTIVE);
+  }
+}
+
+/* Display loop period histogram (UI jitter), UI_JITTER_BUCKET_US per bucket */
+#define UI_JITTER_BUCKET_US 500
+#define UI_JITTER_BUCKETS   64  /**< Last bucket collects everything above 31.5 ms */
+uint16_t loopPeriodHist[UI_JITTER_BUCKETS];
+uint32_t loopPeriodMaxUs = 0;
+uint32_t loopPeriodCount = 0;
+
+/** @brief Adds one display loop period to the histogram */
+void sampleLoopPeriod(uint32_t periodUs) {
+  uint32_t b = periodUs / UI_JITTER_BUCKET_US;
+  if (b >= UI_JITTER_BUCKETS) b = UI_JITTER_BUCKETS - 1;
+  if (loopPeriodHist[b] < 0xFFFF) loopPeriodHist[b]++;
+  if (periodUs > loopPeriodMaxUs) loopPeriodMaxUs = periodUs;
+  loopPeriodCount++;
+}
+
+/** @brief Upper bound of the bucket holding the pct percentile */
+static uint32_t loopPeriodPercentile(uint8_t pct) {
+  const uint32_t rank = (loopPeriodCount * pct + 99) / 100;
+  uint32_t seen = 0;
+  for (int b = 0; b < UI_JITTER_BUCKETS; b++) {
+      seen += loopPeriodHist[b];
+      if (seen >= rank) return (b + 1) * UI_JITTER_BUCKET_US;
+  }
+  return loopPeriodMaxUs;
+}
+
+/**
+ * @brief Prints the display loop period spread and CAN->UI drops, then restarts the window.
+ */
+void reportLoopJitter() {
+  if (loopPeriodCount == 0) return;
+  Serial.printf("CYD: UI loop period p50 <%lu us, p99 <%lu us, max %lu us (%lu passes), node events dropped %lu\n",
+                (unsigned long)loopPeriodPercentile(50), (unsigned long)loopPeriodPercentile(99),
+                (unsigned long)loopPeriodMaxUs, (unsigned long)loopPeriodCount,
+                (unsigned long)diagCounters.total(DIAG_NODE_EVENT_DROP));
+  memset(loopPeriodHist, 0, sizeof(loopPeriodHist));
+  loopPeriodMaxUs = 0;
+  loopPeriodCount = 0;
+}
+
+/**
+ * @brief Leaves the idle state: wakes the panel, repaints what changed, restores the backlight.
+ * @details The touches that caused the wake are discarded so a blind tap never fires a button.
+ */
+void wakeFromIdle() {
+  if (xSemaphoreTake(spiSemaphore, portMAX_DELAY) == pdTRUE) {
+      panelWake();
+      serviceScreen(millis()); /* GRAM survived: repaint only what the policies flag */
+      xSemaphoreGive(spiSemaphore);
+  }
+  xQueueReset(touchQueue);
+  traceRecalibrate(); /* the cycle counter ran slower while the CPU was scaled down */
+
+  screenOff = false;
+  screenDim = false;
+  tsLastTouch = millis();
+  backlightSetStage(BL_STAGE_ACTIVE);
+
+  if (wakeRequestUs != 0) {
+      lastWakeLatencyUs = micros() - wakeRequestUs;
+      wakeRequestUs = 0;
+      Serial.printf("CYD: Panel awake, wake latency %lu us\n", (unsigned long)lastWakeLatencyUs);
   }
 }
 
@@ -592,13 +2395,13 @@ void cydScreenDimmer() {
 
   if (!screenOff) {
     if (currentTime - tsLastTouch > SCREEN_OFF_MS) { 
-        /* Turn screen to minimum brightness */
-        handleHardwareBlink(CYD_BACKLIGHT_IDX, CYD_BACKLIGHT, CYD_BACKLIGHT_PWM_HZ, LEDC_13BIT_10PCT);
+        /* Fade the backlight out; the display task puts the panel to sleep after the fade */
+        backlightSetStage(BL_STAGE_OFF);
         screenOff = true;
-        Serial.println("CYD: Screen to min. brightness.");
+        Serial.println("CYD: Screen off.");
     } else if ((currentTime - tsLastTouch > SCREEN_DIM_MS) && !screenDim) {
-        /* Dim to 50% */
-        handleHardwareBlink(CYD_BACKLIGHT_IDX, CYD_BACKLIGHT, CYD_BACKLIGHT_PWM_HZ, LEDC_13BIT_50PCT); 
+        /* Dim to BL_DIM_PERMILLE of ambient */
+        backlightSetStage(BL_STAGE_DIM);
         screenDim = true;
         Serial.println("CYD: Screen dimmed.");
     }
@@ -609,45 +2412,80 @@ void cydScreenDimmer() {
 /** Task 2: Update Display */
 void TaskUpdateDisplay(void * pvParameters) {
   TouchData receivedTouch;
-  char receivedTime[10];
   uint32_t lastPressTime = 0; 
   const uint32_t debounceDelay = 750;  /**< Milliseconds to wait between valid presses */
-  
-  /* flags to keep track of what has been drawn */
-  static bool buttons_drawn = false;
-  static bool ip_drawn = false;
-  static bool footer_drawn = false;
-
-  static uint32_t lastCANCheck = 0;    /**< Tracks the last time we checked the bus */
-  static bool lastCANState = false;    /**< Tracks the previous state to detect changes */  
-  static bool ui_initialized = false;  /**< Flag to track if the UI has been initialized */
-  static int32_t lastRSSI = 0;         /**< WiFi RSSI value for signal strength indicator */
-
-  /* Variables for local time polling */
-  static uint32_t lastTimeUpdate = 0;
-  struct tm timeinfo;
-  char timeString[10];
+
+  static uint32_t lastTimeUpdate = 0;  /**< Start of the current one-second loop */
 
   Serial.println("CYD: Display Task Started");
 //   digitalWrite(LED_BLUE, LOW); /* Turn on the blue LED */
 
+  /* STAGE 1: Panel init and splash */
+  xSemaphoreTake(spiSemaphore, portMAX_DELAY);
+  tft.begin(); /* initialize the display */
+  tft.setRotation(1);
+  bootMark(BOOT_PANEL_READY);
+
+  drawBootSplash();
+  backlightBegin(); /* panel content is valid, light it at the ambient level */
+  bootMark(BOOT_SPLASH_SHOWN);
+  xSemaphoreGive(spiSemaphore);
+
+  /* STAGE 2: Keypad as soon as touch and the node table are ready */
+  EventBits_t ready = xEventGroupWaitBits(bootEvents, BOOT_BIT_TOUCH | BOOT_BIT_REGISTRY, pdFALSE, pdTRUE,
+                                          pdMS_TO_TICKS(BOOT_WAIT_MS));
+  if (!(ready & BOOT_BIT_REGISTRY)) {
+      /* initCYD() is still restoring the node table and layout: neither may be read yet */
+      Serial.printf("CYD Warning: registry not ready after %d ms, waiting\n", BOOT_WAIT_MS);
+      ready = xEventGroupWaitBits(bootEvents, BOOT_BIT_REGISTRY, pdFALSE, pdTRUE, portMAX_DELAY);
+  }
+  screenNav.reset(MODE_HOME);
+  if (xSemaphoreTake(spiSemaphore, portMAX_DELAY) == pdTRUE) {
+      refreshCurrentScreen();
+      xSemaphoreGive(spiSemaphore);
+  }
+  if (!(ready & BOOT_BIT_TOUCH)) {
+      /* The keypad is up; it is only interactive once the controller is */
+      Serial.printf("CYD Warning: touch not ready after %d ms, waiting\n", BOOT_WAIT_MS);
+      xEventGroupWaitBits(bootEvents, BOOT_BIT_TOUCH, pdFALSE, pdTRUE, portMAX_DELAY);
+  }
+  bootMark(BOOT_INTERACTIVE);
+  reportBootProfile();
+
+  uint32_t lastLoopUs = micros();
+  static uint32_t lastJitterReport = 0;
+
   for(;;) {
     uint32_t currentMillis = millis();
 
-    /* STATE 1: Waiting for CAN Introduction Acknowledgement */
-    if (!ui_initialized) {
-        if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
-            drawKeypad();
-            /* Draw footer immediately upon entry to main UI */
-            if (wifi_connected) drawFooter();
-            ui_initialized = true;
-            xSemaphoreGive(spiSemaphore);
+    /* Loop period spread; passes that blocked in idle are not counted */
+    uint32_t loopUs = micros();
+    if (!panelAsleep) sampleLoopPeriod(loopUs - lastLoopUs);
+    lastLoopUs = loopUs;
+
+    /* Cross-task input: node and switch state from the CAN task, contacts from the touch task */
+    drainNodeEvents();
+    drainStateEvents(currentMillis);
+    serviceTouchContact();
+    serviceClock(currentMillis);
+
+    /* Normal UI Operation */
+    if (!panelAsleep) backlightService(currentMillis); /* LDR sampling and fade targets */
+
+    /* Keypad layout download: timeouts, and installing a finished transfer */
+    serviceKeypadXfer(currentMillis);
+
+#if CYD_CAPTURE_CONSOLE
+    if (Serial.available()) {
+        switch (Serial.read()) {
+            case 's': captureScreen(Serial, false); break;
+            case 'm': captureScreen(Serial, true);  break;
+            case 'x': captureStop();                break;
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
-        continue; 
     }
+#endif
+    if (!panelAsleep) serviceCapture(currentMillis); /* screenshot rows, bounded per pass */
 
-    /* STATE 2: Normal UI Operation */
     /* 1000ms Refresh Loop */
     if (currentMillis - lastTimeUpdate >= 1000) { /* The one-second loop */
 
@@ -657,176 +2495,146 @@ void TaskUpdateDisplay(void * pvParameters) {
         /* Check if we need to dim the screen */
         cydScreenDimmer();
 
-        bool stateChanged = false;
-        for (int i = 0; i < 5; i++) {
+        /* Flush node table changes to flash (debounced) */
+        persistNodeTable(currentMillis);
+
+        /* Age the per-node activity counters used by the busiest-first sort */
+        static uint32_t lastActivityDecay = 0;
+        if (currentMillis - lastActivityDecay >= NODE_ACTIVITY_DECAY_MS) {
+            lastActivityDecay = currentMillis;
+            for (int i = 0; i < MAX_ARGB_NODES; i++) discoveredNodes[i].activity >>= 1;
+        }
+
+        if (currentMillis - lastJitterReport >= UI_JITTER_REPORT_MS) {
+            lastJitterReport = currentMillis;
+            reportLoopJitter();
+        }
+
+        /* Task, queue and lock health history for the diagnostics page */
+        diagSample();
+        static uint32_t lastDiagReport = 0;
+        if (currentMillis - lastDiagReport >= DIAG_REPORT_MS) {
+            lastDiagReport = currentMillis;
+            diagReport();
+        }
+
+        static int lastNodeCount = 0;
+        if (discoveredNodeCount != lastNodeCount) {
+            lastNodeCount = discoveredNodeCount;
+            uiEvents |= UI_EVT_NODES;
+        }
+
+        static bool lastWifi = false;
+        if (wifi_connected != lastWifi) {
+            lastWifi = wifi_connected;
+            uiEvents |= UI_EVT_NETWORK;
+            if (wifi_connected) cydClock.startSync(currentMillis); /* SNTP runs once the network is up */
+            else cydClock.stopSync();
+        }
+
+        /* System time as it stands; unlike getLocalTime() this never waits for SNTP */
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        if (cydClock.poll(currentMillis, (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000)) {
+            Serial.printf("CYD: Clock %s\n", cydClock.synced() ? "synced" : "not synced, giving up for now");
+        }
+
+        for (int i = 0; i < MAX_ARGB_NODES; i++) {
             if (discoveredNodes[i].id != 0) {
                 /** * If node was active but hasn't been seen for > 30s, 
                  * mark as inactive and trigger a UI refresh.
                  */
                 if (discoveredNodes[i].active && (currentMillis - discoveredNodes[i].lastSeen > 30000)) {
                     discoveredNodes[i].active = false;
-                    stateChanged = true;
+                    nodeList.markSlotDirty(i);
+                    uiEvents |= UI_EVT_NODES;
                     Serial.printf("Node 0x%08X timed out.\n", discoveredNodes[i].id);
                 }
             }
         }
+    } /* End 1000ms refresh loop */
 
-        if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(50)) == pdTRUE) {
-            /* Refresh current screen if a node dropped or if in System Info */
-            if ((currentMode == MODE_SYSTEM_INFO) || (stateChanged && currentMode == MODE_NODE_SEL)) {
-                refreshCurrentScreen();
-            }
+    /* Enter idle once the backlight fade-out has finished; a fade-out queued
+     * behind a running fade takes longer than BL_FADE_MS */
+    if (screenOff && !panelAsleep && backlightFadeDone(currentMillis)) {
+        if (takeCounted(spiSemaphore, pdMS_TO_TICKS(50), DIAG_SPI_TIMEOUT)) {
+            panelSleep();
             xSemaphoreGive(spiSemaphore);
+            Serial.println("CYD: Panel asleep, rendering suspended.");
         }
+    }
 
+    /* Idle: block on the touch queue. The cap keeps the node queue drained before
+     * a large fleet's heartbeats overflow it, and node timeouts ticking.
+     * Events keep accumulating in uiEvents and are applied on wake. */
+    if (panelAsleep) {
+        if (xQueueReceive(touchQueue, &receivedTouch, pdMS_TO_TICKS(NODE_EVENT_IDLE_DRAIN_MS)) || !screenOff) {
+            serviceTouchContact(); /* picks up the wake timestamp */
+            wakeFromIdle();
+            lastLoopUs = micros();
+        }
+        continue;
+    }
 
-    } /* End 1000ms refresh loop */
+    /* Run the current screen's refresh policy; skipped entirely when there is no work */
+    const ScreenDef* screen = screenNav.current();
+    if (screen != NULL && screenWorkFor(*screen, uiEvents, currentMillis, screenLastTick) != SCREEN_WORK_NONE) {
+        if (takeCounted(spiSemaphore, pdMS_TO_TICKS(50), DIAG_SPI_TIMEOUT)) {
+            serviceScreen(currentMillis);
+            xSemaphoreGive(spiSemaphore);
+        }
+    }
     
     /* Check for Touch Data */
     if (xQueueReceive(touchQueue, &receivedTouch, 0)) {
         uint32_t currentTime = millis();
+        TRACE_MARK(receivedTouch.traceId, TRACE_DEQUEUED);
         
         if (currentTime - lastPressTime > debounceDelay) {
             lastPressTime = currentTime; // Move debounce lock to the start
             tsLastTouch = currentTime; /* Keep track of last touch for screen dimming */
 
+            TRACE_MARK(receivedTouch.traceId, TRACE_DISPATCH);
+            dispatchTraceId = receivedTouch.traceId; /* picked up by sendUiMessage() */
+#if CYD_TRACE
+            static uint8_t tracedSinceReport = 0;
+            if (receivedTouch.traceId != 0 && ++tracedSinceReport >= TRACE_REPORT_EVERY) {
+                tracedSinceReport = 0;
+                traceReport();
+            }
+#endif
+
             /**
              * @section Header Processing
              * Handle global navigation (Mode switching, Node cycling, Hamburger)
              */
             if (receivedTouch.y < 45) {
-                bool handled = false;
-
                 /* Left Target: Mode Toggle (x=0 to 80) */
                 if (receivedTouch.x < 80) {
-                    currentMode = (currentMode == MODE_HOME) ? MODE_COLOR_PICKER : MODE_HOME;
-                    handled = true;
+                    navReset((currentMode == MODE_HOME) ? MODE_COLOR_PICKER : MODE_HOME);
                 } 
-                /* Right Target: Hamburger Menu (x=240 to 320) */
+                /* Right Target: Hamburger Menu (x=240 to 320), tapping it again closes the menu */
                 else if (receivedTouch.x > 240) {
-                    currentMode = MODE_HAMBURGER_MENU;
-                    handled = true;
+                    if (currentMode == MODE_HAMBURGER_MENU) navBack();
+                    else navPush(MODE_HAMBURGER_MENU);
                 }
-                /* Center Target: Cycle Nodes (x=80 to 240) */
-                else if (receivedTouch.x >= 80 && receivedTouch.x <= 240) {
-                    selectedNodeIdx = (selectedNodeIdx + 1) % 5;
-                    if(discoveredNodes[selectedNodeIdx].id == 0) selectedNodeIdx = 0;
-                    handled = true;
-                }
-
-                if (handled) {
-                    if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        refreshCurrentScreen(); // Uses the helper function below
-                        xSemaphoreGive(spiSemaphore);
-                    }
-                    continue;
+                /* Center Target: Cycle Nodes (x=80 to 240), in node list order */
+                else {
+                    refreshNodeList();
+                    selectNode(nodeList.slotAfter(selectedNodeIdx));
                 }
+                dispatchTraceId = 0;
+                continue;
             }
 
             /**
              * @section Content Processing
-             * Use switch-case for mode-specific screen interactions
+             * Delegated to the current screen's onTouch hook
              */
-            switch (currentMode) {
-                case MODE_HOME: {
-                    for (int i = 0; i < 4; i++) {
-                        if (receivedTouch.x >= buttons[i].x && receivedTouch.x <= (buttons[i].x + buttons[i].w) &&
-                            receivedTouch.y >= buttons[i].y && receivedTouch.y <= (buttons[i].y + buttons[i].h)) {
-                            
-                            /* Visual Feedback */
-                            if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
-                                tft.drawRoundRect(buttons[i].x, buttons[i].y, buttons[i].w, buttons[i].h, 8, TFT_RED);
-                                xSemaphoreGive(spiSemaphore);
-                            }
-
-                            uint8_t canData[5];
-                            memcpy(canData, (void*)myNodeID, 4);
-                            canData[4] = (uint8_t)buttons[i].canID;
-                            send_message(SW_MOM_PRESS_ID, canData, SW_MOM_PRESS_DLC);
-
-                            vTaskDelay(pdMS_TO_TICKS(150)); 
-
-                            if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
-                                tft.drawRoundRect(buttons[i].x, buttons[i].y, buttons[i].w, buttons[i].h, 8, TFT_WHITE);
-                                xSemaphoreGive(spiSemaphore);
-                            }
-                        }
-                    }
-                    break;
-                }
-
-                case MODE_COLOR_PICKER: {
-                    /* Ensure touch is within the palette grid area */
-                    if (receivedTouch.y >= 45 && receivedTouch.y < 225) {
-                        int col = receivedTouch.x / 40;
-                        int row = (receivedTouch.y - 45) / 45;
-                        
-                        /* Clamp values to grid bounds */
-                        if (col > 7) col = 7;
-                        if (row > 3) row = 3;
-
-                        int colorIdx = (row * 8) + col;
-
-                        if (colorIdx >= 0 && colorIdx < 32) {
-                            /* Update local state */
-                            discoveredNodes[selectedNodeIdx].lastColorIdx = colorIdx;
-
-                            /* Construct and send CAN message */
-                            uint32_t targetID = discoveredNodes[selectedNodeIdx].id;
-                            uint8_t canData[6];
-                            canData[0] = (targetID >> 24) & 0xFF;
-                            canData[1] = (targetID >> 16) & 0xFF;
-                            canData[2] = (targetID >> 8) & 0xFF;
-                            canData[3] = targetID & 0xFF;
-                            canData[4] = 0; // LED Strip/Index
-                            canData[5] = (uint8_t)colorIdx;
-
-                            send_message(SET_ARGB_STRIP_COLOR_ID, canData, SET_ARGB_STRIP_COLOR_DLC);
-
-                            /* Trigger immediate redraw for the selection highlight */
-                            if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
-                                drawColorPicker(); 
-                                xSemaphoreGive(spiSemaphore);
-                            }
-                        }
-                    }
-                    break;
-                }
-
-                case MODE_NODE_SEL: {
-                    int clickedIdx = (receivedTouch.y - 45) / 38;
-                    if (clickedIdx >= 0 && clickedIdx < 5 && discoveredNodes[clickedIdx].id != 0) {
-                        selectedNodeIdx = clickedIdx;
-                        if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(50)) == pdTRUE) {
-                            drawNodeSelector();
-                            xSemaphoreGive(spiSemaphore);
-                        }
-                    }
-                    break;
-                }
-
-            case MODE_HAMBURGER_MENU: {
-                for (int i = 0; i < 4; i++) {
-                    if (receivedTouch.x >= buttons[i].x && receivedTouch.x <= (buttons[i].x + buttons[i].w) &&
-                        receivedTouch.y >= buttons[i].y && receivedTouch.y <= (buttons[i].y + buttons[i].h)) {
-                        
-                        currentMode = (DisplayMode)i; // 0=Home, 1=Picker, 2=Nodes, 3=System
-                        
-                        if (xSemaphoreTake(spiSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
-                            refreshCurrentScreen();
-                            xSemaphoreGive(spiSemaphore);
-                        }
-                        break;
-                    }
-                }
-                break;
-            }
-
-            case MODE_SYSTEM_INFO: {
-                /* Optional: Add a button here to reset CAN counters or Reconnect WiFi */
-                break;
+            if (screen != NULL && screen->onTouch != NULL) {
+                screen->onTouch(receivedTouch.x, receivedTouch.y);
             }
-            } /* end switch(currentMode) */
+            dispatchTraceId = 0;
         } /* end debounce */
     } /* end queue receive */
 
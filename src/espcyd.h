@@ -18,6 +18,9 @@
 #include "colorpalette.h"
 #endif
 
+#include "candispatch.h" /**< CanFrameHandler for cydCanRegister() */
+#include "clocksvc.h"   /**< ClockService for cydClock */
+
 /*  Install the "TFT_eSPI" library by Bodmer to interface with the TFT Display - https://github.com/Bodmer/TFT_eSPI
     *** IMPORTANT: User_Setup.h available on the internet will probably NOT work with the examples available at Random Nerd Tutorials ***
     *** YOU MUST USE THE User_Setup.h FILE PROVIDED IN THE LINK BELOW IN ORDER TO USE THE EXAMPLES FROM RANDOM NERD TUTORIALS ***
@@ -54,8 +57,19 @@
 #define CYD_LDR           34
 #define CYD_SPEAKER       26
 
-/** Mamiumum number of ARGB nodes for the color picker */
-#define MAX_ARGB_NODES    8
+/** Maximum number of ARGB nodes in the node table (slots are uint8_t, see nodelist.h) */
+#ifndef MAX_ARGB_NODES
+#define MAX_ARGB_NODES    200
+#endif
+#if MAX_ARGB_NODES > 254
+#error "MAX_ARGB_NODES must be 254 or less"
+#endif
+
+/** Node selector list (see nodelist.h): rows below the header, toolbar underneath */
+#define NODE_LIST_TOP          44
+#define NODE_LIST_ROW_H        24
+#define NODE_LIST_ROWS         7    /**< 7 x 24 px, the toolbar starts at y = 212 */
+#define NODE_ACTIVITY_DECAY_MS 60000 /**< Per-node frame counters are halved this often */
 
 /** Submodule index for backlight */
 #define CYD_BACKLIGHT_IDX 1 
@@ -63,9 +77,134 @@
 /** PWM frequency for backlight pwm in Hz */
 #define CYD_BACKLIGHT_PWM_HZ  1000
 
+/** Adaptive backlight (see backlight.h). The LEDC channel is owned by espcyd. */
+#ifndef CYD_BL_LEDC_CHANNEL
+#define CYD_BL_LEDC_CHANNEL   7    /**< LEDC low-speed channel driving CYD_BACKLIGHT */
+#endif
+#ifndef CYD_BL_LEDC_TIMER
+#define CYD_BL_LEDC_TIMER     3    /**< LEDC low-speed timer for the backlight */
+#endif
+#ifndef CYD_LDR_DARK_HIGH
+#define CYD_LDR_DARK_HIGH     1    /**< LDR reads higher in the dark on the CYD */
+#endif
+#define BL_SAMPLE_MS          100  /**< LDR burst interval */
+#define BL_OVERSAMPLE         16   /**< ADC reads averaged per burst */
+#define BL_FILTER_SHIFT       3    /**< IIR weight 1/8 per burst, ~0.8 s time constant */
+#define BL_HYSTERESIS         80   /**< Ambient counts before the duty follows */
+#define BL_FADE_MS            800  /**< Ramp time for ambient and dimming changes */
+#define BL_WAKE_FADE_MS       120  /**< Ramp time when a touch wakes the screen */
+#define BL_DIM_PERMILLE       500  /**< Dim stage multiplier */
+#define BL_OFF_PERMILLE       0    /**< Off stage multiplier (panel sleeps after the fade) */
+#define BL_MIN_DUTY           20   /**< Lowest non-zero duty, permille */
+
 #define SCREEN_DIM_MS 10000 /**< 10 seconds screen dims */
 #define SCREEN_OFF_MS 60000 /**< 1 minute screen off */
 
+/** Task placement: radio, TWAI and the CAN tasks in main.cpp stay on core 0, the UI
+ *  gets core 1 to itself (apart from the Arduino loop). Override per project. */
+#ifndef CYD_UI_CORE
+#define CYD_UI_CORE        1    /**< Core for TouchTask and DisplayTask */
+#endif
+#ifndef CYD_CAN_CORE
+#define CYD_CAN_CORE       0    /**< Suggested core for the CAN tasks in main.cpp */
+#endif
+#ifndef CYD_TOUCH_PRIO
+#define CYD_TOUCH_PRIO     2    /**< Above the display so touches are sampled on time */
+#endif
+#ifndef CYD_DISPLAY_PRIO
+#define CYD_DISPLAY_PRIO   1
+#endif
+#define CYD_TOUCH_STACK    4096
+#define CYD_DISPLAY_STACK  6144
+#define NODE_EVENT_QUEUE_LEN 64 /**< CAN -> UI node events in flight, power of two */
+/** Idle wake-up to drain the CAN -> UI queues: 64 events fill in 320 ms with 200 nodes at 1 Hz */
+#define NODE_EVENT_IDLE_DRAIN_MS 100
+#define UI_JITTER_REPORT_MS  10000 /**< Display loop period statistics interval */
+#define TOUCH_QUEUE_LEN      5     /**< Touch task -> display task */
+#define IMG_BLIT_PIXELS      256   /**< Decoded asset pixels per pushPixels() call */
+
+/** Wall clock (see clocksvc.h); the project starts SNTP with configTime() */
+#define CLOCK_SYNC_TIMEOUT_MS 30000 /**< Syncing gives up this long after the network came up */
+#define CLOCK_REBASE_MS       60000 /**< Re-read the system time this often once synced */
+#ifndef CYD_HEADER_CLOCK
+#define CYD_HEADER_CLOCK      0     /**< 1 = small clock in the header of every screen */
+#endif
+
+/** Task/queue health (see rtosdiag.h), sampled once a second */
+#ifndef DIAG_REPORT_MS
+#define DIAG_REPORT_MS       60000 /**< Serial health report interval */
+#endif
+#define DIAG_STACK_WARN      512   /**< Free stack (bytes) drawn in red */
+#define DIAG_SCREEN_TASKS    11    /**< Task rows on the diagnostics page */
+
+/** Colour picker swatch height; the four rows end at 45 + 4 * 41 = 209, above the effects button */
+#define PICKER_SWATCH_H 41
+
+/** Effects screen layout */
+#define FX_EFFECT_Y     48  /**< Two rows of effect buttons */
+#define FX_SPEED_Y      110
+#define FX_PALETTE_Y    136 /**< 32 swatches, 10 px each */
+#define FX_SLOT_Y       156 /**< Colour A, colour B, SEND */
+#define FX_PREVIEW_Y    184
+#define FX_PREVIEW_H    20
+#define FX_PREVIEW_LEDS 16
+#define FX_PREVIEW_MS   40  /**< Preview frame interval */
+#define FX_STRIP_Y      208
+#define FX_STRIP_X      64
+
+/** System info <-> diagnostics page button */
+#define PAGE_BTN_X 250
+#define PAGE_BTN_Y 212
+#define PAGE_BTN_W 66
+#define PAGE_BTN_H 24
+
+/** Boot-to-interactive budget; a warning is logged when startup exceeds it */
+#ifndef CYD_BOOT_TARGET_MS
+#define CYD_BOOT_TARGET_MS 1000
+#endif
+
+/** Node table persistence (see nodestore.h) */
+#define NODE_STORE_NVS_NS          "cydnodes" /**< NVS namespace for the node table */
+#define NODE_STORE_DEBOUNCE_MS     5000       /**< Table must be quiet this long before a write */
+#define NODE_STORE_MIN_INTERVAL_MS 60000      /**< Minimum spacing between flash writes */
+
+/** Keypad layout download (see keypadxfer.h); IDs can be overridden by the project */
+#ifndef KEYPAD_XFER_ID
+#define KEYPAD_XFER_ID      0x6A0 /**< Layout data frames, sender -> CYD */
+#endif
+#ifndef KEYPAD_XFER_FC_ID
+#define KEYPAD_XFER_FC_ID   0x6A1 /**< Flow control frames, CYD -> sender */
+#endif
+#define KEYPAD_XFER_BLOCK       8   /**< DATA frames per clear-to-send */
+#define KEYPAD_XFER_TIMEOUT_MS  250 /**< Silence before flow control is repeated */
+#define KEYPAD_XFER_RETRIES     8   /**< Repeats before a transfer is abandoned */
+
+/** Switch state shown on stateful keypad buttons (see statemodel.h) */
+#ifndef KEYPAD_STATUS_ID
+#define KEYPAD_STATUS_ID      0x6A2 /**< Status frames, nodes -> CYD */
+#endif
+#define STATE_EVENT_QUEUE_LEN 32    /**< Changed states in flight to the display task, power of two */
+#define STATE_PENDING_MS      1500  /**< A press shows as pending this long without a status change */
+
+/** Parametric strip effects, rendered on the nodes */
+#ifndef ARGB_EFFECT_ID
+#define ARGB_EFFECT_ID        0x6A3 /**< Effect commands, CYD -> nodes (see argbeffects.h) */
+#endif
+
+/** Node frames the UI can decode itself when the project defines their IDs:
+ *  CYD_NODE_HEARTBEAT_ID  [0..3] node ID, big endian
+ *  CYD_NODE_STRIPS_ID     [0..3] node ID, big endian, [4] strip count
+ *  Without them main.cpp keeps calling registerARGBNode()/setARGBNodeStripCount(). */
+
+/** Remote screenshots (see fbcapture.h); TFT_eSPI needs TFT_MISO for readRect() */
+#define CAPTURE_ROWS_PER_STEP   4    /**< Panel rows read per display loop pass */
+#define CAPTURE_INTERVAL_MS     500  /**< Gap between frames when mirroring */
+#define CAPTURE_KEYFRAME_EVERY  10   /**< Mirrored frames per forced keyframe */
+#define CAPTURE_CHUNK_BUDGET    512  /**< Bytes per pass for outputs that never report availableForWrite() */
+#ifndef CYD_CAPTURE_CONSOLE
+#define CYD_CAPTURE_CONSOLE     0    /**< 1: 's' = screenshot, 'm' = mirror, 'x' = stop on Serial */
+#endif
+
 
 
 /* Externalized variables for use in main logic if needed */
@@ -85,7 +224,45 @@ const int centerY = SCREEN_HEIGHT / 2;
 
 /* Modular initialization function */
 void initCYD();
-// void registerARGBNode(uint32_t id);
+/* Node updates from the CAN receive task. Both are queued to the display task,
+ * which owns discoveredNodes; call them from one task only. */
+void registerARGBNode(uint32_t id);
+void setARGBNodeStripCount(uint32_t id, uint8_t stripCount);
+
+/**
+ * @brief Hands a received frame to the UI handler registered for its ID, zero-copy.
+ * @details Call from the CAN receive task for every frame; a table lookup, no search.
+ * @return false if the UI has no handler for id (left to the caller's own decoding).
+ */
+bool cydCanDispatch(uint16_t id, const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief Adds a UI handler for IDs first..last. Call before frames are dispatched.
+ * @return false on overlap with an existing registration or a full table.
+ */
+bool cydCanRegister(uint16_t first, uint16_t last, CanFrameHandler fn, void* ctx);
+
+/**
+ * @brief Feeds a frame received on KEYPAD_XFER_ID to the layout receiver.
+ * @details Called from the CAN receive path; flow control is answered immediately.
+ */
+void handleKeypadXferFrame(const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief Feeds a frame received on KEYPAD_STATUS_ID to the keypad state model.
+ * @details Called from the CAN receive task; repeats are dropped without leaving it.
+ */
+void handleStatusFrame(const uint8_t* data, uint8_t dlc);
+
+/**
+ * @brief Streams the screen to out (see tools/fbcapture.py); safe from any task.
+ * @details Outputs that report availableForWrite() (HardwareSerial) never block the
+ *          display task. Others (WiFiClient keeps Print's 0) get CAPTURE_CHUNK_BUDGET
+ *          bytes per pass, and their write() may block for that long.
+ * @param continuous false for one frame, true to mirror until captureStop()
+ */
+void captureScreen(Print& out, bool continuous);
+void captureStop();
 
 
 /**
@@ -99,6 +276,7 @@ struct TouchData {
   int x;
   int y;
   int z;
+  uint16_t traceId; /**< Latency trace of this touch, 0 if untraced (see touchtrace.h) */
 };
 
 struct KeypadButton {
@@ -125,9 +303,11 @@ enum DisplayMode { MODE_HOME = 0 ,
                    MODE_COLOR_PICKER = 1, 
                    MODE_NODE_SEL = 2, 
                    MODE_SYSTEM_INFO = 3, 
-                   MODE_HAMBURGER_MENU = 4
+                   MODE_HAMBURGER_MENU = 4,
+                   MODE_DIAGNOSTICS = 5,
+                   MODE_EFFECTS = 6
                 };
-extern DisplayMode currentMode;
+extern DisplayMode currentMode; /**< Display task only */
 
 /**
  * @struct ARGBNode
@@ -137,11 +317,17 @@ struct ARGBNode {
     uint32_t id;       /**< 32-bit Node ID */
     uint32_t lastSeen; /**< Heartbeat timestamp */
     int lastColorIdx;  /**< Last color index sent to this node */
+    uint8_t stripCount; /**< Number of ARGB strips on the node */
     bool active;       /**< Status flag */
+    bool confirmed;    /**< False for nodes restored from flash until a heartbeat arrives */
+    uint16_t activity; /**< Frames received from the node, decaying (list sort key) */
 };
 
-extern volatile int   discoveredNodeCount; /**< Track active count in the array */
-extern volatile int   selectedNodeIdx;
+extern int   discoveredNodeCount; /**< Track active count in the array (display task only) */
+extern int   selectedNodeIdx;     /**< Display task only */
 extern ARGBNode discoveredNodes[MAX_ARGB_NODES]; /**< Size must be explicit here */
+extern uint32_t nodeTableReadyMs;  /**< millis() when the node list became usable */
+extern ClockService cydClock;      /**< Wall clock; cydClock.state() is safe from any task */
+extern uint32_t firstHeartbeatMs;  /**< millis() of the first heartbeat after boot */
 
 #endif  /* End ESPCYD_H_ */
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include <string.h>
+#include "fbcapture.h"
+#include "crc16.h"
+
+/* fbcapture.cpp */
+
+FrameCapture::FrameCapture(uint16_t width, uint16_t height, uint8_t flags)
+    : _w(width > FBC_MAX_WIDTH ? FBC_MAX_WIDTH : width),
+      _h(height > FBC_MAX_HEIGHT ? FBC_MAX_HEIGHT : height),
+      _flags((uint8_t)(flags & ~FBC_FLAG_KEYFRAME)),
+      _active(false), _key(false), _ended(false), _haveBase(false),
+      _y(0), _seq(0), _skip(0), _frameCrc(0xFFFF), _coded(0), _skipped(0),
+      _lastCoded(0), _lastSkipped(0), _lastRows(0),
+      _row(_rowA), _prev(_rowB), _outLen(0) {}
+
+bool FrameCapture::begin(bool keyframe) {
+    if (_active) return false;
+
+    _key = keyframe || !_haveBase;
+    _active = true;
+    _ended = false;
+    _y = 0;
+    _skip = 0;
+    _frameCrc = 0xFFFF;
+    _coded = 0;
+    _skipped = 0;
+    _seq++;
+
+    const uint8_t flags = (uint8_t)(_flags | (_key ? FBC_FLAG_KEYFRAME : 0));
+    put8((uint8_t)(FBC_MAGIC & 0xFF));
+    put8((uint8_t)((FBC_MAGIC >> 8) & 0xFF));
+    put8((uint8_t)((FBC_MAGIC >> 16) & 0xFF));
+    put8((uint8_t)((FBC_MAGIC >> 24) & 0xFF));
+    put8(FBC_VERSION);
+    put8(flags);
+    put16(_w);
+    put16(_h);
+    put16(_seq);
+    return true;
+}
+
+void FrameCapture::flushSkip() {
+    if (_skip == 0) return;
+    put8(FBC_OP_SKIP);
+    put8(_skip);
+    _skip = 0;
+}
+
+void FrameCapture::encodeRow(const uint16_t* row) {
+    put8(FBC_OP_DATA);
+
+    int i = 0;
+    size_t litPos = 0; /* position of the open literal token */
+    int litLen = 0;
+    while (i < _w) {
+        int run = 1;
+        while (i + run < _w && run < 128 && row[i + run] == row[i]) run++;
+
+        if (run >= 2) {
+            litLen = 0; /* close any open literal */
+            put8((uint8_t)(0x80 | (run - 1)));
+            put16(row[i]);
+            i += run;
+        } else {
+            if (litLen == 0 || litLen == 128) {
+                litPos = _outLen;
+                put8(0);
+                litLen = 0;
+            }
+            put16(row[i]);
+            _out[litPos] = (uint8_t)litLen; /* count - 1 */
+            litLen++;
+            i++;
+        }
+    }
+}
+
+void FrameCapture::flush(FbcSink& sink) {
+    size_t sent = 0;
+    while (sent < _outLen) {
+        size_t room = sink.room();
+        if (room < FBC_CHUNK_OVERHEAD + FBC_CHUNK_MIN &&
+            room < FBC_CHUNK_OVERHEAD + (_outLen - sent)) break;
+
+        size_t n = _outLen - sent;
+        if (n > FBC_CHUNK_MAX) n = FBC_CHUNK_MAX;
+        if (n > room - FBC_CHUNK_OVERHEAD) n = room - FBC_CHUNK_OVERHEAD;
+
+        /* One write per chunk, so log lines from other tasks fall between chunks */
+        uint8_t chunk[FBC_CHUNK_MAX + FBC_CHUNK_OVERHEAD];
+        const uint16_t crc = crc16Ccitt(_out + sent, n);
+        chunk[0] = FBC_SYNC0;
+        chunk[1] = FBC_SYNC1;
+        chunk[2] = (uint8_t)(n & 0xFF);
+        chunk[3] = (uint8_t)(n >> 8);
+        memcpy(chunk + 4, _out + sent, n);
+        chunk[4 + n] = (uint8_t)(crc & 0xFF);
+        chunk[5 + n] = (uint8_t)(crc >> 8);
+        sink.write(chunk, n + FBC_CHUNK_OVERHEAD);
+
+        sent += n;
+        _coded += n;
+    }
+    if (sent > 0) {
+        memmove(_out, _out + sent, _outLen - sent);
+        _outLen -= sent;
+    }
+}
+
+bool FrameCapture::step(FbcPixelSource& src, FbcSink& sink, uint8_t maxRows) {
+    if (!_active) return false;
+
+    _lastRows = 0;
+    while (_lastRows < maxRows && _y < _h && _outLen + FBC_ROW_WORST + 2 <= sizeof(_out)) {
+        src.readRow(_y, _row, _w);
+        const uint16_t crc = crc16Ccitt((const uint8_t*)_row, (size_t)_w * 2);
+
+        if (!_key && crc == _rowCrc[_y]) {
+            if (++_skip == 255) flushSkip();
+            _skipped++;
+        } else {
+            flushSkip();
+            if (_y > 0 && memcmp(_row, _prev, (size_t)_w * 2) == 0) put8(FBC_OP_REPEAT);
+            else encodeRow(_row);
+        }
+
+        _rowCrc[_y] = crc;
+        uint8_t c[2] = { (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) };
+        _frameCrc = crc16Ccitt(c, 2, _frameCrc);
+
+        uint16_t* t = _prev; _prev = _row; _row = t;
+        _y++;
+        _lastRows++;
+    }
+
+    if (_y == _h && !_ended && _outLen + 4 <= sizeof(_out)) {
+        flushSkip();
+        put8(FBC_OP_END);
+        put16(_frameCrc);
+        _ended = true;
+    }
+
+    flush(sink);
+
+    if (_ended && _outLen == 0) {
+        _active = false;
+        _haveBase = true;
+        _lastCoded = _coded;
+        _lastSkipped = _skipped;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,150 @@
+#ifndef FBCAPTURE_H_
+#define FBCAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* fbcapture.h - remote screenshots: RGB565 run-length + row-delta codec.
+ *
+ * The encoder reads the screen a few rows at a time and never holds a
+ * previous frame. It keeps one CRC-16 per row instead, so a row that is
+ * unchanged since the last frame costs one bit of a SKIP run. Stream
+ * (integers little endian):
+ *
+ *   Frame header (12 bytes)
+ *     u32 magic FBC_MAGIC, u8 version, u8 flags (FBC_FLAG_*),
+ *     u16 width, u16 height, u16 sequence
+ *   Row ops, covering rows 0..height-1 in order
+ *     FBC_OP_SKIP   u8 n      n rows (1..255) unchanged since the previous frame
+ *     FBC_OP_REPEAT           row equals the row above it in this frame
+ *     FBC_OP_DATA   tokens    RLE pixels until the row is full:
+ *                               0x80|(n-1), u16 pixel      run of n (1..128)
+ *                               n-1, u16 pixel[n]           n literals (1..128)
+ *   FBC_OP_END    u16 crc     CRC-16 over the row CRCs (u16 each) of the frame
+ *
+ * On a byte stream shared with log text (Serial) the codec bytes travel in
+ * chunks: FBC_SYNC0 FBC_SYNC1, u16 length, payload, u16 CRC-16 of the
+ * payload. A reader drops anything that does not parse as a chunk.
+ *
+ * Everything here is plain C++ so the codec can be driven by a mock screen
+ * on a host; see tools/fbcapture.py for the decoder. */
+
+#define FBC_MAGIC        0x42465943UL /**< 'CYFB' */
+#define FBC_VERSION      1
+#define FBC_HEADER_LEN   12
+#define FBC_MAX_WIDTH    320
+#define FBC_MAX_HEIGHT   240
+
+#define FBC_FLAG_KEYFRAME (1 << 0) /**< No SKIP ops; decodable without a previous frame */
+#define FBC_FLAG_SWAPPED  (1 << 1) /**< Pixels are byte-swapped RGB565 */
+
+#define FBC_OP_SKIP      0x01
+#define FBC_OP_REPEAT    0x02
+#define FBC_OP_DATA      0x03
+#define FBC_OP_END       0xFF
+
+#define FBC_SYNC0        0xFB
+#define FBC_SYNC1        0xC5
+#define FBC_CHUNK_OVERHEAD 6   /**< sync(2) + length(2) + crc(2) */
+#define FBC_CHUNK_MAX    256   /**< Largest chunk payload */
+#define FBC_CHUNK_MIN    32    /**< Smaller sink room is waited out, not used */
+
+/** Worst-case encoding of one row: op + one literal token per 128 pixels */
+#define FBC_ROW_WORST    (1 + ((FBC_MAX_WIDTH + 127) / 128) + 2 * FBC_MAX_WIDTH)
+
+/**
+ * @class FbcPixelSource
+ * @brief Where rows come from: the panel (readRect) or a mock framebuffer.
+ */
+class FbcPixelSource {
+public:
+    virtual ~FbcPixelSource() {}
+    virtual void readRow(int y, uint16_t* out, int width) = 0;
+};
+
+/**
+ * @class FbcSink
+ * @brief Non-blocking byte sink.
+ */
+class FbcSink {
+public:
+    virtual ~FbcSink() {}
+    /** @brief Bytes that can be written right now without blocking. */
+    virtual size_t room() = 0;
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+};
+
+/**
+ * @class FrameCapture
+ * @brief Incremental frame encoder with bounded work per step().
+ */
+class FrameCapture {
+public:
+    FrameCapture(uint16_t width, uint16_t height, uint8_t flags = 0);
+
+    /**
+     * @brief Starts a frame.
+     * @param keyframe Send every row; forced for the first frame and after invalidate()
+     * @return false if a frame is still being sent
+     */
+    bool begin(bool keyframe);
+
+    /** @brief Forgets the row CRCs, e.g. after the host lost sync. */
+    void invalidate() { _haveBase = false; }
+
+    /** @brief Drops the frame in progress; the next frame is a keyframe. */
+    void abort() { _active = false; _outLen = 0; _haveBase = false; }
+
+    bool busy() const { return _active; }
+
+    /**
+     * @brief Encodes up to maxRows rows and flushes whatever the sink can take.
+     * @details Rows are only read while the output buffer can hold a worst-case
+     *          row, so a slow sink throttles the reads instead of blocking.
+     * @return true when the current frame has been completely written.
+     */
+    bool step(FbcPixelSource& src, FbcSink& sink, uint8_t maxRows);
+
+    /** @brief Rows read by the last step() (0 while waiting on the sink). */
+    uint8_t lastRows() const { return _lastRows; }
+
+    /** --- Statistics of the last completed frame --- */
+    uint32_t frameRawBytes() const  { return (uint32_t)_w * _h * 2; }
+    uint32_t frameCodedBytes() const { return _lastCoded; }
+    uint16_t frameRowsSkipped() const { return _lastSkipped; }
+    uint16_t sequence() const { return _seq; }
+
+private:
+    void put8(uint8_t v) { _out[_outLen++] = v; }
+    void put16(uint16_t v) { _out[_outLen++] = (uint8_t)(v & 0xFF); _out[_outLen++] = (uint8_t)(v >> 8); }
+    void flushSkip();
+    void encodeRow(const uint16_t* row);
+    void flush(FbcSink& sink);
+
+    uint16_t _w, _h;
+    uint8_t  _flags;
+    bool     _active;
+    bool     _key;
+    bool     _ended;
+    bool     _haveBase;     /**< _rowCrc holds the previous frame */
+    uint16_t _y;
+    uint16_t _seq;
+    uint8_t  _skip;         /**< Pending SKIP run */
+    uint16_t _frameCrc;
+    uint32_t _coded;
+    uint16_t _skipped;
+    uint32_t _lastCoded;
+    uint16_t _lastSkipped;
+    uint8_t  _lastRows;
+
+    uint16_t _rowCrc[FBC_MAX_HEIGHT];
+    uint16_t _rowA[FBC_MAX_WIDTH];
+    uint16_t _rowB[FBC_MAX_WIDTH];
+    uint16_t* _row;         /**< Row being encoded */
+    uint16_t* _prev;        /**< Row above it */
+
+    uint8_t  _out[FBC_HEADER_LEN + 2 * FBC_ROW_WORST]; /**< Encoded, not yet written */
+    size_t   _outLen;
+};
+
+#endif /* END FBCAPTURE_H_ */
@@ -0,0 +1,65 @@
+#include "imgasset.h"
+
+/* imgasset.cpp */
+
+void ImgDecoder::begin(const ImgAsset& asset) {
+    _asset = &asset;
+    _pos = 0;
+    _remaining = (uint32_t)asset.width * asset.height;
+    _left = 0;
+    _run = false;
+    _runColour = 0;
+    _failed = false;
+}
+
+bool ImgDecoder::fetchToken() {
+    const ImgAsset& a = *_asset;
+    if (_pos >= a.length) return false;
+
+    uint8_t t = a.data[_pos++];
+    _left = (uint8_t)((t & 0x7F) + 1);
+    _run = (t & IMG_RUN_FLAG) != 0;
+    if (_run) {
+        if (_pos >= a.length || a.data[_pos] >= a.colours) return false;
+        _runColour = a.palette[a.data[_pos++]];
+    } else if (a.length - _pos < _left) {
+        return false;
+    }
+    return true;
+}
+
+size_t ImgDecoder::read(uint16_t* out, size_t max) {
+    if (_asset == NULL || _failed) return 0;
+    const ImgAsset& a = *_asset;
+    size_t n = 0;
+
+    while (n < max && _remaining > 0) {
+        if (_left == 0 && !fetchToken()) {
+            _failed = true;
+            break;
+        }
+
+        uint32_t k = _left;
+        if (k > max - n) k = max - n;
+        if (k > _remaining) k = _remaining;
+
+        if (_run) {
+            for (uint32_t i = 0; i < k; i++) out[n + i] = _runColour;
+        } else {
+            const uint8_t* idx = a.data + _pos;
+            for (uint32_t i = 0; i < k; i++) {
+                if (idx[i] >= a.colours) {
+                    _failed = true;
+                    return n + i;
+                }
+                out[n + i] = a.palette[idx[i]];
+            }
+            _pos += k;
+        }
+
+        n += k;
+        _left = (uint8_t)(_left - k);
+        _remaining -= k;
+    }
+    return n;
+}
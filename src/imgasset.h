@@ -0,0 +1,76 @@
+#ifndef IMGASSET_H_
+#define IMGASSET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* imgasset.h - palette + RLE compressed RGB565 images kept in flash.
+ *
+ * tools/imgasset.py converts PNG/PPM files into headers holding one
+ * ImgAsset each. The pixels are a single stream of palette indices in
+ * raster order (runs may cross rows), in the same tokens as the capture
+ * codec (fbcapture.h), but with one-byte indices instead of pixels:
+ *
+ *   0x80|(n-1), u8 index      run of n pixels (1..128)
+ *   n-1, u8 index[n]          n literal pixels (1..128)
+ *
+ * ImgDecoder expands the stream into RGB565 a caller-sized block at a time
+ * and can stop anywhere, even inside a run, so an image of any size goes to
+ * the panel through one small buffer. No Arduino dependency.
+ */
+
+#define IMG_RUN_FLAG    0x80
+#define IMG_TOKEN_MAX   128   /**< Pixels per token */
+#define IMG_MAX_COLOURS 256
+
+/**
+ * @struct ImgAsset
+ * @brief One compressed image, as generated by tools/imgasset.py
+ */
+struct ImgAsset {
+    uint16_t        width;
+    uint16_t        height;
+    uint16_t        colours;  /**< Palette entries, 1..256 */
+    const uint16_t* palette;  /**< RGB565, native byte order */
+    const uint8_t*  data;     /**< Token stream */
+    uint32_t        length;   /**< Bytes in data */
+};
+
+/** @brief Flash used by an asset: stream plus palette. */
+inline uint32_t imgAssetBytes(const ImgAsset& a) { return a.length + 2UL * a.colours; }
+
+/**
+ * @class ImgDecoder
+ * @brief Streaming token decoder, resumable at any pixel
+ */
+class ImgDecoder {
+public:
+    ImgDecoder() : _asset(NULL) {}
+
+    void begin(const ImgAsset& asset);
+
+    /**
+     * @brief Decodes up to max pixels into out.
+     * @return Pixels written; 0 once the image is complete or the stream is bad.
+     */
+    size_t read(uint16_t* out, size_t max);
+
+    uint32_t remaining() const { return _remaining; }
+    bool done() const { return _remaining == 0; }
+
+    /** @brief True if the stream ended early or used an index outside the palette. */
+    bool failed() const { return _failed; }
+
+private:
+    bool fetchToken();
+
+    const ImgAsset* _asset;
+    uint32_t _pos;        /**< Next byte in data */
+    uint32_t _remaining;  /**< Pixels still to produce */
+    uint8_t  _left;       /**< Pixels left in the current token */
+    bool     _run;
+    uint16_t _runColour;
+    bool     _failed;
+};
+
+#endif /* END IMGASSET_H_ */
@@ -0,0 +1,153 @@
+#include <string.h>
+#include "keypadlayout.h"
+#include "crc16.h"
+
+/* keypadlayout.cpp */
+
+static inline uint16_t kplRd16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+KeypadButtonView KeypadPageView::button(uint8_t i) const {
+    if (_p == NULL || i >= buttonCount()) return KeypadButtonView();
+
+    KeypadButtonView b = first();
+    while (i--) b = next(b);
+    return b;
+}
+
+bool KeypadLayout::open(const uint8_t* data, size_t len) {
+    close();
+    if (data == NULL || len < KPL_HEADER_LEN || len > KPL_MAX_LEN) return false;
+
+    const uint32_t magic = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    if (magic != KPL_MAGIC || data[4] != KPL_VERSION) return false;
+
+    const uint8_t pages = data[5];
+    const size_t total = kplRd16(data + 6);
+    if (pages == 0 || pages > KPL_MAX_PAGES) return false;
+    if (total > len || total < KPL_HEADER_LEN + 2u * pages) return false;
+    if (crc16Ccitt(data + KPL_HEADER_LEN, total - KPL_HEADER_LEN) != kplRd16(data + 8)) return false;
+
+    /* Walk every record once so the views never need bounds checks */
+    for (uint8_t pg = 0; pg < pages; pg++) {
+        size_t off = kplRd16(data + KPL_HEADER_LEN + 2 * pg);
+        if (off + 2 > total) return false;
+
+        const uint8_t buttons = data[off];
+        const uint8_t titleLen = data[off + 1];
+        if (buttons > KPL_MAX_BUTTONS || titleLen == 0) return false;
+        off += 2 + titleLen;
+        if (off > total || data[off - 1] != '\0') return false;
+
+        for (uint8_t b = 0; b < buttons; b++) {
+            if (off + KPL_BUTTON_HEAD > total) return false;
+            const uint8_t payloadLen = data[off + 14];
+            const uint8_t labelLen = data[off + 15];
+            if (payloadLen > KPL_MAX_PAYLOAD || labelLen == 0) return false;
+            off += KPL_BUTTON_HEAD + payloadLen + labelLen;
+            if (off > total || data[off - 1] != '\0') return false;
+        }
+    }
+
+    _data = data;
+    _len = total;
+    return true;
+}
+
+KeypadPageView KeypadLayout::page(uint8_t i) const {
+    if (_data == NULL || i >= pageCount()) return KeypadPageView();
+    return KeypadPageView(_data + kplRd16(_data + KPL_HEADER_LEN + 2 * i));
+}
+
+KeypadLayoutWriter::KeypadLayoutWriter(uint8_t* buf, size_t cap, uint8_t pageCount)
+    : _buf(buf), _cap(cap), _pos(0), _pageCount(pageCount), _page(0), _pageStart(0), _error(false) {
+    if (_cap > KPL_MAX_LEN) _cap = KPL_MAX_LEN; /* totalLen and offsets are 16-bit */
+    if (buf == NULL || pageCount == 0 || pageCount > KPL_MAX_PAGES ||
+        _cap < KPL_HEADER_LEN + 2u * pageCount) {
+        _error = true;
+        return;
+    }
+    /* Reserve the header and page table, filled in by beginPage()/finish() */
+    memset(_buf, 0, KPL_HEADER_LEN + 2 * pageCount);
+    _pos = KPL_HEADER_LEN + 2 * pageCount;
+}
+
+bool KeypadLayoutWriter::put(const void* src, size_t n) {
+    if (_error || _pos + n > _cap) {
+        _error = true;
+        return false;
+    }
+    memcpy(_buf + _pos, src, n);
+    _pos += n;
+    return true;
+}
+
+bool KeypadLayoutWriter::put16(uint16_t v) {
+    uint8_t b[2] = { (uint8_t)(v & 0xFF), (uint8_t)(v >> 8) };
+    return put(b, 2);
+}
+
+bool KeypadLayoutWriter::beginPage(const char* title) {
+    if (_error || _page >= _pageCount) {
+        _error = true;
+        return false;
+    }
+    size_t titleLen = strlen(title) + 1;
+    if (titleLen > 255) titleLen = 255;
+
+    _buf[KPL_HEADER_LEN + 2 * _page] = (uint8_t)(_pos & 0xFF);
+    _buf[KPL_HEADER_LEN + 2 * _page + 1] = (uint8_t)(_pos >> 8);
+    _pageStart = _pos;
+    _page++;
+
+    uint8_t head[2] = { 0, (uint8_t)titleLen };
+    if (!put(head, 2) || !put(title, titleLen - 1)) return false;
+    uint8_t nul = 0;
+    return put(&nul, 1);
+}
+
+bool KeypadLayoutWriter::addButton(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color,
+                                   uint16_t canId, uint8_t iconId, uint8_t flags,
+                                   const uint8_t* payload, uint8_t payloadLen, const char* label) {
+    if (_error || _page == 0 || _buf[_pageStart] >= KPL_MAX_BUTTONS || payloadLen > KPL_MAX_PAYLOAD) {
+        _error = true;
+        return false;
+    }
+    size_t labelLen = strlen(label) + 1;
+    if (labelLen > 255) labelLen = 255;
+
+    put16((uint16_t)x); put16((uint16_t)y); put16((uint16_t)w); put16((uint16_t)h);
+    put16(color);
+    put16(canId);
+    uint8_t tail[4] = { iconId, flags, payloadLen, (uint8_t)labelLen };
+    put(tail, 4);
+    if (payloadLen) put(payload, payloadLen);
+    put(label, labelLen - 1);
+    uint8_t nul = 0;
+    if (!put(&nul, 1)) return false;
+
+    _buf[_pageStart]++; /* button count */
+    return true;
+}
+
+size_t KeypadLayoutWriter::finish() {
+    if (_error || _page != _pageCount) return 0;
+
+    _buf[0] = (uint8_t)(KPL_MAGIC & 0xFF);
+    _buf[1] = (uint8_t)((KPL_MAGIC >> 8) & 0xFF);
+    _buf[2] = (uint8_t)((KPL_MAGIC >> 16) & 0xFF);
+    _buf[3] = (uint8_t)((KPL_MAGIC >> 24) & 0xFF);
+    _buf[4] = KPL_VERSION;
+    _buf[5] = _pageCount;
+    _buf[6] = (uint8_t)(_pos & 0xFF);
+    _buf[7] = (uint8_t)(_pos >> 8);
+
+    uint16_t crc = crc16Ccitt(_buf + KPL_HEADER_LEN, _pos - KPL_HEADER_LEN);
+    _buf[8] = (uint8_t)(crc & 0xFF);
+    _buf[9] = (uint8_t)(crc >> 8);
+    _buf[10] = 0;
+    _buf[11] = 0;
+    return _pos;
+}
@@ -0,0 +1,189 @@
+#ifndef KEYPADLAYOUT_H_
+#define KEYPADLAYOUT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* keypadlayout.h - compact binary keypad layouts.
+ *
+ * Layout blob (all integers little endian, no alignment requirements):
+ *
+ *   Header (12 bytes)
+ *     u32  magic        KPL_MAGIC
+ *     u8   version      KPL_VERSION
+ *     u8   pageCount    1..KPL_MAX_PAGES
+ *     u16  totalLen     whole blob, header included
+ *     u16  crc16        CRC-16/CCITT over bytes [12, totalLen)
+ *     u16  reserved     0
+ *   Page table
+ *     u16  pageOffset[pageCount]   offset of each page record from blob start
+ *   Page record
+ *     u8   buttonCount  0..KPL_MAX_BUTTONS
+ *     u8   titleLen     including the NUL terminator
+ *     char title[titleLen]
+ *     Button record[buttonCount]
+ *   Button record (16 byte head + payload + label)
+ *     u16  x, y, w, h
+ *     u16  color        RGB565
+ *     u16  canId        11-bit CAN ID sent on press
+ *     u8   iconId       KPL_ICON_*
+ *     u8   flags        KPL_FLAG_*
+ *     u8   payloadLen   0..8
+ *     u8   labelLen     including the NUL terminator
+ *     u8   payload[payloadLen]
+ *     char label[labelLen]
+ *
+ * KeypadLayout validates a blob once in open(); afterwards the page and
+ * button views read straight from the blob (e.g. a flash mapping) with no
+ * copies. Strings are stored NUL-terminated so they can be drawn in place.
+ */
+
+#define KPL_MAGIC          0x314C504BUL /**< 'KPL1' */
+#define KPL_VERSION        1
+#define KPL_HEADER_LEN     12
+#define KPL_BUTTON_HEAD    16
+#define KPL_MAX_PAGES      8
+#define KPL_MAX_BUTTONS    16
+#define KPL_MAX_PAYLOAD    8
+#define KPL_MAX_LEN        4096 /**< One flash sector */
+
+/** Button flags */
+#define KPL_FLAG_PREFIX_NODE_ID (1 << 0) /**< Send our 4-byte node ID ahead of the payload */
+#define KPL_FLAG_STATEFUL       (1 << 1) /**< Show the state reported for switch payload[0] (see statemodel.h) */
+
+/** Icon IDs, resolved to drawing functions by the renderer */
+enum KeypadIcon { KPL_ICON_NONE = 0,
+                  KPL_ICON_LIGHTBAR,
+                  KPL_ICON_SEAT_WARMER,
+                  KPL_ICON_WATER_PUMP,
+                  KPL_ICON_DEFROSTER,
+                  KPL_ICON_HOME,
+                  KPL_ICON_PALETTE,
+                  KPL_ICON_NETWORK,
+                  KPL_ICON_INFO,
+                  KPL_ICON_COUNT
+                };
+
+/**
+ * @class KeypadButtonView
+ * @brief Read-only view of one button record inside a validated blob.
+ */
+class KeypadButtonView {
+public:
+    KeypadButtonView() : _p(NULL) {}
+    explicit KeypadButtonView(const uint8_t* p) : _p(p) {}
+
+    bool valid() const { return _p != NULL; }
+    int16_t  x() const      { return (int16_t)rd16(0); }
+    int16_t  y() const      { return (int16_t)rd16(2); }
+    int16_t  w() const      { return (int16_t)rd16(4); }
+    int16_t  h() const      { return (int16_t)rd16(6); }
+    uint16_t color() const  { return rd16(8); }
+    uint16_t canId() const  { return rd16(10); }
+    uint8_t  iconId() const { return _p[12]; }
+    uint8_t  flags() const  { return _p[13]; }
+    uint8_t  payloadLen() const { return _p[14]; }
+    const uint8_t* payload() const { return _p + KPL_BUTTON_HEAD; }
+    const char* label() const { return (const char*)(_p + KPL_BUTTON_HEAD + _p[14]); }
+
+    /** @brief True if (px, py) falls inside the button rectangle */
+    bool contains(int px, int py) const {
+        return px >= x() && px <= x() + w() && py >= y() && py <= y() + h();
+    }
+
+    /** @brief Size of this record in bytes */
+    size_t size() const { return KPL_BUTTON_HEAD + _p[14] + _p[15]; }
+    const uint8_t* raw() const { return _p; }
+
+private:
+    uint16_t rd16(size_t off) const { return (uint16_t)(_p[off] | (_p[off + 1] << 8)); }
+    const uint8_t* _p;
+};
+
+/**
+ * @class KeypadPageView
+ * @brief Read-only view of one page record inside a validated blob.
+ */
+class KeypadPageView {
+public:
+    KeypadPageView() : _p(NULL) {}
+    explicit KeypadPageView(const uint8_t* p) : _p(p) {}
+
+    bool valid() const { return _p != NULL; }
+    uint8_t buttonCount() const { return _p ? _p[0] : 0; }
+    const char* title() const { return (const char*)(_p + 2); }
+
+    /** @brief First button record; use next() to walk the rest */
+    KeypadButtonView first() const { return KeypadButtonView(_p + 2 + _p[1]); }
+
+    /** @brief Button i, walking the variable-length records (pages are small) */
+    KeypadButtonView button(uint8_t i) const;
+
+    /** @brief The record following b on the same page */
+    static KeypadButtonView next(const KeypadButtonView& b) {
+        return KeypadButtonView(b.raw() + b.size());
+    }
+
+private:
+    const uint8_t* _p;
+};
+
+/**
+ * @class KeypadLayout
+ * @brief Validates a layout blob and hands out zero-copy page views.
+ */
+class KeypadLayout {
+public:
+    KeypadLayout() : _data(NULL), _len(0) {}
+
+    /**
+     * @brief Validates the blob: header, CRC and the bounds of every record.
+     * @return true if the blob is usable; on failure the layout is left empty.
+     */
+    bool open(const uint8_t* data, size_t len);
+
+    void close() { _data = NULL; _len = 0; }
+    bool isOpen() const { return _data != NULL; }
+    const uint8_t* data() const { return _data; }
+    size_t length() const { return _len; }
+
+    uint8_t pageCount() const { return _data ? _data[5] : 0; }
+    KeypadPageView page(uint8_t i) const;
+
+private:
+    const uint8_t* _data;
+    size_t _len;
+};
+
+/**
+ * @class KeypadLayoutWriter
+ * @brief Builds a layout blob into a caller-provided buffer.
+ * @details Call beginPage()/addButton() in order, then finish(). Any overflow or
+ *          limit violation makes finish() return 0.
+ */
+class KeypadLayoutWriter {
+public:
+    KeypadLayoutWriter(uint8_t* buf, size_t cap, uint8_t pageCount);
+
+    bool beginPage(const char* title);
+    bool addButton(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color,
+                   uint16_t canId, uint8_t iconId, uint8_t flags,
+                   const uint8_t* payload, uint8_t payloadLen, const char* label);
+
+    /** @brief Writes the header and CRC. @return Blob length, 0 on error. */
+    size_t finish();
+
+private:
+    bool put(const void* src, size_t n);
+    bool put16(uint16_t v);
+
+    uint8_t* _buf;
+    size_t   _cap;
+    size_t   _pos;
+    uint8_t  _pageCount;
+    uint8_t  _page;          /**< Pages begun so far */
+    size_t   _pageStart;     /**< Offset of the current page record */
+    bool     _error;
+};
+
+#endif /* END KEYPADLAYOUT_H_ */
@@ -0,0 +1,76 @@
+#include <Arduino.h>
+#include "keypadstore.h"
+#include "keypadlayout.h"
+#include "esp_partition.h"
+#include "esp_idf_version.h"
+
+#if ESP_IDF_VERSION_MAJOR < 5
+#include "esp_spi_flash.h"
+#endif
+
+/* keypadstore.cpp */
+
+static const esp_partition_t* keypadPart = NULL;
+static const uint8_t* keypadMap = NULL;
+static size_t keypadMapLen = 0;
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+static esp_partition_mmap_handle_t keypadMapHandle;
+#else
+static spi_flash_mmap_handle_t keypadMapHandle;
+#endif
+
+static bool keypadMapPartition() {
+    const void* ptr = NULL;
+    keypadMapLen = (keypadPart->size < KPL_MAX_LEN) ? keypadPart->size : KPL_MAX_LEN;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_err_t err = esp_partition_mmap(keypadPart, 0, keypadMapLen, ESP_PARTITION_MMAP_DATA, &ptr, &keypadMapHandle);
+#else
+    esp_err_t err = esp_partition_mmap(keypadPart, 0, keypadMapLen, SPI_FLASH_MMAP_DATA, &ptr, &keypadMapHandle);
+#endif
+    keypadMap = (err == ESP_OK) ? (const uint8_t*)ptr : NULL;
+    return keypadMap != NULL;
+}
+
+static void keypadUnmapPartition() {
+    if (keypadMap == NULL) return;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap(keypadMapHandle);
+#else
+    spi_flash_munmap(keypadMapHandle);
+#endif
+    keypadMap = NULL;
+}
+
+bool keypadStoreBegin() {
+    keypadPart = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          (esp_partition_subtype_t)KEYPAD_PARTITION_SUBTYPE,
+                                          KEYPAD_PARTITION_LABEL);
+    if (keypadPart == NULL) {
+        Serial.println("CYD Warning: no '" KEYPAD_PARTITION_LABEL "' partition, keypad downloads disabled.");
+        return false;
+    }
+    return keypadMapPartition();
+}
+
+bool keypadStoreAvailable() {
+    return keypadPart != NULL;
+}
+
+const uint8_t* keypadStoreMapped(size_t* len) {
+    if (len != NULL) *len = (keypadMap != NULL) ? keypadMapLen : 0;
+    return keypadMap;
+}
+
+bool keypadStoreCommit(const uint8_t* blob, size_t len) {
+    if (keypadPart == NULL || len > keypadPart->size) return false;
+
+    /* The mapping must be gone before the sector is erased underneath it */
+    keypadUnmapPartition();
+
+    bool ok = (esp_partition_erase_range(keypadPart, 0, KPL_MAX_LEN) == ESP_OK) &&
+              (esp_partition_write(keypadPart, 0, blob, len) == ESP_OK);
+
+    ok = keypadMapPartition() && ok;
+    return ok;
+}
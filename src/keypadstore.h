@@ -0,0 +1,44 @@
+#ifndef KEYPADSTORE_H_
+#define KEYPADSTORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* keypadstore.h - flash cache for the downloaded keypad layout.
+ * The blob lives at offset 0 of a small data partition and is read through
+ * a flash mapping, so the renderer walks it in place without a RAM copy.
+ * Needs a partition table entry, e.g.
+ *     keypad, data, 0x40, , 4K,
+ * Without it the store stays unavailable and the built-in layout is used. */
+
+#ifndef KEYPAD_PARTITION_LABEL
+#define KEYPAD_PARTITION_LABEL   "keypad"
+#endif
+#ifndef KEYPAD_PARTITION_SUBTYPE
+#define KEYPAD_PARTITION_SUBTYPE 0x40 /**< First custom data subtype */
+#endif
+
+/**
+ * @brief Finds and maps the keypad partition.
+ * @return true if the partition exists and is mapped.
+ */
+bool keypadStoreBegin();
+
+/** @brief True if keypadStoreBegin() found the partition. */
+bool keypadStoreAvailable();
+
+/**
+ * @brief Mapped contents of the partition (unvalidated).
+ * @param len Receives the mapped length.
+ * @return Pointer into flash, NULL if not mapped.
+ */
+const uint8_t* keypadStoreMapped(size_t* len);
+
+/**
+ * @brief Replaces the stored blob: unmap, erase, write, remap.
+ * @details Pointers returned earlier by keypadStoreMapped() are invalid after this call.
+ * @return true if the blob was written and the partition re-mapped.
+ */
+bool keypadStoreCommit(const uint8_t* blob, size_t len);
+
+#endif /* END KEYPADSTORE_H_ */
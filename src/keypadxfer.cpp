@@ -0,0 +1,226 @@
+#include <string.h>
+#include "keypadxfer.h"
+#include "crc16.h"
+
+/* keypadxfer.cpp */
+
+static inline uint16_t kpxRd16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+KeypadXferRx::KeypadXferRx(uint8_t* buf, size_t cap, uint8_t blockSize, uint32_t timeoutMs,
+                           uint8_t maxRetries, KpxSendFn send, void* ctx)
+    : _buf(buf), _cap(cap), _blockSize(blockSize), _timeoutMs(timeoutMs),
+      _maxRetries(maxRetries), _send(send), _ctx(ctx),
+      _state(IDLE), _session(0), _len(0), _crc(0), _next(0), _frames(0),
+      _blockLeft(0), _nackSent(false), _rtxTag(0), _doneSent(false), _tries(0), _lastActivity(0), _gaps(0), _retries(0) {
+    if (_blockSize == 0) _blockSize = 1;
+    if (_blockSize > 16) _blockSize = 16; /* keeps the 8-bit index unambiguous */
+}
+
+void KeypadXferRx::sendFlow(uint8_t status, bool retransmit) {
+    if (retransmit) {
+        _rtxTag = (uint8_t)(_rtxTag + 1);
+        if (_rtxTag == 0) _rtxTag = 1; /* 0 marks a forward CTS */
+    }
+    uint8_t f[KPX_FRAME_LEN] = { (uint8_t)(KPX_FRAME_FLOW | status), _session,
+                                 (uint8_t)(_next & 0xFF), (uint8_t)(_next >> 8),
+                                 _blockSize, (uint8_t)(retransmit ? _rtxTag : 0), 0, 0 };
+    _send(f, KPX_FRAME_LEN, _ctx);
+}
+
+void KeypadXferRx::finish() {
+    if (crc16Ccitt(_buf, _len) == _crc) {
+        _state = COMPLETE; /* buffer is final before the state flips */
+        _doneSent = true;
+        sendFlow(KPX_FC_DONE);
+    } else {
+        _state = FAILED;
+        sendFlow(KPX_FC_ABORT);
+    }
+}
+
+void KeypadXferRx::onFrame(const uint8_t* data, uint8_t dlc, uint32_t now) {
+    if (dlc < 2) return;
+    const uint8_t type = data[0] & 0xF0;
+
+    if (type == KPX_FRAME_FIRST) {
+        if (dlc < 6) return;
+        const uint8_t session = data[1];
+
+        if (_state == RECEIVING && session == _session) {
+            /* Our CTS was lost (the sender has seen no FLOW, so any CTS moves it on),
+             * or the FIRST was duplicated on the bus: a forward CTS serves both */
+            sendFlow(KPX_FC_CTS);
+            _lastActivity = now;
+            return;
+        }
+        if (_state == COMPLETE) {
+            uint8_t saved = _session;
+            _session = session;
+            sendFlow(KPX_FC_WAIT); /* previous layout not consumed yet */
+            _session = saved;
+            return;
+        }
+
+        _session = session;
+        _doneSent = false;
+        _len = kpxRd16(data + 2);
+        _crc = kpxRd16(data + 4);
+        _next = 0;
+        if (_len == 0 || _len > _cap) {
+            _state = FAILED;
+            sendFlow(KPX_FC_ABORT);
+            return;
+        }
+        _frames = (uint16_t)((_len + KPX_BYTES_PER_FRAME - 1) / KPX_BYTES_PER_FRAME);
+        _blockLeft = _blockSize;
+        _nackSent = false;
+        _tries = 0;
+        _lastActivity = now;
+        _state = RECEIVING;
+        sendFlow(KPX_FC_CTS);
+        return;
+    }
+
+    if (type != KPX_FRAME_DATA) return;
+    if (_state != RECEIVING) {
+        /* The sender still sends after we finished: our DONE was lost */
+        if (_doneSent) sendFlow(KPX_FC_DONE);
+        return;
+    }
+
+    const uint8_t ahead = (uint8_t)(data[1] - (uint8_t)(_next & 0xFF));
+    if (ahead != 0) {
+        /* Behind: a duplicate or a late resend of something we have, drop it.
+         * Ahead: frames were lost, ask once for the one we are missing. */
+        if (ahead < 0x80 && !_nackSent) {
+            _gaps++;
+            _nackSent = true;
+            _blockLeft = _blockSize;
+            sendFlow(KPX_FC_CTS, true);
+        }
+        _lastActivity = now;
+        return;
+    }
+
+    const size_t off = (size_t)_next * KPX_BYTES_PER_FRAME;
+    size_t n = _len - off;
+    if (n > KPX_BYTES_PER_FRAME) n = KPX_BYTES_PER_FRAME;
+    if (dlc < 2 + n) return; /* short frame, wait for the resend */
+
+    memcpy(_buf + off, data + 2, n);
+    _next++;
+    _nackSent = false;
+    _tries = 0;
+    _lastActivity = now;
+
+    if (_next == _frames) {
+        finish();
+    } else if (--_blockLeft == 0) {
+        _blockLeft = _blockSize;
+        sendFlow(KPX_FC_CTS);
+    }
+}
+
+void KeypadXferRx::poll(uint32_t now) {
+    if (_state != RECEIVING || now - _lastActivity < _timeoutMs) return;
+
+    _lastActivity = now;
+    if (++_tries > _maxRetries) {
+        _state = FAILED;
+        sendFlow(KPX_FC_ABORT);
+        return;
+    }
+    _retries++;
+    _blockLeft = _blockSize;
+    sendFlow(KPX_FC_CTS, true);
+}
+
+KeypadXferTx::KeypadXferTx(uint32_t timeoutMs, uint8_t maxRetries, KpxSendFn send, void* ctx)
+    : _timeoutMs(timeoutMs), _maxRetries(maxRetries), _send(send), _ctx(ctx),
+      _state(IDLE), _session(0), _blob(NULL), _len(0), _crc(0), _frames(0),
+      _flowSeen(false), _blockFrom(0), _blockCount(0), _rtxServed(0), _tries(0), _lastActivity(0), _sent(0) {}
+
+bool KeypadXferTx::start(uint8_t session, const uint8_t* blob, size_t len, uint32_t now) {
+    if (blob == NULL || len == 0 || len > 0xFFFF) return false;
+
+    _session = session;
+    _blob = blob;
+    _len = len;
+    _crc = crc16Ccitt(blob, len);
+    _frames = (uint16_t)((len + KPX_BYTES_PER_FRAME - 1) / KPX_BYTES_PER_FRAME);
+    _flowSeen = false;
+    _blockFrom = 0;
+    _rtxServed = 0;
+    _tries = 0;
+    _lastActivity = now;
+    _state = WAIT_FLOW;
+    sendFirst();
+    return true;
+}
+
+void KeypadXferTx::sendFirst() {
+    uint8_t f[KPX_FRAME_LEN] = { KPX_FRAME_FIRST, _session,
+                                 (uint8_t)(_len & 0xFF), (uint8_t)(_len >> 8),
+                                 (uint8_t)(_crc & 0xFF), (uint8_t)(_crc >> 8), 0, 0 };
+    _send(f, KPX_FRAME_LEN, _ctx);
+    _sent++;
+}
+
+void KeypadXferTx::sendBlock(uint16_t from, uint8_t count) {
+    for (uint16_t i = from; i < _frames && i < from + count; i++) {
+        uint8_t f[KPX_FRAME_LEN] = { KPX_FRAME_DATA, (uint8_t)(i & 0xFF), 0, 0, 0, 0, 0, 0 };
+        size_t off = (size_t)i * KPX_BYTES_PER_FRAME;
+        size_t n = _len - off;
+        if (n > KPX_BYTES_PER_FRAME) n = KPX_BYTES_PER_FRAME;
+        memcpy(f + 2, _blob + off, n);
+        _send(f, KPX_FRAME_LEN, _ctx);
+        _sent++;
+    }
+}
+
+void KeypadXferTx::onFrame(const uint8_t* data, uint8_t dlc, uint32_t now) {
+    if (_state != WAIT_FLOW || dlc < 5) return;
+    if ((data[0] & 0xF0) != KPX_FRAME_FLOW || data[1] != _session) return;
+
+    _lastActivity = now;
+    _tries = 0;
+    switch (data[0] & 0x0F) {
+        case KPX_FC_CTS: {
+            const uint16_t from = kpxRd16(data + 2);
+            const uint8_t rtx = (dlc > 5) ? data[5] : 0;
+            const bool newer = !_flowSeen || from > _blockFrom;
+            const bool retransmit = (rtx != 0 && rtx != _rtxServed);
+            if (!newer && !retransmit) break; /* duplicate or late CTS, block already sent */
+
+            if (rtx != 0) _rtxServed = rtx;
+            _flowSeen = true;
+            _blockFrom = from;
+            _blockCount = data[4] ? data[4] : 1;
+            sendBlock(_blockFrom, _blockCount);
+            break;
+        }
+        case KPX_FC_WAIT:
+            _flowSeen = false; /* FIRST is repeated after the timeout */
+            break;
+        case KPX_FC_DONE:
+            _state = DONE;
+            break;
+        default:
+            _state = FAILED;
+            break;
+    }
+}
+
+void KeypadXferTx::poll(uint32_t now) {
+    if (_state != WAIT_FLOW || now - _lastActivity < _timeoutMs) return;
+
+    _lastActivity = now;
+    if (++_tries > _maxRetries) {
+        _state = FAILED;
+        return;
+    }
+    if (_flowSeen) sendBlock(_blockFrom, _blockCount);
+    else sendFirst();
+}
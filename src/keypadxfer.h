@@ -0,0 +1,159 @@
+#ifndef KEYPADXFER_H_
+#define KEYPADXFER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* keypadxfer.h - segmented multi-frame transfer of keypad layouts over CAN.
+ *
+ * Data frames go sender -> CYD on KEYPAD_XFER_ID, flow control CYD -> sender
+ * on KEYPAD_XFER_FC_ID. All frames are 8 bytes, integers little endian.
+ *
+ *   FIRST  [0]=0x10 [1]=session [2..3]=total length [4..5]=CRC-16/CCITT of the blob
+ *   DATA   [0]=0x20 [1]=frame index & 0xFF [2..7]=up to 6 payload bytes
+ *   FLOW   [0]=0x30|status [1]=session [2..3]=next frame index [4]=block size
+ *          [5]=retransmit tag: 0 for a CTS that moves forward, 1..255 (new per
+ *              request) for a CTS that asks for frames again
+ *
+ * After FIRST and after every block of DATA frames the receiver answers with
+ * FLOW/CTS naming the next frame it wants, so the sender never overruns it.
+ * A frame from ahead of the expected index (a drop) makes the receiver send
+ * a retransmit CTS for the frame it is missing, once; the sender restarts
+ * from there. Frames from behind (duplicates, late resends) are ignored.
+ * The sender acts on a CTS only if its index is newer than the last one it
+ * served or it carries a retransmit tag it has not served, so a duplicated
+ * or late CTS does not resend a block twice. Silence is recovered by the
+ * sender re-sending FIRST or its last block, and by the receiver re-sending
+ * its last CTS as a retransmit; DATA arriving after DONE (the DONE was lost)
+ * gets DONE again. The receiver checks the CRC before reporting FLOW/DONE.
+ *
+ * Both ends are plain C++ with injected send and time so a transfer can be
+ * replayed on a host, including with frames dropped in either direction.
+ */
+
+#define KPX_FRAME_FIRST     0x10
+#define KPX_FRAME_DATA      0x20
+#define KPX_FRAME_FLOW      0x30
+#define KPX_FRAME_LEN       8
+#define KPX_BYTES_PER_FRAME 6
+
+/** --- FLOW status, low nibble of byte 0 --- */
+enum KpxFlowStatus { KPX_FC_CTS = 0,   /**< Send from "next frame index" */
+                     KPX_FC_WAIT = 1,  /**< Receiver busy, retry FIRST later */
+                     KPX_FC_ABORT = 2, /**< Transfer rejected or CRC failed */
+                     KPX_FC_DONE = 3   /**< Blob received and verified */
+                   };
+
+/** @brief Sends one 8-byte frame on the peer's CAN ID */
+typedef void (*KpxSendFn)(const uint8_t* frame, uint8_t len, void* ctx);
+
+/**
+ * @class KeypadXferRx
+ * @brief Receiving end (the CYD).
+ */
+class KeypadXferRx {
+public:
+    enum State { IDLE, RECEIVING, COMPLETE, FAILED };
+
+    /**
+     * @param buf Reassembly buffer; the finished blob stays here until release()
+     * @param cap Size of buf, also the largest accepted transfer
+     * @param blockSize DATA frames per FLOW/CTS (1..16)
+     * @param timeoutMs Silence before the last FLOW is re-sent
+     * @param maxRetries Re-sends before the transfer is abandoned
+     */
+    KeypadXferRx(uint8_t* buf, size_t cap, uint8_t blockSize, uint32_t timeoutMs,
+                 uint8_t maxRetries, KpxSendFn send, void* ctx);
+
+    /** @brief Feeds a frame received on KEYPAD_XFER_ID. */
+    void onFrame(const uint8_t* data, uint8_t dlc, uint32_t now);
+
+    /** @brief Handles timeouts; call periodically. */
+    void poll(uint32_t now);
+
+    State state() const { return _state; }
+    bool complete() const { return _state == COMPLETE; }
+    const uint8_t* data() const { return _buf; }
+    size_t length() const { return _len; }
+
+    /** @brief Hands the buffer back after a COMPLETE/FAILED transfer was consumed. */
+    void release() { _state = IDLE; }
+
+    uint32_t gapCount() const { return _gaps; }
+    uint32_t retryCount() const { return _retries; }
+
+private:
+    void sendFlow(uint8_t status, bool retransmit = false);
+    void finish();
+
+    uint8_t*  _buf;
+    size_t    _cap;
+    uint8_t   _blockSize;
+    uint32_t  _timeoutMs;
+    uint8_t   _maxRetries;
+    KpxSendFn _send;
+    void*     _ctx;
+
+    volatile State _state;
+    uint8_t   _session;
+    size_t    _len;
+    uint16_t  _crc;
+    uint16_t  _next;        /**< Next frame index expected */
+    uint16_t  _frames;      /**< Frames in the transfer */
+    uint8_t   _blockLeft;   /**< Frames left before the next CTS */
+    bool      _nackSent;    /**< CTS already re-sent for the current _next */
+    uint8_t   _rtxTag;      /**< Tag of the last retransmit CTS */
+    bool      _doneSent;    /**< DONE sent for _session; repeated if its DATA keeps coming */
+    uint8_t   _tries;
+    uint32_t  _lastActivity;
+    uint32_t  _gaps;
+    uint32_t  _retries;
+};
+
+/**
+ * @class KeypadXferTx
+ * @brief Sending end (a configuration node or tool, and host tests).
+ */
+class KeypadXferTx {
+public:
+    enum State { IDLE, WAIT_FLOW, DONE, FAILED };
+
+    KeypadXferTx(uint32_t timeoutMs, uint8_t maxRetries, KpxSendFn send, void* ctx);
+
+    /** @brief Starts sending blob under the given session number. */
+    bool start(uint8_t session, const uint8_t* blob, size_t len, uint32_t now);
+
+    /** @brief Feeds a frame received on KEYPAD_XFER_FC_ID. */
+    void onFrame(const uint8_t* data, uint8_t dlc, uint32_t now);
+
+    /** @brief Handles timeouts; call periodically. */
+    void poll(uint32_t now);
+
+    State state() const { return _state; }
+    uint32_t framesSent() const { return _sent; }
+
+private:
+    void sendFirst();
+    void sendBlock(uint16_t from, uint8_t count);
+
+    uint32_t  _timeoutMs;
+    uint8_t   _maxRetries;
+    KpxSendFn _send;
+    void*     _ctx;
+
+    State     _state;
+    uint8_t   _session;
+    const uint8_t* _blob;
+    size_t    _len;
+    uint16_t  _crc;
+    uint16_t  _frames;
+    bool      _flowSeen;    /**< At least one FLOW received */
+    uint16_t  _blockFrom;   /**< Last block requested by the receiver */
+    uint8_t   _blockCount;
+    uint8_t   _rtxServed;   /**< Retransmit tag of the last CTS acted on */
+    uint8_t   _tries;
+    uint32_t  _lastActivity;
+    uint32_t  _sent;
+};
+
+#endif /* END KEYPADXFER_H_ */
@@ -0,0 +1,138 @@
+#include "nodelist.h"
+
+/* nodelist.cpp */
+
+NodeListView::NodeListView(uint8_t* order, uint8_t* position, uint8_t capacity,
+                           int16_t top, int16_t rowHeight, uint8_t rowsPerPage)
+    : _order(order), _position(position), _capacity(capacity),
+      _top(top), _rowHeight(rowHeight),
+      _rows((rowsPerPage > NODELIST_MAX_ROWS) ? NODELIST_MAX_ROWS : rowsPerPage),
+      _sort(NODE_SORT_ID), _filter(0), _filterDigits(0), _count(0), _page(0), _dirtyRows(0) {
+    if (_capacity == NODELIST_NONE) _capacity--; /* NODELIST_NONE must stay free as a marker */
+    for (uint8_t i = 0; i < _capacity; i++) _position[i] = NODELIST_NONE;
+}
+
+bool NodeListView::matches(uint32_t id) const {
+    if (_filterDigits == 0) return true;
+    return (id >> (4 * (NODELIST_ID_DIGITS - _filterDigits))) == _filter;
+}
+
+bool NodeListView::pushFilterDigit(uint8_t digit) {
+    if (digit > 0xF || _filterDigits >= NODELIST_ID_DIGITS) return false;
+    _filter = (_filter << 4) | digit;
+    _filterDigits++;
+    return true;
+}
+
+bool NodeListView::popFilterDigit() {
+    if (_filterDigits == 0) return false;
+    _filter >>= 4;
+    _filterDigits--;
+    return true;
+}
+
+void NodeListView::formatFilter(char* out, size_t cap) const {
+    static const char hex[] = "0123456789ABCDEF";
+    if (cap == 0) return;
+
+    size_t n = 0;
+    for (int8_t d = _filterDigits - 1; d >= 0 && n + 1 < cap; d--) {
+        out[n++] = hex[(_filter >> (4 * d)) & 0xF];
+    }
+    out[n] = '\0';
+}
+
+bool NodeListView::before(const NodeListSource& src, uint8_t a, uint8_t b, uint32_t now) const {
+    switch (_sort) {
+        case NODE_SORT_LAST_SEEN: {
+            /* Never seen sorts last; otherwise the smaller age wins (wrap-safe) */
+            uint32_t sa = src.nodeLastSeen(a), sb = src.nodeLastSeen(b);
+            uint32_t ageA = sa ? now - sa : 0xFFFFFFFFUL;
+            uint32_t ageB = sb ? now - sb : 0xFFFFFFFFUL;
+            if (ageA != ageB) return ageA < ageB;
+            break;
+        }
+        case NODE_SORT_ACTIVITY: {
+            uint16_t actA = src.nodeActivity(a), actB = src.nodeActivity(b);
+            if (actA != actB) return actA > actB;
+            break;
+        }
+        default:
+            break;
+    }
+    return src.nodeId(a) < src.nodeId(b);
+}
+
+void NodeListView::rebuild(const NodeListSource& src, uint32_t now) {
+    uint8_t slots = src.slotCount();
+    if (slots > _capacity) slots = _capacity;
+
+    /* Filter, then insertion sort: the table is small and mostly arrives in order */
+    _count = 0;
+    for (uint8_t s = 0; s < slots; s++) {
+        uint32_t id = src.nodeId(s);
+        if (id == 0 || !matches(id)) continue;
+
+        uint8_t i = _count++;
+        while (i > 0 && before(src, s, _order[i - 1], now)) {
+            _order[i] = _order[i - 1];
+            i--;
+        }
+        _order[i] = s;
+    }
+
+    for (uint8_t i = 0; i < _capacity; i++) _position[i] = NODELIST_NONE;
+    for (uint8_t i = 0; i < _count; i++) _position[_order[i]] = i;
+
+    if (_page >= pageCount()) _page = pageCount() - 1;
+    _dirtyRows = 0; /* the caller repaints the whole page after a rebuild */
+}
+
+uint8_t NodeListView::pageCount() const {
+    if (_count == 0 || _rows == 0) return 1;
+    return (uint8_t)((_count + _rows - 1) / _rows);
+}
+
+bool NodeListView::setPage(uint8_t page) {
+    if (page >= pageCount() || page == _page) return false;
+    _page = page;
+    _dirtyRows = 0;
+    return true;
+}
+
+uint8_t NodeListView::visibleCount() const {
+    const uint16_t first = (uint16_t)_page * _rows;
+    if (first >= _count) return 0;
+    const uint16_t left = _count - first;
+    return (uint8_t)((left < _rows) ? left : _rows);
+}
+
+int NodeListView::slotAtRow(uint8_t row) const {
+    if (row >= visibleCount()) return -1;
+    return _order[(uint16_t)_page * _rows + row];
+}
+
+int NodeListView::rowOfSlot(int slot) const {
+    if (slot < 0 || slot >= _capacity || _position[slot] == NODELIST_NONE) return -1;
+    const int row = (int)_position[slot] - (int)_page * _rows;
+    return (row >= 0 && row < _rows) ? row : -1;
+}
+
+int NodeListView::hitTest(int y) const {
+    if (y < _top || _rowHeight <= 0) return -1;
+    const int row = (y - _top) / _rowHeight;
+    if (row >= _rows) return -1;
+    return slotAtRow((uint8_t)row);
+}
+
+int NodeListView::slotAfter(int slot) const {
+    if (_count == 0) return -1;
+    if (slot < 0 || slot >= _capacity || _position[slot] == NODELIST_NONE) return _order[0];
+    const uint8_t next = _position[slot] + 1;
+    return _order[(next < _count) ? next : 0];
+}
+
+void NodeListView::markSlotDirty(int slot) {
+    const int row = rowOfSlot(slot);
+    if (row >= 0) _dirtyRows |= (1UL << row);
+}
@@ -0,0 +1,129 @@
+#ifndef NODELIST_H_
+#define NODELIST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* nodelist.h - virtualised, paged view over the ARGB node table.
+ *
+ * The view keeps a sorted and filtered order of node table slots and maps it
+ * onto fixed-height rows, one page at a time. The renderer only ever walks
+ * the rows of the current page, and the same row geometry drives hitTest(),
+ * so what is drawn and what is touched cannot drift apart.
+ *
+ * The order is a snapshot taken by rebuild(): heartbeats do not make rows
+ * jump around under the user's finger. Per-node changes are tracked as dirty
+ * rows instead (markSlotDirty()), so a single node changing state repaints a
+ * single row. No Arduino dependency.
+ */
+
+#define NODELIST_NONE     0xFF /**< "Not listed" marker; capacity is at most 255 slots */
+#define NODELIST_MAX_ROWS 32   /**< Rows per page, bounded by the dirty row mask */
+#define NODELIST_ID_DIGITS 8   /**< Hex digits of a 32-bit node ID */
+
+/** --- Sort keys; ties are always broken by ascending ID --- */
+enum NodeSortKey { NODE_SORT_ID = 0,     /**< Ascending node ID */
+                   NODE_SORT_LAST_SEEN,  /**< Most recent heartbeat first, never-seen last */
+                   NODE_SORT_ACTIVITY,   /**< Busiest first */
+                   NODE_SORT_COUNT
+                 };
+
+/**
+ * @class NodeListSource
+ * @brief Read access to the node table. Slots with ID 0 are empty.
+ */
+class NodeListSource {
+public:
+    virtual ~NodeListSource() {}
+    virtual uint8_t  slotCount() const = 0;
+    virtual uint32_t nodeId(uint8_t slot) const = 0;
+    virtual uint32_t nodeLastSeen(uint8_t slot) const = 0; /**< 0 = no heartbeat since boot */
+    virtual uint16_t nodeActivity(uint8_t slot) const = 0;
+};
+
+/**
+ * @class NodeListView
+ * @brief Sort, ID-prefix filter, paging, row geometry and dirty rows.
+ */
+class NodeListView {
+public:
+    /**
+     * @param order Buffer for the listed slots, capacity entries
+     * @param position Buffer for the slot -> list position map, capacity entries
+     * @param capacity Node table slots (<= 255)
+     * @param top Y of the first row
+     * @param rowHeight Row pitch in pixels
+     * @param rowsPerPage Rows shown per page (<= NODELIST_MAX_ROWS)
+     */
+    NodeListView(uint8_t* order, uint8_t* position, uint8_t capacity,
+                 int16_t top, int16_t rowHeight, uint8_t rowsPerPage);
+
+    /**
+     * @brief Re-applies filter and sort to the table; keeps the page if it still exists.
+     * @param now Current time in ms, for the last-seen ordering
+     */
+    void rebuild(const NodeListSource& src, uint32_t now);
+
+    void setSort(NodeSortKey key) { _sort = (key < NODE_SORT_COUNT) ? key : NODE_SORT_ID; }
+    NodeSortKey sort() const { return _sort; }
+
+    /** --- ID prefix filter, entered one hex digit at a time; rebuild() to apply --- */
+    bool pushFilterDigit(uint8_t digit);
+    bool popFilterDigit();
+    void clearFilter() { _filter = 0; _filterDigits = 0; }
+    uint8_t filterDigits() const { return _filterDigits; }
+    bool matches(uint32_t id) const;
+
+    /** @brief Writes the prefix as hex digits, e.g. "1A", or "" without a filter. */
+    void formatFilter(char* out, size_t cap) const;
+
+    /** --- Paging --- */
+    uint8_t count() const { return _count; }
+    uint8_t pageCount() const;
+    uint8_t page() const { return _page; }
+    bool setPage(uint8_t page);
+    bool nextPage() { return setPage((_page + 1 < pageCount()) ? _page + 1 : 0); }
+    bool prevPage() { return setPage(_page ? _page - 1 : pageCount() - 1); }
+
+    /** --- Rows of the current page --- */
+    uint8_t rows() const { return _rows; }
+    uint8_t visibleCount() const;
+    int16_t rowTop(uint8_t row) const { return _top + (int16_t)row * _rowHeight; }
+    int16_t rowHeight() const { return _rowHeight; }
+    int16_t bottom() const { return rowTop(_rows); }
+
+    /** @brief Slot drawn in row, -1 if the row is empty. */
+    int slotAtRow(uint8_t row) const;
+
+    /** @brief Row showing slot on the current page, -1 if not visible. */
+    int rowOfSlot(int slot) const;
+
+    /** @brief Slot under a touch at y, -1 outside the drawn rows. */
+    int hitTest(int y) const;
+
+    /** @brief The listed slot after slot, wrapping; the first one if slot is not listed. */
+    int slotAfter(int slot) const;
+
+    /** --- Incremental repaint --- */
+    void markSlotDirty(int slot);
+    uint32_t takeDirtyRows() { uint32_t d = _dirtyRows; _dirtyRows = 0; return d; }
+
+private:
+    bool before(const NodeListSource& src, uint8_t a, uint8_t b, uint32_t now) const;
+
+    uint8_t*    _order;
+    uint8_t*    _position;
+    uint8_t     _capacity;
+    int16_t     _top;
+    int16_t     _rowHeight;
+    uint8_t     _rows;
+
+    NodeSortKey _sort;
+    uint32_t    _filter;        /**< Prefix value, right aligned */
+    uint8_t     _filterDigits;  /**< 0 = no filter */
+    uint8_t     _count;         /**< Listed slots */
+    uint8_t     _page;
+    uint32_t    _dirtyRows;     /**< Bit per row of the current page */
+};
+
+#endif /* END NODELIST_H_ */
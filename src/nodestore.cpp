@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <string.h>
+#include "nodestore.h"
+#include "crc16.h"
+
+#if defined(ARDUINO)
+#include <Preferences.h>
+#endif
+
+/* nodestore.cpp */
+
+#define NODESTORE_NVS_KEY "table" /**< Key of the blob inside the NVS namespace */
+
+size_t nodeStoreEncode(const NodeRecord* recs, uint8_t count, uint8_t* out, size_t cap) {
+    const size_t len = NODESTORE_BLOB_LEN(count);
+    if (out == NULL || cap < len) return 0;
+
+    /* Header: magic (little endian), version, count, crc16 placeholder */
+    out[0] = (uint8_t)(NODESTORE_MAGIC & 0xFF);
+    out[1] = (uint8_t)((NODESTORE_MAGIC >> 8) & 0xFF);
+    out[2] = (uint8_t)((NODESTORE_MAGIC >> 16) & 0xFF);
+    out[3] = (uint8_t)((NODESTORE_MAGIC >> 24) & 0xFF);
+    out[4] = NODESTORE_VERSION;
+    out[5] = count;
+
+    uint8_t* p = out + NODESTORE_HEADER_LEN;
+    for (uint8_t i = 0; i < count; i++) {
+        p[0] = (uint8_t)(recs[i].id & 0xFF);
+        p[1] = (uint8_t)((recs[i].id >> 8) & 0xFF);
+        p[2] = (uint8_t)((recs[i].id >> 16) & 0xFF);
+        p[3] = (uint8_t)((recs[i].id >> 24) & 0xFF);
+        p[4] = (uint8_t)recs[i].lastColorIdx;
+        p[5] = recs[i].stripCount;
+        p[6] = 0;
+        p[7] = 0;
+        p += sizeof(NodeRecord);
+    }
+
+    /* CRC covers everything except the CRC field itself */
+    uint16_t crc = crc16Ccitt(out, 6);
+    crc = crc16Ccitt(out + NODESTORE_HEADER_LEN, len - NODESTORE_HEADER_LEN, crc);
+    out[6] = (uint8_t)(crc & 0xFF);
+    out[7] = (uint8_t)(crc >> 8);
+    return len;
+}
+
+int nodeStoreDecode(const uint8_t* in, size_t len, NodeRecord* recs, uint8_t maxRecs) {
+    if (in == NULL || len < NODESTORE_HEADER_LEN) return -1;
+
+    const uint32_t magic = (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+                           ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+    if (magic != NODESTORE_MAGIC || in[4] != NODESTORE_VERSION) return -1;
+
+    const uint8_t count = in[5];
+    if (len != NODESTORE_BLOB_LEN(count)) return -1;
+
+    uint16_t crc = crc16Ccitt(in, 6);
+    crc = crc16Ccitt(in + NODESTORE_HEADER_LEN, len - NODESTORE_HEADER_LEN, crc);
+    if (crc != (uint16_t)(in[6] | (in[7] << 8))) return -1;
+
+    /* Silently drop records that no longer fit (e.g. MAX_ARGB_NODES shrank) */
+    const uint8_t n = (count < maxRecs) ? count : maxRecs;
+    const uint8_t* p = in + NODESTORE_HEADER_LEN;
+    for (uint8_t i = 0; i < n; i++) {
+        recs[i].id = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                     ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        recs[i].lastColorIdx = (int8_t)p[4];
+        recs[i].stripCount = p[5];
+        recs[i].reserved[0] = 0;
+        recs[i].reserved[1] = 0;
+        p += sizeof(NodeRecord);
+    }
+    return n;
+}
+
+size_t FileNodeStore::load(uint8_t* buf, size_t cap) {
+    FILE* f = fopen(_path, "rb");
+    if (f == NULL) return 0;
+    size_t n = fread(buf, 1, cap, f);
+    fclose(f);
+    return n;
+}
+
+bool FileNodeStore::save(const uint8_t* buf, size_t len) {
+    FILE* f = fopen(_path, "wb");
+    if (f == NULL) return false;
+    bool ok = (fwrite(buf, 1, len, f) == len);
+    ok = (fclose(f) == 0) && ok;
+    return ok;
+}
+
+#if defined(ARDUINO)
+size_t NvsNodeStore::load(uint8_t* buf, size_t cap) {
+    Preferences prefs;
+    if (!prefs.begin(_ns, true)) return 0; /* read-only; fails if namespace is new */
+    size_t n = 0;
+    if (prefs.isKey(NODESTORE_NVS_KEY)) {
+        n = prefs.getBytes(NODESTORE_NVS_KEY, buf, cap);
+    }
+    prefs.end();
+    return n;
+}
+
+bool NvsNodeStore::save(const uint8_t* buf, size_t len) {
+    Preferences prefs;
+    if (!prefs.begin(_ns, false)) return false;
+    bool ok = (prefs.putBytes(NODESTORE_NVS_KEY, buf, len) == len);
+    prefs.end();
+    return ok;
+}
+#endif
+
+NodeTablePersister::NodeTablePersister(NodeStore& store, uint8_t* buf, size_t bufLen,
+                                       uint32_t debounceMs, uint32_t minIntervalMs)
+    : _store(store), _buf(buf), _bufLen(bufLen),
+      _debounceMs(debounceMs), _minIntervalMs(minIntervalMs),
+      _lastChange(0), _lastWrite(0), _writes(0), _failures(0),
+      _storedCrc(0), _hasStored(false), _dirty(false) {}
+
+int NodeTablePersister::restore(NodeRecord* recs, uint8_t maxRecs) {
+    size_t len = _store.load(_buf, _bufLen);
+    int n = nodeStoreDecode(_buf, len, recs, maxRecs);
+    if (n < 0) return 0;
+
+    /* Remember what is on flash so an unchanged table is never rewritten */
+    _storedCrc = (uint16_t)(_buf[6] | (_buf[7] << 8));
+    _hasStored = true;
+    return n;
+}
+
+void NodeTablePersister::markDirty(uint32_t now) {
+    _dirty = true;
+    _lastChange = now;
+}
+
+bool NodeTablePersister::service(const NodeRecord* recs, uint8_t count, uint32_t now) {
+    if (!_dirty) return false;
+    if (now - _lastChange < _debounceMs) return false;             /* still settling */
+    if ((_writes + _failures) > 0 && now - _lastWrite < _minIntervalMs) return false; /* rate limit */
+
+    size_t len = nodeStoreEncode(recs, count, _buf, _bufLen);
+    if (len == 0) return false;
+
+    uint16_t crc = (uint16_t)(_buf[6] | (_buf[7] << 8));
+    _dirty = false;
+    if (_hasStored && crc == _storedCrc) return false; /* content unchanged, skip the erase */
+
+    if (!_store.save(_buf, len)) {
+        _dirty = true; /* retry after the next interval */
+        _lastWrite = now;
+        _failures++;
+        return false;
+    }
+
+    _storedCrc = crc;
+    _hasStored = true;
+    _lastWrite = now;
+    _writes++;
+    return true;
+}
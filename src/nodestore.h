@@ -0,0 +1,164 @@
+#ifndef NODESTORE_H_
+#define NODESTORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* nodestore.h - persistence for the discovered ARGB node table.
+ * Kept free of Arduino dependencies so the encode/debounce logic can be
+ * built and exercised on a host. */
+
+#define NODESTORE_MAGIC       0x43594E54UL /**< 'CYNT' blob marker */
+#define NODESTORE_VERSION     1            /**< Bump when NodeRecord layout changes */
+#define NODESTORE_HEADER_LEN  8            /**< magic(4) + version(1) + count(1) + crc16(2) */
+
+/** Size in bytes of a blob holding n records */
+#define NODESTORE_BLOB_LEN(n) (NODESTORE_HEADER_LEN + ((n) * sizeof(NodeRecord)))
+
+/**
+ * @struct NodeRecord
+ * @brief The persisted subset of an ARGB node. Heartbeat timestamps are
+ *        deliberately excluded so heartbeats never dirty the flash copy.
+ */
+struct NodeRecord {
+    uint32_t id;           /**< 32-bit Node ID */
+    int8_t   lastColorIdx; /**< Last palette index sent to the node */
+    uint8_t  stripCount;   /**< Number of strips reported by the node */
+    uint8_t  reserved[2];  /**< Padding, always written as zero */
+};
+
+/**
+ * @brief Serialises records into a versioned, checksummed blob.
+ * @return Number of bytes written, or 0 if out is too small.
+ */
+size_t nodeStoreEncode(const NodeRecord* recs, uint8_t count, uint8_t* out, size_t cap);
+
+/**
+ * @brief Parses a blob produced by nodeStoreEncode().
+ * @return Number of records restored, or -1 if the blob is invalid.
+ */
+int nodeStoreDecode(const uint8_t* in, size_t len, NodeRecord* recs, uint8_t maxRecs);
+
+/**
+ * @brief Slot a new node may take over when the node table is full.
+ * @details Only nodes not currently heard are candidates: restored nodes that
+ *          have sent nothing since boot go first, then the node silent the
+ *          longest (now - lastSeen, so millis() wrap is fine). Node needs the
+ *          id, lastSeen, active and confirmed members of the UI's ARGBNode.
+ * @return Slot index, or -1 if every node is active.
+ */
+template <typename Node>
+int nodeStoreEvictSlot(const Node* nodes, int count, uint32_t now) {
+    int victim = -1;
+    for (int i = 0; i < count; i++) {
+        const Node& n = nodes[i];
+        if (n.id == 0 || n.active) continue;
+        if (victim < 0) { victim = i; continue; }
+        const Node& v = nodes[victim];
+        if (n.confirmed != v.confirmed) {
+            if (!n.confirmed) victim = i;
+        } else if (n.confirmed && (now - n.lastSeen) > (now - v.lastSeen)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/**
+ * @class NodeStore
+ * @brief Storage backend for the node table blob.
+ */
+class NodeStore {
+public:
+    virtual ~NodeStore() {}
+
+    /** @brief Reads the stored blob. @return Bytes read, 0 if nothing stored. */
+    virtual size_t load(uint8_t* buf, size_t cap) = 0;
+
+    /** @brief Replaces the stored blob. @return true on success. */
+    virtual bool save(const uint8_t* buf, size_t len) = 0;
+};
+
+/**
+ * @class FileNodeStore
+ * @brief Stores the blob in a regular file (host tests, or SPIFFS/LittleFS via VFS).
+ */
+class FileNodeStore : public NodeStore {
+public:
+    explicit FileNodeStore(const char* path) : _path(path) {}
+    size_t load(uint8_t* buf, size_t cap) override;
+    bool save(const uint8_t* buf, size_t len) override;
+
+private:
+    const char* _path;
+};
+
+#if defined(ARDUINO)
+/**
+ * @class NvsNodeStore
+ * @brief Stores the blob as a single NVS entry. NVS spreads writes across its
+ *        pages, so only the write rate needs limiting (see NodeTablePersister).
+ */
+class NvsNodeStore : public NodeStore {
+public:
+    explicit NvsNodeStore(const char* nvsNamespace) : _ns(nvsNamespace) {}
+    size_t load(uint8_t* buf, size_t cap) override;
+    bool save(const uint8_t* buf, size_t len) override;
+
+private:
+    const char* _ns;
+};
+#endif
+
+/**
+ * @class NodeTablePersister
+ * @brief Debounced, change-only writer in front of a NodeStore.
+ * @details A write happens only once the table has been quiet for debounceMs,
+ *          at least minIntervalMs has passed since the previous write, and
+ *          the encoded blob differs from what is already stored.
+ */
+class NodeTablePersister {
+public:
+    /**
+     * @param store Backend holding the blob
+     * @param buf Scratch buffer of at least NODESTORE_BLOB_LEN(max records) bytes
+     * @param bufLen Size of buf in bytes
+     */
+    NodeTablePersister(NodeStore& store, uint8_t* buf, size_t bufLen,
+                       uint32_t debounceMs, uint32_t minIntervalMs);
+
+    /**
+     * @brief Loads the stored table.
+     * @return Number of records restored (0 if missing or corrupt).
+     */
+    int restore(NodeRecord* recs, uint8_t maxRecs);
+
+    /** @brief Flags the table as changed at time now (ms). */
+    void markDirty(uint32_t now);
+
+    /**
+     * @brief Writes the table if the debounce and rate limits allow it.
+     * @return true if the backend was written.
+     */
+    bool service(const NodeRecord* recs, uint8_t count, uint32_t now);
+
+    bool     isDirty() const    { return _dirty; }
+    uint32_t writeCount() const { return _writes; }
+    uint32_t failCount() const  { return _failures; }
+
+private:
+    NodeStore& _store;
+    uint8_t*   _buf;
+    size_t     _bufLen;
+    uint32_t   _debounceMs;
+    uint32_t   _minIntervalMs;
+    uint32_t   _lastChange;
+    uint32_t   _lastWrite;
+    uint32_t   _writes;
+    uint32_t   _failures;
+    uint16_t   _storedCrc;  /**< CRC of the blob currently in the backend */
+    bool       _hasStored;
+    bool       _dirty;
+};
+
+#endif /* END NODESTORE_H_ */
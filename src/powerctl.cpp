@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include "powerctl.h"
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#include "esp_idf_version.h"
+#endif
+
+/* powerctl.cpp */
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t uiCpuLock = NULL;
+static bool uiCpuLockHeld = false;
+#endif
+
+bool powerBegin() {
+#if CONFIG_PM_ENABLE
+#if CYD_PM_CONFIGURE
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t pmConfig = {};
+#else
+    esp_pm_config_esp32_t pmConfig = {};
+#endif
+    pmConfig.max_freq_mhz = CYD_PM_MAX_MHZ;
+    pmConfig.min_freq_mhz = CYD_PM_MIN_MHZ;
+    pmConfig.light_sleep_enable = false; /* touch IRQ and TWAI must stay serviced */
+
+    if (esp_pm_configure(&pmConfig) != ESP_OK) {
+        Serial.println("CYD Warning: power management not available.");
+        return false;
+    }
+    Serial.printf("CYD: DFS %d..%d MHz\n", CYD_PM_MIN_MHZ, CYD_PM_MAX_MHZ);
+#endif
+    /* Without CYD_PM_CONFIGURE the lock only matters if the application runs DFS */
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "cyd_ui", &uiCpuLock) != ESP_OK) {
+        uiCpuLock = NULL;
+        return false;
+    }
+    powerActive();
+    return true;
+#else
+    Serial.println("CYD: power management not in this build (CONFIG_PM_ENABLE), CPU clock stays fixed.");
+    return false;
+#endif
+}
+
+void powerActive() {
+#if CONFIG_PM_ENABLE
+    if (uiCpuLock != NULL && !uiCpuLockHeld) {
+        esp_pm_lock_acquire(uiCpuLock);
+        uiCpuLockHeld = true;
+    }
+#endif
+}
+
+void powerIdle() {
+#if CONFIG_PM_ENABLE
+    if (uiCpuLock != NULL && uiCpuLockHeld) {
+        esp_pm_lock_release(uiCpuLock);
+        uiCpuLockHeld = false;
+    }
+#endif
+}
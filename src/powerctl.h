@@ -0,0 +1,37 @@
+#ifndef POWERCTL_H_
+#define POWERCTL_H_
+
+#include <stdint.h>
+
+/* powerctl.h - CPU frequency scaling for the CYD idle state.
+ * Uses ESP-IDF power management locks: the UI holds a CPU_FREQ_MAX lock
+ * while the screen is in use and releases it when the panel sleeps, so the
+ * DFS governor can scale down. The governor itself belongs to the
+ * application: esp_pm_configure() is only called here when the project
+ * opts in with CYD_PM_CONFIGURE=1. Compiles to no-ops when the framework is
+ * built without CONFIG_PM_ENABLE (stock Arduino-ESP32 builds). */
+
+#ifndef CYD_PM_CONFIGURE
+#define CYD_PM_CONFIGURE 0 /**< 1: powerBegin() sets up DFS with the limits below */
+#endif
+#ifndef CYD_PM_MAX_MHZ
+#define CYD_PM_MAX_MHZ 240 /**< CPU clock while the UI is active */
+#endif
+#ifndef CYD_PM_MIN_MHZ
+#define CYD_PM_MIN_MHZ 80  /**< Lowest CPU clock while idle (keeps APB at 80 MHz) */
+#endif
+
+/**
+ * @brief Takes the UI's max-frequency lock, after configuring dynamic
+ *        frequency scaling if CYD_PM_CONFIGURE is set.
+ * @return true if power management is available.
+ */
+bool powerBegin();
+
+/** @brief UI in use: hold the CPU at CYD_PM_MAX_MHZ. */
+void powerActive();
+
+/** @brief UI idle: let the CPU scale down (other locks, e.g. WiFi or TWAI, still apply). */
+void powerIdle();
+
+#endif /* END POWERCTL_H_ */
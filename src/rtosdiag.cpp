@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <string.h>
+#include "rtosdiag.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#endif
+
+/* rtosdiag.cpp */
+
+static const char* const diagCounterNames[DIAG_COUNTER_COUNT] = {
+    "touch full", "node drop", "state drop", "spi wait", "xfer wait"
+};
+
+const char* diagCounterName(uint8_t id) {
+    return (id < DIAG_COUNTER_COUNT) ? diagCounterNames[id] : "?";
+}
+
+DiagAggregator::DiagAggregator()
+    : _taskCount(0), _queueCount(0), _lastTotalRunTime(0), _samples(0), _hasRunTime(false) {
+    memset(_counterTotal, 0, sizeof(_counterTotal));
+}
+
+int DiagAggregator::addQueue(const char* name, uint16_t capacity) {
+    if (_queueCount == DIAG_MAX_QUEUES) return -1;
+    DiagQueue& q = _queues[_queueCount];
+    q.name = name;
+    q.capacity = capacity;
+    q.peak = 0;
+    return _queueCount++;
+}
+
+int DiagAggregator::findTask(const char* name) const {
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (strncmp(_tasks[i].name, name, DIAG_NAME_LEN - 1) == 0) return i;
+    }
+    return -1;
+}
+
+void DiagAggregator::sample(const DiagTaskInput* tasks, uint8_t taskCount, uint32_t totalRunTime,
+                            const uint16_t* queueFill, const uint32_t* counters) {
+    const uint32_t dTotal = totalRunTime - _lastTotalRunTime;
+    const bool haveBase = (_samples > 0 && totalRunTime != 0 && dTotal != 0);
+    if (totalRunTime != 0) _hasRunTime = true;
+
+    uint32_t wasPresent = 0; /* a task missing last time has no usable run-time base */
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (_tasks[i].present) wasPresent |= (1UL << i);
+        _tasks[i].present = false;
+    }
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const DiagTaskInput& in = tasks[i];
+        int idx = findTask(in.name);
+        bool fresh = false;
+        if (idx >= 0 && !(wasPresent & (1UL << idx))) fresh = true;
+
+        if (idx < 0) {
+            if (_taskCount == DIAG_MAX_TASKS) continue;
+            idx = _taskCount++;
+            DiagTask& t = _tasks[idx];
+            strncpy(t.name, in.name, DIAG_NAME_LEN - 1);
+            t.name[DIAG_NAME_LEN - 1] = '\0';
+            t.stackFree = in.stackFree;
+            t.cpu = DiagRing<uint16_t>();
+            fresh = true;
+        }
+
+        DiagTask& t = _tasks[idx];
+        t.present = true;
+        t.core = in.core;
+        if (in.stackFree < t.stackFree) t.stackFree = in.stackFree;
+
+        /* CPU share needs a previous counter for this task; a new task starts next sample */
+        if (haveBase && !fresh) {
+            uint32_t permille = (uint32_t)((uint64_t)(in.runTime - t.lastRunTime) * 1000 / dTotal);
+            t.cpu.push((uint16_t)((permille > 1000) ? 1000 : permille));
+        }
+        t.lastRunTime = in.runTime;
+    }
+
+    for (uint8_t q = 0; q < _queueCount; q++) {
+        const uint16_t fill = queueFill ? queueFill[q] : 0;
+        _queues[q].fill.push((uint8_t)((fill > 255) ? 255 : fill));
+        if (fill > _queues[q].peak) _queues[q].peak = fill;
+    }
+
+    for (uint8_t c = 0; c < DIAG_COUNTER_COUNT; c++) {
+        const uint32_t now = counters ? counters[c] : 0;
+        const uint32_t delta = now - _counterTotal[c];
+        _counterDelta[c].push((uint16_t)((delta > 0xFFFF) ? 0xFFFF : delta));
+        _counterTotal[c] = now;
+    }
+
+    _lastTotalRunTime = totalRunTime;
+    _samples++;
+}
+
+int DiagAggregator::tightestStack() const {
+    int best = -1;
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        if (!_tasks[i].present) continue;
+        if (best < 0 || _tasks[i].stackFree < _tasks[best].stackFree) best = i;
+    }
+    return best;
+}
+
+void DiagAggregator::report(void (*line)(const char* text, void* ctx), void* ctx) const {
+    char buf[96];
+
+    for (uint8_t i = 0; i < _taskCount; i++) {
+        const DiagTask& t = _tasks[i];
+        if (!t.present) continue;
+
+        char core = (t.core < 0) ? '-' : (char)('0' + t.core);
+        if (_hasRunTime && t.cpu.size() > 0) {
+            const uint16_t now = t.cpu.latest();
+            const uint32_t avg = t.cpu.mean();
+            snprintf(buf, sizeof(buf), "task %-15s core %c cpu %3u.%u%% avg %3lu.%lu%% peak %3u.%u%% stack free %lu",
+                     t.name, core, now / 10, now % 10, (unsigned long)(avg / 10), (unsigned long)(avg % 10),
+                     t.cpu.max() / 10, t.cpu.max() % 10, (unsigned long)t.stackFree);
+        } else {
+            snprintf(buf, sizeof(buf), "task %-15s core %c stack free %lu", t.name, core, (unsigned long)t.stackFree);
+        }
+        line(buf, ctx);
+    }
+
+    for (uint8_t q = 0; q < _queueCount; q++) {
+        const DiagQueue& dq = _queues[q];
+        snprintf(buf, sizeof(buf), "queue %-10s %u/%u peak %u", dq.name,
+                 dq.fill.latest(), dq.capacity, dq.peak);
+        line(buf, ctx);
+    }
+
+    for (uint8_t c = 0; c < DIAG_COUNTER_COUNT; c++) {
+        snprintf(buf, sizeof(buf), "count %-10s %lu (+%u last sample)", diagCounterName(c),
+                 (unsigned long)_counterTotal[c], _counterDelta[c].latest());
+        line(buf, ctx);
+    }
+}
+
+#if defined(ARDUINO)
+#define DIAG_SYSTEM_TASKS 28 /**< uxTaskGetSystemState() fails if the array is too small */
+#define DIAG_WATCH_TASKS  4
+
+DiagCounters diagCounters;
+DiagAggregator diagHistory;
+
+static QueueHandle_t diagQueues[DIAG_MAX_QUEUES];
+static TaskHandle_t diagTasks[DIAG_WATCH_TASKS];
+static uint8_t diagTaskCount = 0;
+
+int diagWatchQueue(void* queue, const char* name, uint16_t capacity) {
+    int idx = diagHistory.addQueue(name, capacity);
+    if (idx >= 0) diagQueues[idx] = (QueueHandle_t)queue;
+    return idx;
+}
+
+void diagWatchTask(void* task) {
+    if (task != NULL && diagTaskCount < DIAG_WATCH_TASKS) diagTasks[diagTaskCount++] = (TaskHandle_t)task;
+}
+
+void diagSample() {
+    static DiagTaskInput in[DIAG_SYSTEM_TASKS];
+    uint8_t n = 0;
+    uint32_t total = 0;
+
+#if (configUSE_TRACE_FACILITY == 1)
+    static TaskStatus_t status[DIAG_SYSTEM_TASKS]; /* static: about 1 KB, sampled once a second */
+    UBaseType_t count = uxTaskGetSystemState(status, DIAG_SYSTEM_TASKS, &total);
+    for (UBaseType_t i = 0; i < count; i++) {
+        in[n].name = status[i].pcTaskName;
+        in[n].runTime = status[i].ulRunTimeCounter;
+        in[n].stackFree = status[i].usStackHighWaterMark; /* bytes on the ESP32 */
+#if defined(CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID)
+        in[n].core = (status[i].xCoreID == tskNO_AFFINITY) ? -1 : (int8_t)status[i].xCoreID;
+#else
+        in[n].core = -1;
+#endif
+        n++;
+    }
+#if (configGENERATE_RUN_TIME_STATS != 1)
+    total = 0;
+#endif
+#endif
+
+    /* No task list: at least the watched tasks' stacks */
+    if (n == 0) {
+        for (uint8_t i = 0; i < diagTaskCount; i++) {
+            in[n].name = pcTaskGetName(diagTasks[i]);
+            in[n].runTime = 0;
+            in[n].stackFree = uxTaskGetStackHighWaterMark(diagTasks[i]);
+            in[n].core = -1;
+            n++;
+        }
+        total = 0;
+    }
+
+    uint16_t fill[DIAG_MAX_QUEUES];
+    for (uint8_t q = 0; q < diagHistory.queueCount(); q++) {
+        fill[q] = (uint16_t)uxQueueMessagesWaiting(diagQueues[q]);
+    }
+
+    uint32_t counters[DIAG_COUNTER_COUNT];
+    for (uint8_t c = 0; c < DIAG_COUNTER_COUNT; c++) counters[c] = diagCounters.total(c);
+
+    diagHistory.sample(in, n, total, fill, counters);
+}
+
+static void diagSerialLine(const char* text, void* ctx) {
+    (void)ctx;
+    Serial.printf("CYD: diag %s\n", text);
+}
+
+void diagReport() {
+    diagHistory.report(diagSerialLine, NULL);
+}
+#endif
@@ -0,0 +1,210 @@
+#ifndef RTOSDIAG_H_
+#define RTOSDIAG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/* rtosdiag.h - task, queue and lock health history.
+ *
+ * Once per sample the owner feeds cumulative figures: each task's run-time
+ * counter and free stack, each watched queue's fill level, and the running
+ * totals of the event counters below. DiagAggregator turns them into
+ * per-sample values (CPU permille of one core, queue fill, counter deltas)
+ * kept in small fixed rings, plus lifetime extremes (lowest free stack,
+ * highest fill). It never calls the RTOS itself, so the aggregation can be
+ * driven from a host with made-up task tables.
+ *
+ * Counters are bumped from any task with one relaxed atomic add.
+ */
+
+#define DIAG_HISTORY     32 /**< Samples kept per ring */
+#define DIAG_MAX_TASKS   16 /**< Tasks tracked (at most 32); later ones are ignored */
+#define DIAG_MAX_QUEUES  4
+#define DIAG_NAME_LEN    16 /**< configMAX_TASK_NAME_LEN on the ESP32 */
+
+/** --- Event counters --- */
+enum DiagCounterId { DIAG_TOUCH_QUEUE_FULL = 0, /**< Touch dropped, touchQueue full */
+                     DIAG_NODE_EVENT_DROP,      /**< Node event dropped, ring full */
+                     DIAG_STATE_EVENT_DROP,     /**< Switch state dropped, ring full */
+                     DIAG_SPI_TIMEOUT,          /**< spiSemaphore not obtained in time */
+                     DIAG_XFER_LOCK_TIMEOUT,    /**< keypadXferMutex not obtained in time */
+                     DIAG_COUNTER_COUNT
+                   };
+
+/** @brief Short name of a counter for reports */
+const char* diagCounterName(uint8_t id);
+
+/**
+ * @class DiagCounters
+ * @brief Lifetime event totals, safe to bump from any task
+ */
+class DiagCounters {
+public:
+    DiagCounters() { for (uint8_t i = 0; i < DIAG_COUNTER_COUNT; i++) _n[i].store(0); }
+    void add(DiagCounterId id) { _n[id].fetch_add(1, std::memory_order_relaxed); }
+    uint32_t total(uint8_t id) const { return _n[id].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> _n[DIAG_COUNTER_COUNT];
+};
+
+/**
+ * @class DiagRing
+ * @brief Last DIAG_HISTORY values, oldest overwritten
+ */
+template <typename T>
+class DiagRing {
+public:
+    DiagRing() : _head(0), _count(0) {}
+
+    void push(T v) {
+        _v[_head] = v;
+        _head = (uint8_t)((_head + 1) % DIAG_HISTORY);
+        if (_count < DIAG_HISTORY) _count++;
+    }
+
+    uint8_t size() const { return _count; }
+
+    /** @brief i-th value, 0 = oldest */
+    T at(uint8_t i) const { return _v[(_head + DIAG_HISTORY - _count + i) % DIAG_HISTORY]; }
+    T latest() const { return _count ? at(_count - 1) : 0; }
+
+    T max() const {
+        T m = 0;
+        for (uint8_t i = 0; i < _count; i++) if (at(i) > m) m = at(i);
+        return m;
+    }
+
+    uint32_t mean() const {
+        if (_count == 0) return 0;
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < _count; i++) sum += at(i);
+        return sum / _count;
+    }
+
+private:
+    T       _v[DIAG_HISTORY];
+    uint8_t _head;
+    uint8_t _count;
+};
+
+/**
+ * @struct DiagTaskInput
+ * @brief One task as reported by the RTOS for a sample
+ */
+struct DiagTaskInput {
+    const char* name;
+    uint32_t    runTime;    /**< Cumulative run-time counter, 0 if not available */
+    uint32_t    stackFree;  /**< Stack high-water mark: least free stack so far, bytes */
+    int8_t      core;       /**< Pinned core, -1 if unpinned */
+};
+
+/**
+ * @struct DiagTask
+ * @brief History of one task
+ */
+struct DiagTask {
+    char     name[DIAG_NAME_LEN];
+    int8_t   core;
+    bool     present;       /**< Seen in the latest sample */
+    uint32_t lastRunTime;
+    uint32_t stackFree;     /**< Lowest high-water mark seen */
+    DiagRing<uint16_t> cpu; /**< Permille of one core per sample */
+};
+
+/**
+ * @struct DiagQueue
+ * @brief History of one watched queue
+ */
+struct DiagQueue {
+    const char* name;
+    uint16_t    capacity;
+    uint16_t    peak;        /**< Highest fill seen */
+    DiagRing<uint8_t> fill;  /**< Items waiting at each sample */
+};
+
+/**
+ * @class DiagAggregator
+ * @brief Turns cumulative RTOS figures into per-sample history
+ */
+class DiagAggregator {
+public:
+    DiagAggregator();
+
+    /** @brief Watches a queue; returns its index for sample(), -1 if full. */
+    int addQueue(const char* name, uint16_t capacity);
+
+    /**
+     * @brief Records one sample.
+     * @param tasks Current task list, any order
+     * @param totalRunTime Cumulative run-time counter of one core (time base of runTime)
+     * @param queueFill Items waiting, one per addQueue() index
+     * @param counters Current DiagCounters totals, DIAG_COUNTER_COUNT entries
+     */
+    void sample(const DiagTaskInput* tasks, uint8_t taskCount, uint32_t totalRunTime,
+                const uint16_t* queueFill, const uint32_t* counters);
+
+    uint32_t samples() const { return _samples; }
+    bool hasRunTime() const { return _hasRunTime; }
+
+    uint8_t taskCount() const { return _taskCount; }
+    const DiagTask& task(uint8_t i) const { return _tasks[i]; }
+
+    uint8_t queueCount() const { return _queueCount; }
+    const DiagQueue& queue(uint8_t i) const { return _queues[i]; }
+
+    /** --- Counters: lifetime total and the per-sample increments --- */
+    uint32_t counterTotal(uint8_t id) const { return _counterTotal[id]; }
+    const DiagRing<uint16_t>& counterHistory(uint8_t id) const { return _counterDelta[id]; }
+
+    /** @brief Index of the present task with the least free stack, -1 if none */
+    int tightestStack() const;
+
+    /**
+     * @brief One line per task, queue and counter.
+     * @param line Called with each NUL-terminated line
+     */
+    void report(void (*line)(const char* text, void* ctx), void* ctx) const;
+
+private:
+    int findTask(const char* name) const;
+
+    DiagTask  _tasks[DIAG_MAX_TASKS];
+    uint8_t   _taskCount;
+    DiagQueue _queues[DIAG_MAX_QUEUES];
+    uint8_t   _queueCount;
+
+    uint32_t  _counterTotal[DIAG_COUNTER_COUNT];
+    DiagRing<uint16_t> _counterDelta[DIAG_COUNTER_COUNT];
+
+    uint32_t  _lastTotalRunTime;
+    uint32_t  _samples;
+    bool      _hasRunTime;
+};
+
+#if defined(ARDUINO)
+extern DiagCounters diagCounters;
+extern DiagAggregator diagHistory;
+
+/**
+ * @brief Watches a FreeRTOS queue (fill level per sample).
+ * @return Index into diagHistory.queue(), -1 if the table is full.
+ */
+int diagWatchQueue(void* queue, const char* name, uint16_t capacity);
+
+/** @brief Task sampled when the trace facility (full task list) is not available. */
+void diagWatchTask(void* task);
+
+/**
+ * @brief Takes one sample of every task, the watched queues and the counters.
+ * @details One uxTaskGetSystemState() call (scheduler suspended for its duration);
+ *          without the trace facility only the UI tasks' stacks are sampled.
+ */
+void diagSample();
+
+/** @brief Writes the latest sample to Serial. */
+void diagReport();
+#endif
+
+#endif /* END RTOSDIAG_H_ */
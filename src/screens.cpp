@@ -0,0 +1,54 @@
+#include <stddef.h>
+#include "screens.h"
+
+/* screens.cpp */
+
+ScreenWork screenWorkFor(const ScreenDef& def, uint32_t events, uint32_t now, uint32_t lastTick) {
+    if (def.refreshMs != 0 && (now - lastTick) >= def.refreshMs) return SCREEN_WORK_TICK;
+    if (events & (def.dirtyOn | UI_EVT_SCREEN)) return SCREEN_WORK_UPDATE;
+    if (events & UI_EVT_HEADER) return SCREEN_WORK_HEADER;
+    return SCREEN_WORK_NONE;
+}
+
+ScreenNav::ScreenNav(const ScreenDef* table, uint8_t count)
+    : _table(table), _count(count), _depth(0) {}
+
+const ScreenDef* ScreenNav::find(uint8_t id) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_table[i].id == id) return &_table[i];
+    }
+    return NULL;
+}
+
+bool ScreenNav::reset(uint8_t id) {
+    if (find(id) == NULL) return false;
+    _stack[0] = id;
+    _depth = 1;
+    return true;
+}
+
+bool ScreenNav::push(uint8_t id) {
+    if (find(id) == NULL) return false;
+    if (_depth > 0 && _stack[_depth - 1] == id) return true; /* already there */
+
+    if (_depth == SCREEN_NAV_DEPTH) {
+        /* Full: drop the oldest entry above the root */
+        for (uint8_t i = 1; i < SCREEN_NAV_DEPTH - 1; i++) _stack[i] = _stack[i + 1];
+        _depth--;
+    }
+    _stack[_depth++] = id;
+    return true;
+}
+
+bool ScreenNav::replace(uint8_t id) {
+    if (_depth == 0) return reset(id);
+    if (find(id) == NULL) return false;
+    _stack[_depth - 1] = id;
+    return true;
+}
+
+bool ScreenNav::back() {
+    if (_depth <= 1) return false;
+    _depth--;
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef SCREENS_H_
+#define SCREENS_H_
+
+#include <stdint.h>
+
+/* screens.h - table-driven screen registry, navigation stack and refresh policy.
+ * The registry only holds hooks and policy; drawing lives with the screens
+ * in espcyd.cpp. No Arduino dependency. */
+
+/** --- Data events; a screen's dirtyOn mask selects the ones it repaints for --- */
+#define UI_EVT_NODES     (1UL << 0) /**< Node table changed (added, timed out, colour) */
+#define UI_EVT_SELECTION (1UL << 1) /**< Selected target node changed */
+#define UI_EVT_NETWORK   (1UL << 2) /**< IP address or WiFi state changed */
+#define UI_EVT_SCREEN    (1UL << 3) /**< Panel shows another screen (returned via back): repaint the body from state */
+#define UI_EVT_LAYOUT    (1UL << 4) /**< Keypad layout or page changed */
+#define UI_EVT_LIST      (1UL << 5) /**< Node list order, page, sort or filter changed */
+#define UI_EVT_STATE     (1UL << 6) /**< A switch state shown on the keypad changed */
+#define UI_EVT_CLOCK     (1UL << 7) /**< Displayed second or clock sync state changed */
+#define UI_EVT_EFFECT    (1UL << 8) /**< Effect editor settings changed */
+#define UI_EVT_ALL       (0xFFFFFFFFUL)
+
+/** Events that change the shared header (selected node label) on every screen */
+#define UI_EVT_HEADER    (UI_EVT_NODES | UI_EVT_SELECTION)
+
+#define SCREEN_NAV_DEPTH 6 /**< Maximum depth of the back stack */
+
+/**
+ * @struct ScreenDef
+ * @brief One registered screen. Unused hooks are NULL.
+ */
+struct ScreenDef {
+    uint8_t     id;          /**< Screen identifier (DisplayMode) */
+    const char* title;       /**< Header title */
+    void (*onEnter)();       /**< Called when pushed/replaced onto the stack, before draw; not on back */
+    bool (*onTouch)(int x, int y); /**< Content-area touch; true if it was consumed */
+    void (*onTick)(uint32_t now);  /**< Called every refreshMs while the screen is current; NULL = draw() */
+    void (*draw)();          /**< Full repaint */
+    void (*update)(uint32_t events); /**< Partial repaint for dirty events and UI_EVT_SCREEN; NULL = draw() */
+    uint16_t    refreshMs;   /**< Periodic onTick/redraw interval, 0 = none */
+    uint32_t    dirtyOn;     /**< UI_EVT_* that require this screen to repaint its body */
+};
+
+/** --- What the scheduler has to do for the current screen --- */
+enum ScreenWork { SCREEN_WORK_NONE = 0,
+                  SCREEN_WORK_HEADER,  /**< Only the shared header is stale */
+                  SCREEN_WORK_UPDATE,  /**< Body events pending, partial repaint */
+                  SCREEN_WORK_TICK     /**< Refresh interval elapsed */
+                };
+
+/**
+ * @brief Decides the work a screen needs for the pending events.
+ * @param def Screen definition
+ * @param events Pending UI_EVT_* bits
+ * @param now Current time in ms
+ * @param lastTick Time of the last onTick/periodic redraw
+ */
+ScreenWork screenWorkFor(const ScreenDef& def, uint32_t events, uint32_t now, uint32_t lastTick);
+
+/**
+ * @class ScreenNav
+ * @brief Screen registry lookup plus back stack.
+ */
+class ScreenNav {
+public:
+    ScreenNav(const ScreenDef* table, uint8_t count);
+
+    /** @brief Finds a registered screen by id, NULL if unknown. */
+    const ScreenDef* find(uint8_t id) const;
+
+    /** @brief Clears the stack and makes id the root screen. */
+    bool reset(uint8_t id);
+
+    /** @brief Pushes a screen; the current one stays below it for back(). */
+    bool push(uint8_t id);
+
+    /** @brief Replaces the top of the stack (no back entry is kept). */
+    bool replace(uint8_t id);
+
+    /** @brief Pops back to the previous screen; false at the root. */
+    bool back();
+
+    const ScreenDef* current() const { return _depth ? find(_stack[_depth - 1]) : 0; }
+    uint8_t currentId() const { return _depth ? _stack[_depth - 1] : 0; }
+    uint8_t depth() const { return _depth; }
+
+private:
+    const ScreenDef* _table;
+    uint8_t _count;
+    uint8_t _stack[SCREEN_NAV_DEPTH];
+    uint8_t _depth;
+};
+
+#endif /* END SCREENS_H_ */
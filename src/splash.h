@@ -0,0 +1,112 @@
+#ifndef SPLASH_H_
+#define SPLASH_H_
+
+#include "imgasset.h"
+
+/* splash.h - generated by tools/gen_splash.py from a drawing, do not edit */
+
+#define SPLASH_WIDTH  160
+#define SPLASH_HEIGHT 80
+
+/** RGB565 palette, most used colour first */
+static const uint16_t splashPalette[7] = {
+    0x0000, 0xFFFF, 0x001F, 0x07E0, 0xFFE0, 0xF800, 0x7BEF,
+};
+
+/** Run-length coded palette indices, 160 x 80 pixels */
+static const uint8_t splashData[1440] = {
+    0xFF, 0x02, 0xFF, 0x02, 0xC1, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00,
+    0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00,
+    0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02,
+    0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00,
+    0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0x87, 0x00,
+    0xFF, 0x04, 0x8B, 0x04, 0x87, 0x00, 0x83, 0x02, 0x87, 0x00, 0xFF, 0x04, 0x8B, 0x04, 0x87, 0x00,
+    0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00,
+    0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0x87, 0x00, 0xFF, 0x01, 0x8B, 0x01,
+    0x87, 0x00, 0x83, 0x02, 0x87, 0x00, 0xFF, 0x01, 0x8B, 0x01, 0x87, 0x00, 0x83, 0x02, 0x99, 0x00,
+    0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x99, 0x00,
+    0x83, 0x02, 0x99, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00,
+    0x81, 0x06, 0x99, 0x00, 0x83, 0x02, 0x99, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00,
+    0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x99, 0x00, 0x83, 0x02, 0x99, 0x00, 0x81, 0x06, 0x9F, 0x00,
+    0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x99, 0x00, 0x83, 0x02, 0x99, 0x00,
+    0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x99, 0x00,
+    0x83, 0x02, 0x99, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00, 0x81, 0x06, 0x9F, 0x00,
+    0x81, 0x06, 0x99, 0x00, 0x83, 0x02, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x05, 0x93, 0x00,
+    0x8D, 0x03, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x83, 0x02, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00,
+    0x8D, 0x05, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x83, 0x02, 0x93, 0x00,
+    0x8D, 0x03, 0x93, 0x00, 0x8D, 0x05, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00,
+    0x83, 0x02, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x05, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00,
+    0x8D, 0x03, 0x93, 0x00, 0x83, 0x02, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x05, 0x93, 0x00,
+    0x8D, 0x03, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x83, 0x02, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00,
+    0x8D, 0x05, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x83, 0x02, 0x93, 0x00,
+    0x8D, 0x03, 0x93, 0x00, 0x8D, 0x05, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00,
+    0x83, 0x02, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00, 0x8D, 0x05, 0x93, 0x00, 0x8D, 0x03, 0x93, 0x00,
+    0x8D, 0x03, 0x93, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00,
+    0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00,
+    0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02,
+    0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0x92, 0x00, 0x88, 0x01, 0x88, 0x00, 0x88, 0x01, 0x85, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x97, 0x00, 0x88, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x8B, 0x01, 0x93, 0x00, 0x83, 0x02, 0x92, 0x00, 0x88, 0x01, 0x88, 0x00,
+    0x88, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x97, 0x00, 0x88, 0x01, 0x85, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x8B, 0x01, 0x93, 0x00, 0x83, 0x02, 0x92, 0x00,
+    0x88, 0x01, 0x88, 0x00, 0x88, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x97, 0x00,
+    0x88, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x8B, 0x01, 0x93, 0x00,
+    0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x85, 0x01, 0x85, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x85, 0x01, 0x85, 0x00, 0x82, 0x01, 0x94, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x85, 0x01, 0x85, 0x00,
+    0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00,
+    0x82, 0x01, 0x8E, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x91, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00,
+    0x82, 0x01, 0x8E, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x91, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00,
+    0x82, 0x01, 0x8E, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x91, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00,
+    0x82, 0x01, 0x8E, 0x00, 0x8E, 0x01, 0x82, 0x00, 0x82, 0x01, 0x85, 0x00, 0x85, 0x01, 0x94, 0x00,
+    0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00,
+    0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x8E, 0x00, 0x8E, 0x01, 0x82, 0x00, 0x82, 0x01, 0x85, 0x00,
+    0x85, 0x01, 0x94, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x8E, 0x00, 0x8E, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x85, 0x00, 0x85, 0x01, 0x94, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x8E, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x94, 0x00,
+    0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00,
+    0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x8E, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00, 0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x8E, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x94, 0x00,
+    0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00,
+    0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00,
+    0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00,
+    0x83, 0x02, 0x8F, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x94, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x90, 0x00,
+    0x83, 0x02, 0x92, 0x00, 0x88, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x97, 0x00, 0x88, 0x01, 0x8B, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x8B, 0x01, 0x93, 0x00, 0x83, 0x02, 0x92, 0x00, 0x88, 0x01, 0x85, 0x00, 0x82, 0x01, 0x88, 0x00,
+    0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x97, 0x00, 0x88, 0x01, 0x8B, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x8B, 0x01, 0x93, 0x00, 0x83, 0x02, 0x92, 0x00, 0x88, 0x01, 0x85, 0x00,
+    0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x82, 0x00, 0x82, 0x01, 0x88, 0x00, 0x82, 0x01, 0x97, 0x00,
+    0x88, 0x01, 0x8B, 0x00, 0x82, 0x01, 0x88, 0x00, 0x8B, 0x01, 0x93, 0x00, 0x83, 0x02, 0xFF, 0x00,
+    0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02,
+    0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00,
+    0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00,
+    0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02,
+    0xFF, 0x00, 0x9B, 0x00, 0x83, 0x02, 0xFF, 0x00, 0x9B, 0x00, 0xFF, 0x02, 0xFF, 0x02, 0xC1, 0x02,
+};
+
+static const ImgAsset splashAsset = { 160, 80, 7, splashPalette, splashData, 1440 };
+
+#endif /* END SPLASH_H_ */
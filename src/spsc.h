@@ -0,0 +1,118 @@
+#ifndef SPSC_H_
+#define SPSC_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/* spsc.h - lock-free single-producer/single-consumer channels.
+ * One task pushes, one task pops; neither ever blocks or takes a lock, so
+ * the CAN receive path cannot be held up by the UI (or the other way round).
+ * Ordering: the producer writes the slot, then publishes the new head with
+ * release; the consumer reads head with acquire before touching the slot,
+ * and hands the slot back by publishing tail with release. Header-only and
+ * free of FreeRTOS, so the same code runs under std::thread on a host. */
+
+/**
+ * @class SpscQueue
+ * @brief Bounded FIFO of T. N must be a power of two.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    SpscQueue() : _head(0), _tail(0) {}
+
+    /** @brief Producer side. @return false if the queue is full (value dropped). */
+    bool push(const T& value) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= N) return false;
+        _buf[head & (N - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Consumer side. @return false if the queue is empty. */
+    bool pop(T& out) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail) return false;
+        out = _buf[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Approximate fill level; exact when called by either end about its own side. */
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static size_t capacity() { return N; }
+
+private:
+    T _buf[N];
+    std::atomic<size_t> _head; /**< Next slot to write, owned by the producer */
+    std::atomic<size_t> _tail; /**< Next slot to read, owned by the consumer */
+};
+
+/**
+ * @class SpscLatest
+ * @brief Single-value channel: the consumer only ever wants the newest T.
+ * @details Sequence lock: the producer bumps seq to odd, writes, bumps to even.
+ *          The consumer retries a read that overlapped a write. Writes never wait.
+ *          The value is held as relaxed atomic words, so a read racing a write
+ *          sees stale or mixed words (then discarded by the seq check), never a
+ *          data race. T must be trivially copyable.
+ */
+template <typename T>
+class SpscLatest {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscLatest needs a trivially copyable T");
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+public:
+    SpscLatest() : _seq(0) {
+        for (size_t i = 0; i < WORDS; i++) _words[i].store(0, std::memory_order_relaxed);
+    }
+
+    /** @brief Producer side. */
+    void publish(const T& value) {
+        uint32_t w[WORDS] = {};
+        memcpy(w, &value, sizeof(T));
+
+        const uint32_t s = _seq.load(std::memory_order_relaxed);
+        _seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); /* odd seq before any word */
+        for (size_t i = 0; i < WORDS; i++) _words[i].store(w[i], std::memory_order_relaxed);
+        _seq.store(s + 2, std::memory_order_release);        /* words before even seq */
+    }
+
+    /**
+     * @brief Consumer side.
+     * @param out Newest value
+     * @param lastSeq In: sequence of the value already seen; out: sequence of out
+     * @return true if a newer value than lastSeq was read
+     */
+    bool read(T& out, uint32_t& lastSeq) const {
+        uint32_t w[WORDS];
+        for (;;) {
+            const uint32_t s1 = _seq.load(std::memory_order_acquire);
+            if (s1 == lastSeq) return false;
+            if (s1 & 1) continue; /* write in progress */
+            for (size_t i = 0; i < WORDS; i++) w[i] = _words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire); /* words before the re-check */
+            if (_seq.load(std::memory_order_relaxed) == s1) {
+                memcpy(&out, w, sizeof(T));
+                lastSeq = s1;
+                return true;
+            }
+        }
+    }
+
+private:
+    std::atomic<uint32_t> _words[WORDS];
+    std::atomic<uint32_t> _seq;
+};
+
+#endif /* END SPSC_H_ */
@@ -0,0 +1,144 @@
+#include <string.h>
+#include "statemodel.h"
+
+/* statemodel.cpp */
+
+uint8_t stateVisual(const StateValue& v) {
+    uint8_t step = 0;
+    if (v.level != 0) {
+        step = (uint8_t)(((uint16_t)v.level * 100 / 255 + 5) / 10); /* 0..10 */
+    }
+    return (uint8_t)((v.flags & 0x0F) | (step << 4));
+}
+
+bool decodeStatusFrame(const uint8_t* data, uint8_t dlc, uint8_t* key, StateValue* value) {
+    if (data == NULL || dlc < STATE_STATUS_MIN_DLC) return false;
+
+    *key = data[4];
+    value->flags = STATE_FLAG_KNOWN;
+    if (data[5] != 0) value->flags |= STATE_FLAG_ON;
+    if (dlc > 6 && (data[6] & 0x01)) value->flags |= STATE_FLAG_FAULT;
+    value->level = (dlc > 7) ? data[7] : 0;
+    return true;
+}
+
+StateGate::StateGate() : _passed(0), _dropped(0) {
+    memset(_last, 0, sizeof(_last));
+    for (uint8_t i = 0; i < STATE_KEYS / 32; i++) _expect[i].store(0, std::memory_order_relaxed);
+}
+
+bool StateGate::pass(uint8_t key, const StateValue& value) {
+    const uint8_t v = stateVisual(value);
+    const uint32_t bit = 1UL << (key & 31);
+    const bool expected = (_expect[key >> 5].load(std::memory_order_relaxed) & bit) &&
+                          (_expect[key >> 5].fetch_and(~bit, std::memory_order_relaxed) & bit);
+    if (_last[key] == v && !expected) {
+        _dropped++;
+        return false;
+    }
+    _last[key] = v;
+    _passed++;
+    return true;
+}
+
+StateModel::StateModel()
+    : _widgets(0), _dirty(0), _pendingCount(0), _nextDeadline(0), _changes(0), _suppressed(0) {
+    memset(_slots, 0, sizeof(_slots));
+    memset(_widgetKey, 0, sizeof(_widgetKey));
+}
+
+void StateModel::clearSubscriptions() {
+    _widgets = 0;
+    _dirty = 0;
+}
+
+bool StateModel::subscribe(uint8_t widget, uint8_t key) {
+    if (widget >= STATE_MAX_WIDGETS) return false;
+    _widgetKey[widget] = key;
+    _widgets |= (1UL << widget);
+    return true;
+}
+
+bool StateModel::store(uint8_t key, const StateValue& value) {
+    const bool changed = stateVisual(_slots[key]) != stateVisual(value);
+    _slots[key] = value;
+    if (!changed) {
+        _suppressed++;
+        return false;
+    }
+    _changes++;
+
+    /* Only the current page subscribes, so this is a handful of compares */
+    bool repaint = false;
+    for (uint32_t w = _widgets, i = 0; w != 0; w >>= 1, i++) {
+        if ((w & 1) && _widgetKey[i] == key) {
+            _dirty |= (1UL << i);
+            repaint = true;
+        }
+    }
+    return repaint;
+}
+
+void StateModel::dropPending(uint8_t key) {
+    for (uint8_t i = 0; i < _pendingCount; i++) {
+        if (_pendingKey[i] != key) continue;
+        _pendingCount--;
+        _pendingKey[i] = _pendingKey[_pendingCount];
+        _pendingUntil[i] = _pendingUntil[_pendingCount];
+        return;
+    }
+}
+
+bool StateModel::apply(uint8_t key, const StateValue& value) {
+    if (_slots[key].flags & STATE_FLAG_PENDING) dropPending(key);
+
+    StateValue v = value;
+    v.flags = (uint8_t)((v.flags | STATE_FLAG_KNOWN) & ~STATE_FLAG_PENDING);
+    return store(key, v);
+}
+
+bool StateModel::setPending(uint8_t key, uint32_t now, uint32_t timeoutMs) {
+    const uint32_t until = now + timeoutMs;
+
+    if (_slots[key].flags & STATE_FLAG_PENDING) {
+        /* Pressed again while waiting: extend the deadline */
+        for (uint8_t i = 0; i < _pendingCount; i++) {
+            if (_pendingKey[i] == key) _pendingUntil[i] = until;
+        }
+        return false;
+    }
+    if (_pendingCount == STATE_MAX_PENDING) return false; /* shown as a plain press */
+
+    _pendingKey[_pendingCount] = key;
+    _pendingUntil[_pendingCount] = until;
+    if (_pendingCount == 0 || (int32_t)(until - _nextDeadline) < 0) _nextDeadline = until;
+    _pendingCount++;
+
+    StateValue v = _slots[key];
+    v.flags |= STATE_FLAG_PENDING;
+    return store(key, v);
+}
+
+void StateModel::service(uint32_t now) {
+    if (_pendingCount == 0 || (int32_t)(now - _nextDeadline) < 0) return;
+
+    uint8_t i = 0;
+    while (i < _pendingCount) {
+        if ((int32_t)(now - _pendingUntil[i]) < 0) {
+            i++;
+            continue;
+        }
+        /* No status change arrived: fall back to the last reported state */
+        StateValue v = _slots[_pendingKey[i]];
+        v.flags &= ~STATE_FLAG_PENDING;
+        store(_pendingKey[i], v);
+
+        _pendingCount--;
+        _pendingKey[i] = _pendingKey[_pendingCount];
+        _pendingUntil[i] = _pendingUntil[_pendingCount];
+    }
+
+    for (i = 0; i < _pendingCount; i++) {
+        if (i == 0 || (int32_t)(_pendingUntil[i] - _nextDeadline) < 0) _nextDeadline = _pendingUntil[i];
+    }
+}
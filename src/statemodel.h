@@ -0,0 +1,157 @@
+#ifndef STATEMODEL_H_
+#define STATEMODEL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/* statemodel.h - observed switch state for stateful keypad buttons.
+ *
+ * Nodes report the state of their switched outputs in status frames:
+ *
+ *   STATUS [0..3]=reporting node ID [4]=switch number [5]=on (0/1)
+ *          [6]=flags (bit 0 fault) [7]=level, 0..255 (optional, 0 = not dimmable)
+ *
+ * The switch number is the state key, the same byte a button sends as the
+ * first payload byte after the node ID prefix. Every key has a slot holding
+ * the last reported value plus a local "pending" mark set when the button is
+ * pressed. Widgets (the buttons of the current keypad page) subscribe to a
+ * key; a slot change marks exactly its subscribers dirty.
+ *
+ * Everything is compared on the rendered projection, stateVisual(): a frame
+ * that would draw the same button (a repeat, or a level change inside the
+ * same 10 % step) changes nothing. StateGate applies the same test in the
+ * CAN receive task, so repeated status frames are dropped there with one
+ * table lookup and never cross to the display task. A press opens the gate
+ * for its key (expect()), so the echo clears the pending mark even when the
+ * switch did not change. No Arduino dependency.
+ */
+
+#define STATE_KEYS          256 /**< One slot per switch number */
+#define STATE_MAX_WIDGETS   32  /**< Subscribers, bounded by the dirty mask */
+#define STATE_MAX_PENDING   8   /**< Presses awaiting a status change at once */
+
+/** --- StateValue flags, also bits 0..3 of the rendered projection --- */
+#define STATE_FLAG_ON       (1 << 0) /**< Output is on (latched) */
+#define STATE_FLAG_FAULT    (1 << 1) /**< Node reports a fault on the output */
+#define STATE_FLAG_PENDING  (1 << 2) /**< Pressed here, no status change seen yet */
+#define STATE_FLAG_KNOWN    (1 << 3) /**< At least one status frame received */
+
+#define STATE_STATUS_MIN_DLC 6
+
+/**
+ * @struct StateValue
+ * @brief Typed content of one state slot
+ */
+struct StateValue {
+    uint8_t flags; /**< STATE_FLAG_* */
+    uint8_t level; /**< 0..255 for dimmable outputs, 0 otherwise */
+};
+
+/**
+ * @brief What a widget draws for v: flags in bits 0..3, level in 10 % steps in bits 4..7.
+ */
+uint8_t stateVisual(const StateValue& v);
+
+/** @brief Level step 0..10 from a rendered projection (0 = no level shown). */
+inline uint8_t stateVisualLevel(uint8_t visual) { return visual >> 4; }
+
+/**
+ * @brief Parses a status frame.
+ * @return false if the frame is too short.
+ */
+bool decodeStatusFrame(const uint8_t* data, uint8_t dlc, uint8_t* key, StateValue* value);
+
+/**
+ * @class StateGate
+ * @brief Receive-side filter: passes a status only if it renders differently
+ *        from the last one passed for the same key, or if one is expected.
+ */
+class StateGate {
+public:
+    StateGate();
+
+    /** @brief Receive task: whether the status goes on to the model. */
+    bool pass(uint8_t key, const StateValue& value);
+
+    /** @brief Receive task: lets the next status for key through, e.g. after it could not be forwarded. */
+    void forget(uint8_t key) { _last[key] = 0; }
+
+    /**
+     * @brief Any task: the next status for key answers a press and passes even if unchanged.
+     * @details Call before the press is sent, so the echo cannot overtake it.
+     */
+    void expect(uint8_t key) {
+        _expect[key >> 5].fetch_or(1UL << (key & 31), std::memory_order_relaxed);
+    }
+
+    uint32_t passed() const { return _passed; }
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    uint8_t  _last[STATE_KEYS]; /**< Last visual passed, 0 = none (KNOWN is always set) */
+    std::atomic<uint32_t> _expect[STATE_KEYS / 32]; /**< Bit per key awaiting a press echo */
+    uint32_t _passed;
+    uint32_t _dropped;
+};
+
+/**
+ * @class StateModel
+ * @brief State slots, widget subscriptions and dirty widgets. Single task.
+ */
+class StateModel {
+public:
+    StateModel();
+
+    /** --- Subscriptions; widget is an index below STATE_MAX_WIDGETS --- */
+    void clearSubscriptions();
+    bool subscribe(uint8_t widget, uint8_t key);
+
+    /**
+     * @brief Applies a reported status; clears a pending press on the key.
+     * @return true if a subscriber has to repaint.
+     */
+    bool apply(uint8_t key, const StateValue& value);
+
+    /**
+     * @brief Marks key pending after a press, until a status arrives or timeoutMs passes.
+     * @return true if a subscriber has to repaint.
+     */
+    bool setPending(uint8_t key, uint32_t now, uint32_t timeoutMs);
+
+    /**
+     * @brief Expires pending presses. Returns at once unless a deadline is due.
+     */
+    void service(uint32_t now);
+
+    StateValue value(uint8_t key) const { return _slots[key]; }
+    uint8_t visual(uint8_t key) const { return stateVisual(_slots[key]); }
+
+    /** @brief Widgets whose key rendered differently since the last call. */
+    uint32_t takeDirtyWidgets() { uint32_t d = _dirty; _dirty = 0; return d; }
+
+    /** @brief Forces a repaint of widget, e.g. after drawing over it. */
+    void invalidate(uint8_t widget) { if (widget < STATE_MAX_WIDGETS) _dirty |= (1UL << widget); }
+
+    uint32_t changes() const { return _changes; }
+    uint32_t suppressed() const { return _suppressed; }
+
+private:
+    bool store(uint8_t key, const StateValue& value);
+    void dropPending(uint8_t key);
+
+    StateValue _slots[STATE_KEYS];
+    uint8_t    _widgetKey[STATE_MAX_WIDGETS];
+    uint32_t   _widgets;        /**< Bit per subscribed widget */
+    uint32_t   _dirty;
+
+    uint8_t    _pendingKey[STATE_MAX_PENDING];
+    uint32_t   _pendingUntil[STATE_MAX_PENDING];
+    uint8_t    _pendingCount;
+    uint32_t   _nextDeadline;   /**< Earliest _pendingUntil, valid if _pendingCount */
+
+    uint32_t   _changes;
+    uint32_t   _suppressed;
+};
+
+#endif /* END STATEMODEL_H_ */
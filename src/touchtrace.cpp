@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <string.h>
+#include "touchtrace.h"
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include "powerctl.h"
+#endif
+
+/* touchtrace.cpp */
+
+static const char* const traceStageNames[TRACE_STAGE_COUNT] = {
+    "total", "queue", "dequeue", "dispatch", "send", "ack"
+};
+
+void TraceRing::clear() {
+    memset(_recs, 0, sizeof(_recs));
+}
+
+uint16_t TraceRing::begin(uint32_t now) {
+    uint16_t id = _nextId++;
+    if (_nextId == 0) _nextId = 1; /* 0 means "not traced" */
+
+    TraceRecord& r = _recs[id & (TRACE_RING_SIZE - 1)];
+    r.id = id;
+    r.t[TRACE_TOUCH] = now;
+    r.mask = (1 << TRACE_TOUCH);
+    return id;
+}
+
+uint32_t TraceRing::percentile(uint32_t* v, uint8_t n, uint8_t pct) {
+    if (n == 0) return 0;
+
+    /* Insertion sort: n is at most TRACE_RING_SIZE */
+    for (uint8_t i = 1; i < n; i++) {
+        uint32_t key = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > key) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = key;
+    }
+    uint16_t rank = (uint16_t)((n * pct + 99) / 100);
+    if (rank == 0) rank = 1;
+    return v[rank - 1];
+}
+
+void TraceRing::summarize(TraceStat* out, uint32_t ticksPerUs) const {
+    uint32_t samples[TRACE_RING_SIZE];
+    if (ticksPerUs == 0) ticksPerUs = 1;
+
+    for (int s = 0; s < TRACE_STAGE_COUNT; s++) {
+        uint8_t n = 0;
+        for (int i = 0; i < TRACE_RING_SIZE; i++) {
+            const TraceRecord& r = _recs[i];
+            if (r.id == 0) continue;
+
+            if (s == TRACE_STAT_TOTAL) {
+                const uint8_t need = (1 << TRACE_TOUCH) | (1 << TRACE_SENT);
+                if ((r.mask & need) == need) samples[n++] = r.t[TRACE_SENT] - r.t[TRACE_TOUCH];
+                continue;
+            }
+            if (!(r.mask & (1 << s))) continue;
+
+            /* Delta from the closest earlier stage that was recorded */
+            int p = s - 1;
+            while (p >= 0 && !(r.mask & (1 << p))) p--;
+            if (p >= 0) samples[n++] = r.t[s] - r.t[p];
+        }
+        out[s].count = n;
+        out[s].p50Us = percentile(samples, n, 50) / ticksPerUs;
+        out[s].p99Us = percentile(samples, n, 99) / ticksPerUs;
+    }
+}
+
+size_t TraceRing::format(char* buf, size_t len, uint32_t ticksPerUs) const {
+    TraceStat st[TRACE_STAGE_COUNT];
+    summarize(st, ticksPerUs);
+
+    size_t pos = 0;
+    int n = snprintf(buf, len, "n=%u p50/p99 us:", st[TRACE_STAT_TOTAL].count);
+    if (n > 0) pos = ((size_t)n < len) ? (size_t)n : len;
+
+    for (int s = 1; s <= TRACE_STAGE_COUNT && pos < len; s++) {
+        const int i = (s == TRACE_STAGE_COUNT) ? TRACE_STAT_TOTAL : s; /* total last */
+        if (st[i].count == 0) continue;
+        n = snprintf(buf + pos, len - pos, " %s %lu/%lu", traceStageNames[i],
+                     (unsigned long)st[i].p50Us, (unsigned long)st[i].p99Us);
+        if (n > 0) pos += ((size_t)n < len - pos) ? (size_t)n : len - pos;
+    }
+    return pos;
+}
+
+const char* TraceRing::stageName(TraceStage stage) {
+    return (stage < TRACE_STAGE_COUNT) ? traceStageNames[stage] : "?";
+}
+
+#if defined(ARDUINO)
+TraceRing touchTrace;
+
+/* Per-core offset mapping the cycle counter onto micros() * CYD_PM_MAX_MHZ */
+static volatile uint32_t traceCoreOffset[2];
+static volatile bool traceCoreValid[2];
+
+uint32_t traceNow() {
+    const int core = xPortGetCoreID();
+    if (!traceCoreValid[core]) {
+        traceCoreOffset[core] = ESP.getCycleCount() - (uint32_t)micros() * CYD_PM_MAX_MHZ;
+        traceCoreValid[core] = true;
+    }
+    return ESP.getCycleCount() - traceCoreOffset[core];
+}
+
+void traceRecalibrate() {
+    traceCoreValid[0] = false;
+    traceCoreValid[1] = false;
+}
+
+void traceReport() {
+    char line[160];
+    touchTrace.format(line, sizeof(line), CYD_PM_MAX_MHZ);
+    Serial.printf("CYD: Touch latency %s\n", line);
+}
+#endif
@@ -0,0 +1,126 @@
+#ifndef TOUCHTRACE_H_
+#define TOUCHTRACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* touchtrace.h - touch-to-bus latency tracing.
+ * Every accepted touch gets a trace ID that travels with it (TouchData,
+ * the dispatch in TaskUpdateDisplay, the CAN send) and each stage stores a
+ * timestamp in a fixed ring of records. A stage mark is a slot lookup, an
+ * ID compare and a store. Build with CYD_TRACE=0 and the TRACE_* macros
+ * compile to nothing. The ring and statistics have no Arduino dependency;
+ * only the clock (traceNow) is device code. */
+
+#ifndef CYD_TRACE
+#define CYD_TRACE 1
+#endif
+
+#define TRACE_RING_SIZE     32 /**< Records kept, power of two */
+#define TRACE_REPORT_EVERY  16 /**< Dispatched touches between Serial reports */
+
+/** --- Pipeline stages, in order --- */
+enum TraceStage { TRACE_TOUCH = 0,  /**< Touch controller poll hit */
+                  TRACE_QUEUED,     /**< xQueueSend into touchQueue succeeded */
+                  TRACE_DEQUEUED,   /**< Received by TaskUpdateDisplay */
+                  TRACE_DISPATCH,   /**< Passed debounce, handed to the screen */
+                  TRACE_SENT,       /**< send_message() returned */
+                  TRACE_ACK,        /**< Target node answered (heartbeat or state echo) */
+                  TRACE_STAGE_COUNT
+                };
+
+/** Index of the touch-to-sent total in a TraceStat array (TRACE_TOUCH has no delta of its own) */
+#define TRACE_STAT_TOTAL TRACE_TOUCH
+
+/**
+ * @struct TraceRecord
+ * @brief Timestamps of one interaction. Only stages with their bit set in mask are valid.
+ */
+struct TraceRecord {
+    uint16_t id;
+    uint8_t  mask;
+    uint32_t t[TRACE_STAGE_COUNT];
+};
+
+/**
+ * @struct TraceStat
+ * @brief Latency of one stage (time since the previous recorded stage), in microseconds.
+ */
+struct TraceStat {
+    uint16_t count;
+    uint32_t p50Us;
+    uint32_t p99Us;
+};
+
+/**
+ * @class TraceRing
+ * @brief Fixed ring of trace records indexed by trace ID.
+ * @details begin() is called from one task only (the touch task); mark() may be
+ *          called from any task. A mark for an ID whose slot has been reused is
+ *          dropped, so late acknowledgements never pollute a newer record.
+ */
+class TraceRing {
+public:
+    TraceRing() : _nextId(1) { clear(); }
+
+    void clear();
+
+    /** @brief Opens a record stamped at TRACE_TOUCH. @return Trace ID, never 0. */
+    uint16_t begin(uint32_t now);
+
+    /** @brief Stamps a stage of trace id (0 = untraced, ignored). */
+    inline void mark(uint16_t id, TraceStage stage, uint32_t now) {
+        TraceRecord& r = _recs[id & (TRACE_RING_SIZE - 1)];
+        if (id == 0 || r.id != id) return;
+        r.t[stage] = now;
+        r.mask |= (uint8_t)(1 << stage);
+    }
+
+    /**
+     * @brief Per-stage p50/p99 over the records in the ring.
+     * @param out TRACE_STAGE_COUNT entries; out[TRACE_STAT_TOTAL] is touch to sent
+     * @param ticksPerUs Clock ticks per microsecond
+     */
+    void summarize(TraceStat* out, uint32_t ticksPerUs) const;
+
+    /** @brief Writes a one-line report of summarize() into buf. */
+    size_t format(char* buf, size_t len, uint32_t ticksPerUs) const;
+
+    const TraceRecord& record(uint8_t slot) const { return _recs[slot & (TRACE_RING_SIZE - 1)]; }
+
+    /** @brief Nearest-rank percentile; sorts v in place. */
+    static uint32_t percentile(uint32_t* v, uint8_t n, uint8_t pct);
+
+    static const char* stageName(TraceStage stage);
+
+private:
+    TraceRecord _recs[TRACE_RING_SIZE];
+    uint16_t    _nextId;
+};
+
+#if defined(ARDUINO)
+extern TraceRing touchTrace;
+
+/**
+ * @brief Trace clock: CPU cycles corrected per core onto a common base.
+ * @details The two cores' cycle counters are not synchronised, so each core is
+ *          calibrated against micros() on first use. Stamps tick at CYD_PM_MAX_MHZ;
+ *          call traceRecalibrate() after the CPU clock has been scaled down.
+ */
+uint32_t traceNow();
+void traceRecalibrate();
+
+/** @brief Writes the summary to Serial. */
+void traceReport();
+#endif
+
+/** --- Instrumentation; compiled out with CYD_TRACE=0 --- */
+#if CYD_TRACE
+#define TRACE_BEGIN()          touchTrace.begin(traceNow())
+#define TRACE_MARK(id, stage)  touchTrace.mark((id), (stage), traceNow())
+#else
+#define TRACE_BEGIN()          ((uint16_t)0)
+#define TRACE_MARK(id, stage)  do {} while (0)
+#endif
+
+#endif /* END TOUCHTRACE_H_ */
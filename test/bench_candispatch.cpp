@@ -0,0 +1,56 @@
+#include <chrono>
+#include <vector>
+#include "hosttest.h"
+#include "candispatch.h"
+
+/* bench_candispatch.cpp - dispatch cost per frame at 1k to 10k frames/s */
+
+#define HANDLERS 32
+
+static void count(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx) {
+    (void)id;
+    (void)dlc;
+    *(uint32_t*)ctx += data[0];
+}
+
+TEST(candispatch, cost_per_frame_with_a_full_table) {
+    typedef std::chrono::steady_clock Clock;
+    CanDispatch d;
+    uint32_t sink = 0;
+    /* 24 single IDs and 8 ranges of 16, spread over the ID space */
+    for (int i = 0; i < HANDLERS; i++) {
+        const uint16_t first = (uint16_t)(i * 64);
+        REQUIRE(d.add(first, (uint16_t)(first + ((i % 4 == 0) ? 15 : 0)), count, &sink));
+    }
+
+    /* Mixed stream: three quarters owned IDs, the rest for the caller */
+    const uint32_t rates[3] = { 1000, 5000, 10000 };
+    const uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    printf("    %8s %10s %10s %12s\n", "frames/s", "handled", "ns/frame", "core share");
+    for (uint32_t fps : rates) {
+        std::vector<uint16_t> ids(fps);
+        uint32_t lcg = fps;
+        for (uint32_t i = 0; i < fps; i++) {
+            lcg = lcg * 1103515245u + 12345u;
+            const uint16_t h = (uint16_t)((lcg >> 8) % HANDLERS);
+            ids[i] = ((lcg >> 24) & 3) ? (uint16_t)(h * 64 + ((h % 4 == 0) ? (lcg >> 16) % 16 : 0))
+                                       : (uint16_t)(h * 64 + 40);
+        }
+
+        /* One second of traffic, a few times over; the best run is the steady state */
+        double best = 1e12;
+        uint32_t handled = 0;
+        for (int run = 0; run < 5; run++) {
+            handled = 0;
+            const Clock::time_point t0 = Clock::now();
+            for (uint32_t i = 0; i < fps; i++) handled += d.dispatch(ids[i], data, 8) ? 1 : 0;
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            if (ns < best) best = ns;
+        }
+        printf("    %8u %10u %10.1f %11.4f%%\n", (unsigned)fps, (unsigned)handled,
+               best / fps, best / 1e9 * 100.0);
+        CHECK(handled > fps / 2 && handled < fps);
+    }
+    CHECK(sink > 0);
+    CHECK(d.unhandled() > 0);
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "hosttest.h"
+#include "spsc.h"
+
+/* bench_canload.cpp - display loop period under synthetic CAN load.
+ *
+ * A receive thread queues node heartbeats at a fixed rate the way
+ * registerARGBNode() does; a display thread drains the queue into a node
+ * table at the top of each pass and sleeps LOOP_MS like TaskUpdateDisplay.
+ * Host figures: they show what the channel and the table updates add to a
+ * pass, not what the ESP32 scheduler does.
+ */
+
+#define LOOP_MS    5    /**< vTaskDelay() at the end of a display pass */
+#define RUN_MS     1000
+#define QUEUE_LEN  64   /**< NODE_EVENT_QUEUE_LEN */
+#define TABLE      200  /**< Node table slots searched per heartbeat */
+
+/**
+ * @struct HeartbeatEvent
+ * @brief The NodeEvent fields a heartbeat carries
+ */
+struct HeartbeatEvent {
+    uint32_t id;
+    uint32_t atMs;
+};
+
+/**
+ * @struct LoadResult
+ * @brief Display pass periods and what reached the table
+ */
+struct LoadResult {
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+    uint32_t sent;
+    uint32_t applied;
+    uint32_t dropped;
+};
+
+/**
+ * @brief Runs the load for RUN_MS.
+ * @param fps Heartbeats per second, spread over nodes senders
+ */
+static LoadResult runLoad(uint32_t fps, uint32_t nodes) {
+    typedef std::chrono::steady_clock Clock;
+    SpscQueue<HeartbeatEvent, QUEUE_LEN> events;
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> sent(0);
+    std::atomic<uint32_t> dropped(0);
+
+    std::thread can([&]() {
+        const Clock::time_point t0 = Clock::now();
+        uint32_t n = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+            const uint64_t due = us * fps / 1000000;
+            for (; n < due; n++) {
+                HeartbeatEvent ev = { 0x1A000000u + (n % nodes), (uint32_t)(us / 1000) };
+                if (!events.push(ev)) dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            sent.store(n, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    uint32_t ids[TABLE] = {};
+    uint32_t seen[TABLE] = {};
+    std::vector<uint32_t> periods;
+    uint32_t applied = 0;
+    auto apply = [&](const HeartbeatEvent& ev) {
+        int empty = -1;
+        for (int i = 0; i < TABLE; i++) {
+            if (ids[i] == ev.id) { seen[i] = ev.atMs; return; }
+            if (empty < 0 && ids[i] == 0) empty = i;
+        }
+        if (empty >= 0) { ids[empty] = ev.id; seen[empty] = ev.atMs; }
+    };
+
+    const Clock::time_point end = Clock::now() + std::chrono::milliseconds(RUN_MS);
+    Clock::time_point last = Clock::now();
+    while (Clock::now() < end) {
+        HeartbeatEvent ev;
+        while (events.pop(ev)) { apply(ev); applied++; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_MS));
+        const Clock::time_point now = Clock::now();
+        periods.push_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now - last).count());
+        last = now;
+    }
+    stop.store(true);
+    can.join();
+    HeartbeatEvent ev;
+    while (events.pop(ev)) applied++;
+
+    std::sort(periods.begin(), periods.end());
+    LoadResult res;
+    res.p50Us = periods[periods.size() / 2];
+    res.p99Us = periods[(periods.size() * 99) / 100];
+    res.maxUs = periods.back();
+    res.sent = sent.load();
+    res.applied = applied;
+    res.dropped = dropped.load();
+    return res;
+}
+
+TEST(canload, display_pass_period_under_heartbeat_load) {
+    const uint32_t rates[4] = { 0, 1000, 5000, 10000 };
+    printf("    %6s %8s %8s %8s %8s %8s\n", "fps", "p50 us", "p99 us", "max us", "applied", "dropped");
+    for (uint32_t fps : rates) {
+        const LoadResult res = runLoad(fps, TABLE);
+        printf("    %6u %8u %8u %8u %8u %8u\n", (unsigned)fps, (unsigned)res.p50Us, (unsigned)res.p99Us,
+               (unsigned)res.maxUs, (unsigned)res.applied, (unsigned)res.dropped);
+        /* Every heartbeat either reached the table or was counted */
+        CHECK_EQ(res.applied + res.dropped, res.sent);
+        CHECK(res.p50Us >= LOOP_MS * 1000);
+    }
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include "hosttest.h"
+#include "nodelist.h"
+
+/* bench_nodelist.cpp - node list redraw work and rebuild() cost against the node count */
+
+#define SLOTS    200  /**< MAX_ARGB_NODES */
+#define TOP      44
+#define PITCH    24   /**< NODE_LIST_ROW_H */
+#define ROWS     7    /**< NODE_LIST_ROWS */
+#define REBUILDS 200
+
+/**
+ * @class BenchTable
+ * @brief Node table with n nodes at random IDs, heartbeat times and activity
+ */
+class BenchTable : public NodeListSource {
+public:
+    uint32_t id[SLOTS] = {};
+    uint32_t seen[SLOTS] = {};
+    uint16_t activity[SLOTS] = {};
+
+    explicit BenchTable(int n) {
+        uint32_t lcg = 12345u + n;
+        for (int s = 0; s < n; s++) {
+            lcg = lcg * 1103515245u + 12345u;
+            id[s] = 0x10000000u | (lcg >> 4);
+            seen[s] = lcg % 30000;
+            activity[s] = (uint16_t)(lcg >> 20);
+        }
+    }
+
+    uint8_t  slotCount() const override { return SLOTS; }
+    uint32_t nodeId(uint8_t s) const override { return id[s]; }
+    uint32_t nodeLastSeen(uint8_t s) const override { return seen[s]; }
+    uint16_t nodeActivity(uint8_t s) const override { return activity[s]; }
+};
+
+static int rowsIn(uint32_t mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
+
+TEST(nodelist, redraw_stays_flat_as_nodes_grow) {
+    typedef std::chrono::steady_clock Clock;
+    const int counts[4] = { 8, 50, 100, 200 };
+    const NodeSortKey sorts[3] = { NODE_SORT_ID, NODE_SORT_LAST_SEEN, NODE_SORT_ACTIVITY };
+
+    printf("    %5s %6s %12s %12s %12s\n", "nodes", "pages", "full rows", "update rows", "rebuild us");
+    for (int n : counts) {
+        BenchTable t(n);
+        uint8_t order[SLOTS];
+        uint8_t position[SLOTS];
+        NodeListView v(order, position, SLOTS, TOP, PITCH, ROWS);
+        v.rebuild(t, 30000);
+
+        /* Full page paint, then every node heartbeating once: only visible rows repaint */
+        const int fullRows = v.visibleCount();
+        int worstUpdate = 0;
+        for (uint8_t p = 0; p < v.pageCount(); p++) {
+            v.setPage(p);
+            for (int s = 0; s < n; s++) v.markSlotDirty(s);
+            const int rows = rowsIn(v.takeDirtyRows());
+            if (rows > worstUpdate) worstUpdate = rows;
+        }
+        v.setPage(0);
+
+        /* rebuild() over the three sort keys, the cost a list change pays */
+        const Clock::time_point t0 = Clock::now();
+        for (int i = 0; i < REBUILDS; i++) {
+            v.setSort(sorts[i % 3]);
+            v.rebuild(t, 30000 + i);
+        }
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / REBUILDS;
+
+        printf("    %5d %6u %12d %12d %12.1f\n", n, (unsigned)v.pageCount(), fullRows, worstUpdate, us);
+        CHECK_EQ(fullRows, n < ROWS ? n : ROWS);
+        CHECK(worstUpdate <= ROWS);
+        CHECK_EQ(v.count(), n);
+    }
+}
@@ -0,0 +1,43 @@
+#include "hosttest.h"
+
+/* hosttest.cpp - runner for the tests registered with TEST() */
+
+static HostTest* testsHead = 0;
+static HostTest* testsTail = 0;
+static int failedChecks = 0;
+
+int hostTestRegister(HostTest* test) {
+    /* Keep file order so output follows the source */
+    if (testsTail) testsTail->next = test;
+    else testsHead = test;
+    testsTail = test;
+    return 0;
+}
+
+void hostTestFail(const char* file, int line, const char* expr) {
+    printf("    %s:%d: CHECK(%s) failed\n", file, line, expr);
+    failedChecks++;
+}
+
+int main(int argc, char** argv) {
+    const char* only = (argc > 1) ? argv[1] : 0;
+    int run = 0;
+    int failed = 0;
+
+    for (HostTest* t = testsHead; t; t = t->next) {
+        if (only && strcmp(only, t->suite) != 0) continue;
+        const int before = failedChecks;
+        t->fn();
+        run++;
+        const bool ok = (failedChecks == before);
+        if (!ok) failed++;
+        printf("%s %s.%s\n", ok ? "  ok  " : "  FAIL", t->suite, t->name);
+    }
+
+    if (run == 0) {
+        printf("no tests%s%s\n", only ? " in suite " : "", only ? only : "");
+        return 1;
+    }
+    printf("%d test(s), %d failed\n", run, failed);
+    return failed ? 1 : 0;
+}
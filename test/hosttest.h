@@ -0,0 +1,55 @@
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+/* hosttest.h - minimal test runner for the portable modules.
+ *
+ * Each TEST(suite, name) registers itself at static init; the runner
+ * (hosttest.cpp) executes every test whose suite matches the first command
+ * line argument, or all of them without one. CTest runs one suite per test
+ * so failures are reported per module. CHECK records a failure and carries
+ * on; REQUIRE returns from the test.
+ */
+
+typedef void (*HostTestFn)();
+
+/**
+ * @struct HostTest
+ * @brief One registered test case
+ */
+struct HostTest {
+    const char* suite;
+    const char* name;
+    HostTestFn  fn;
+    HostTest*   next;
+};
+
+/** @brief Adds a test to the run list; used by TEST(). */
+int hostTestRegister(HostTest* test);
+
+/** @brief Records a failed check in the running test. */
+void hostTestFail(const char* file, int line, const char* expr);
+
+#define TEST(suite, name)                                                     \
+    static void test_##suite##_##name();                                      \
+    static HostTest hostTest_##suite##_##name = { #suite, #name,              \
+                                                  test_##suite##_##name, 0 }; \
+    [[maybe_unused]] static int hostTestReg_##suite##_##name =                \
+        hostTestRegister(&hostTest_##suite##_##name);                         \
+    static void test_##suite##_##name()
+
+#define CHECK(cond) \
+    do { if (!(cond)) hostTestFail(__FILE__, __LINE__, #cond); } while (0)
+
+#define REQUIRE(cond) \
+    do { if (!(cond)) { hostTestFail(__FILE__, __LINE__, #cond); return; } } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { if (!((a) == (b))) { \
+        hostTestFail(__FILE__, __LINE__, #a " == " #b); \
+        printf("      got %lld, expected %lld\n", (long long)(a), (long long)(b)); \
+    } } while (0)
+
+#endif /* END HOSTTEST_H_ */
@@ -0,0 +1,97 @@
+#include "hosttest.h"
+#include "argbeffects.h"
+
+/* test_argbeffects.cpp - effect frames, phase sync between nodes, and effect shapes */
+
+static const EffectRgb RED   = { 255, 0, 0 };
+static const EffectRgb BLUE  = { 0, 0, 255 };
+static const EffectRgb BLACK = { 0, 0, 0 };
+
+static bool same(const EffectRgb& a, const EffectRgb& b) { return a.r == b.r && a.g == b.g && a.b == b.b; }
+
+TEST(argbeffects, frame_round_trip) {
+    int bad = 0;
+    for (uint8_t e = 0; e < EFFECT_COUNT; e++)
+        for (uint8_t sp = 0; sp < EFFECT_SPEEDS; sp++)
+            for (uint8_t ph = 0; ph < EFFECT_PHASE_STEPS; ph += 7)
+                for (uint8_t ca = 0; ca < 32; ca += 5) {
+                    const EffectCommand c = { (uint8_t)(0xA5 ^ ph), e, sp, ca, (uint8_t)(31 - ca), ph };
+                    EffectCommand d;
+                    uint8_t f[EFFECT_FRAME_DLC];
+                    uint32_t node = 0;
+                    if (!encodeEffectFrame(0x12345678UL, c, f)) { bad++; continue; }
+                    if (!decodeEffectFrame(f, EFFECT_FRAME_DLC, &node, &d) || node != 0x12345678UL) bad++;
+                    else if (memcmp(&c, &d, sizeof(c)) != 0) bad++;
+                    if (decodeEffectFrame(f, EFFECT_FRAME_DLC - 1, &node, &d)) bad++;
+                }
+    CHECK_EQ(bad, 0);
+}
+
+TEST(argbeffects, out_of_range_fields_are_refused) {
+    uint8_t f[EFFECT_FRAME_DLC];
+    EffectCommand c = { 1, EFFECT_COUNT, 0, 0, 0, 0 };
+    CHECK(!encodeEffectFrame(1, c, f));
+    c.effect = EFFECT_SOLID;
+    c.colourA = 32;
+    CHECK(!encodeEffectFrame(1, c, f));
+    c.colourA = 0;
+    c.speed = EFFECT_SPEEDS;
+    CHECK(!encodeEffectFrame(1, c, f));
+}
+
+TEST(argbeffects, nodes_commanded_apart_run_in_step) {
+    /* Each node receives the command at a different sender time, on its own unrelated clock */
+    const uint32_t sendTimes[3] = { 1000, 5321, 77777 };
+    int late = 0;
+    for (uint8_t sp = 0; sp < EFFECT_SPEEDS; sp++) {
+        const uint32_t period = effectPeriodMs(sp);
+        for (uint32_t send : sendTimes) {
+            const uint8_t phase = effectPhaseAt(send, sp);
+            const uint32_t rx = send * 3 + 12345;
+            const uint32_t origin = effectOrigin(rx, phase, sp);
+            for (uint32_t dt = 0; dt < 20000; dt += 97) {
+                const uint32_t senderT = send + dt;
+                const uint32_t nodeT = rx + dt - origin;
+                uint32_t err = (senderT - nodeT + period * 1000) % period;
+                if (err > period / 2) err = period - err;
+                if (err > period / EFFECT_PHASE_STEPS + 1) late++;
+            }
+        }
+    }
+    CHECK_EQ(late, 0);
+}
+
+TEST(argbeffects, effect_shapes) {
+    const uint32_t p = effectPeriodMs(4);
+    CHECK(same(effectPixel(EFFECT_SOLID, 3, RED, BLUE, 12345, 0, 16), RED));
+    CHECK(same(effectPixel(EFFECT_BREATHE, 4, RED, BLACK, 0, 0, 16), BLACK));
+    CHECK(effectPixel(EFFECT_BREATHE, 4, RED, BLACK, p / 2, 0, 16).r >= 250);
+    CHECK(same(effectPixel(EFFECT_STROBE, 4, RED, BLACK, 0, 0, 16), RED));
+    CHECK(same(effectPixel(EFFECT_STROBE, 4, RED, BLACK, p / 4, 0, 16), BLACK));
+    CHECK(same(effectPixel(EFFECT_BLINK, 4, RED, BLUE, p / 2 + 1, 3, 16), BLUE));
+    CHECK(same(effectPixel(EFFECT_FADE, 4, RED, BLUE, 0, 0, 16), RED));
+    CHECK(effectPixel(EFFECT_FADE, 4, RED, BLUE, p / 2, 0, 16).b >= 250);
+
+    const EffectRgb r0 = effectPixel(EFFECT_RAINBOW, 4, RED, BLACK, 0, 0, 16);
+    CHECK_EQ(r0.r, 255);
+    CHECK_EQ(r0.g, 0);
+}
+
+TEST(argbeffects, chase_head_walks_the_strip) {
+    const uint32_t p = effectPeriodMs(4);
+    int wrong = 0;
+    for (uint32_t t = 0; t < p; t += p / 16) {
+        const uint16_t head = (uint16_t)((t * 16) / p);
+        if (!same(effectPixel(EFFECT_CHASE, 4, RED, BLACK, t, head, 16), RED)) wrong++;
+        if (!same(effectPixel(EFFECT_CHASE, 4, RED, BLACK, t, (head + 8) % 16, 16), BLACK)) wrong++;
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+TEST(argbeffects, only_solid_is_static) {
+    CHECK(!effectAnimates(EFFECT_SOLID));
+    for (uint8_t e = EFFECT_BREATHE; e < EFFECT_COUNT; e++) CHECK(effectAnimates(e));
+    CHECK(!effectAnimates(EFFECT_COUNT));
+    CHECK_EQ(effectPeriodMs(0), 8000);
+    CHECK_EQ(effectPeriodMs(EFFECT_SPEEDS - 1), 50);
+}
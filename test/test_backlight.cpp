@@ -0,0 +1,90 @@
+#include "hosttest.h"
+#include "backlight.h"
+
+/* test_backlight.cpp - LDR filter, curve hysteresis and stage multipliers */
+
+#define BURST 16
+
+static const BacklightCurvePoint testCurve[] = {
+    {0,    40},
+    {200,  120},
+    {800,  350},
+    {2000, 700},
+    {3500, 1000}
+};
+
+/** @brief Feeds one burst in which every reading is level */
+static uint16_t feed(AmbientFilter& f, uint16_t level) {
+    return f.update((uint32_t)level * BURST, BURST);
+}
+
+TEST(backlight, curve_interpolation) {
+    BacklightCurve c(testCurve, 5, 0);
+    CHECK_EQ(c.interpolate(0), 40);
+    CHECK_EQ(c.interpolate(200), 120);
+    CHECK_EQ(c.interpolate(500), 235);        /* half way 120..350 */
+    CHECK_EQ(c.interpolate(3500), 1000);
+    CHECK_EQ(c.interpolate(BL_ADC_MAX), 1000); /* clamped past the last point */
+
+    BacklightCurve empty(testCurve, 0, 0);
+    CHECK_EQ(empty.interpolate(100), BL_DUTY_FULL);
+}
+
+TEST(backlight, filter_seeds_then_low_passes) {
+    AmbientFilter f(3);
+    CHECK_EQ(feed(f, 1000), 1000);            /* first burst seeds directly */
+
+    /* A step converges geometrically: 1/8 of the remaining gap per burst */
+    uint16_t v = feed(f, 2000);
+    CHECK(v > 1000 && v < 1200);
+    for (int i = 0; i < 80; i++) v = feed(f, 2000);
+    CHECK(v >= 1995 && v <= 2000);
+
+    CHECK_EQ(f.update(0, 0), v);              /* empty burst leaves it alone */
+    f.reset();
+    CHECK_EQ(feed(f, 300), 300);
+}
+
+TEST(backlight, hysteresis_holds_on_a_boundary) {
+    BacklightCurve c(testCurve, 5, 80);
+    AmbientFilter f(3);
+
+    /* Flicker of +-50 counts around 1000 (mains lamps, passing shadows) */
+    const uint16_t first = c.map(feed(f, 1000));
+    for (int i = 0; i < 40; i++) {
+        CHECK_EQ(c.map(feed(f, (i & 1) ? 1050 : 950)), first);
+    }
+
+    /* Even unfiltered, drift up to the hysteresis does not move the duty */
+    CHECK_EQ(c.map(1080), first);
+    CHECK_EQ(c.map(920), first);
+    CHECK(c.map(1081) != first);              /* beyond it, it follows */
+    CHECK_EQ(c.map(1081), c.interpolate(1081));
+}
+
+TEST(backlight, hysteresis_follows_real_change) {
+    BacklightCurve c(testCurve, 5, 80);
+    AmbientFilter f(3);
+
+    const uint16_t dark = c.map(feed(f, 1000));
+    uint16_t duty = dark;
+    for (int i = 0; i < 60; i++) duty = c.map(feed(f, 3000));
+    CHECK(duty > dark);
+
+    /* Held level is whatever it last jumped to, within the hysteresis of 3000 */
+    CHECK(duty >= c.interpolate(3000 - 80) && duty <= c.interpolate(3000));
+
+    /* A new curve is applied immediately, not after the next big drift */
+    static const BacklightCurvePoint flat[] = { {0, 500}, {4095, 500} };
+    c.set(flat, 2);
+    CHECK_EQ(c.map(f.value()), 500);
+}
+
+TEST(backlight, stage_multipliers) {
+    CHECK_EQ(backlightStageDuty(400, BL_STAGE_ACTIVE, 500, 0, 20), 400);
+    CHECK_EQ(backlightStageDuty(400, BL_STAGE_DIM, 500, 0, 20), 200);
+    CHECK_EQ(backlightStageDuty(400, BL_STAGE_OFF, 500, 0, 20), 0);      /* zero stays zero */
+    CHECK_EQ(backlightStageDuty(30, BL_STAGE_DIM, 500, 0, 20), 20);      /* floor keeps it legible */
+    CHECK_EQ(backlightStageDuty(100, BL_STAGE_OFF, 500, 100, 20), 20);
+    CHECK_EQ(backlightStageDuty(1000, BL_STAGE_DIM, 1500, 0, 20), BL_DUTY_FULL);
+}
@@ -0,0 +1,99 @@
+#include "hosttest.h"
+#include "bootprofile.h"
+
+/* test_bootprofile.cpp - stage stamps and the dependency check, on a fake microsecond clock */
+
+static uint32_t fakeUs = 0;
+static uint32_t fakeClock() { return fakeUs; }
+
+/** @brief Marks a stage at an absolute fake time */
+static void markAt(BootStage stage, uint32_t us) {
+    fakeUs = us;
+    bootMark(stage);
+}
+
+TEST(bootprofile, overlapped_startup_is_valid) {
+    bootProfileReset(fakeClock);
+    markAt(BOOT_INIT_START, 100);
+    markAt(BOOT_TASKS_STARTED, 200);
+    markAt(BOOT_REGISTRY_READY, 5000);   /* restored while the panel initialises */
+    markAt(BOOT_TOUCH_READY, 9000);
+    markAt(BOOT_PANEL_READY, 130000);
+    markAt(BOOT_SPLASH_SHOWN, 160000);
+    CHECK(bootSequenceValid());
+    markAt(BOOT_INTERACTIVE, 200000);
+    CHECK(bootSequenceValid());
+
+    CHECK_EQ(bootElapsedUs(BOOT_INTERACTIVE), 199900u);
+    CHECK_EQ(bootStageUs(BOOT_PANEL_READY), 130000u);
+    CHECK(strcmp(bootStageName(BOOT_SPLASH_SHOWN), "splash") == 0);
+}
+
+TEST(bootprofile, interactive_before_dependencies_is_invalid) {
+    /* Keypad up before the registry (the display task not waiting for REGISTRY) */
+    bootProfileReset(fakeClock);
+    markAt(BOOT_INIT_START, 10);
+    markAt(BOOT_TASKS_STARTED, 20);
+    markAt(BOOT_TOUCH_READY, 30);
+    markAt(BOOT_PANEL_READY, 40);
+    markAt(BOOT_SPLASH_SHOWN, 50);
+    markAt(BOOT_INTERACTIVE, 60);
+    CHECK(!bootSequenceValid());
+    markAt(BOOT_REGISTRY_READY, 70);
+    CHECK(!bootSequenceValid());          /* marked, but after the keypad went live */
+
+    /* Splash before the panel was initialised */
+    bootProfileReset(fakeClock);
+    markAt(BOOT_INIT_START, 10);
+    markAt(BOOT_SPLASH_SHOWN, 20);
+    CHECK(!bootSequenceValid());
+    markAt(BOOT_PANEL_READY, 30);
+    CHECK(!bootSequenceValid());
+}
+
+TEST(bootprofile, first_mark_wins) {
+    bootProfileReset(fakeClock);
+    markAt(BOOT_INIT_START, 0);           /* 0 is stored as 1: 0 means "not reached" */
+    CHECK(bootStageDone(BOOT_INIT_START));
+    CHECK_EQ(bootStageUs(BOOT_INIT_START), 1u);
+
+    markAt(BOOT_PANEL_READY, 500);
+    markAt(BOOT_PANEL_READY, 900);
+    CHECK_EQ(bootStageUs(BOOT_PANEL_READY), 500u);
+
+    CHECK(!bootStageDone(BOOT_TOUCH_READY));
+    CHECK_EQ(bootElapsedUs(BOOT_TOUCH_READY), 0u);
+}
+
+TEST(bootprofile, clock_wrap_keeps_order) {
+    /* micros() wraps every ~71 minutes; a soft restart can start just before it */
+    bootProfileReset(fakeClock);
+    markAt(BOOT_INIT_START, 0xFFFFFF00u);
+    markAt(BOOT_TASKS_STARTED, 0xFFFFFF80u);
+    markAt(BOOT_REGISTRY_READY, 0x00000100u);
+    markAt(BOOT_TOUCH_READY, 0x00000200u);
+    markAt(BOOT_PANEL_READY, 0x00000300u);
+    markAt(BOOT_SPLASH_SHOWN, 0x00000400u);
+    markAt(BOOT_INTERACTIVE, 0x00000500u);
+    CHECK(bootSequenceValid());
+    CHECK_EQ(bootElapsedUs(BOOT_INTERACTIVE), 0x600u);
+}
+
+TEST(bootprofile, report_lists_marked_stages) {
+    bootProfileReset(fakeClock);
+    markAt(BOOT_INIT_START, 1000);
+    markAt(BOOT_PANEL_READY, 13345);
+
+    char report[256];
+    const size_t n = bootFormatReport(report, sizeof(report));
+    CHECK_EQ(n, strlen(report));
+    CHECK(strstr(report, "init") != NULL);
+    CHECK(strstr(report, "+12.345 ms") != NULL);
+    CHECK(strstr(report, "touch") == NULL);
+
+    /* Truncation keeps whole lines */
+    char small[24];
+    bootFormatReport(small, sizeof(small));
+    CHECK(strchr(small, '\n') != NULL);
+    CHECK(strstr(small, "panel") == NULL);
+}
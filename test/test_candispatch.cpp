@@ -0,0 +1,111 @@
+#include "hosttest.h"
+#include "candispatch.h"
+
+/* test_candispatch.cpp - ID and range lookup, ownership and counters */
+
+/**
+ * @struct Seen
+ * @brief What a handler was called with
+ */
+struct Seen {
+    int            calls;
+    uint16_t       id;
+    const uint8_t* data;
+    uint8_t        dlc;
+};
+
+static void record(uint16_t id, const uint8_t* data, uint8_t dlc, void* ctx) {
+    Seen* s = (Seen*)ctx;
+    s->calls++;
+    s->id = id;
+    s->data = data;
+    s->dlc = dlc;
+}
+
+TEST(candispatch, single_ids_and_ranges_route_to_their_handler) {
+    CanDispatch d;
+    Seen a = {}, b = {}, c = {};
+    REQUIRE(d.add(0x6A0, record, &a));
+    REQUIRE(d.add(0x100, 0x10F, record, &b));
+    REQUIRE(d.add(0x000, record, &c));            /* ID 0 is a valid owner */
+    CHECK_EQ(d.count(), 3);
+
+    const uint8_t frame[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    CHECK(d.dispatch(0x6A0, frame, 8));
+    CHECK_EQ(a.calls, 1);
+    CHECK(a.data == frame);                       /* zero copy */
+    CHECK_EQ(a.dlc, 8);
+
+    CHECK(d.dispatch(0x100, frame, 2));
+    CHECK(d.dispatch(0x10F, frame, 3));
+    CHECK_EQ(b.calls, 2);
+    CHECK_EQ(b.id, 0x10F);                        /* ranges see which ID it was */
+    CHECK_EQ(b.dlc, 3);
+
+    CHECK(d.dispatch(0x000, frame, 0));
+    CHECK_EQ(c.calls, 1);
+
+    CHECK_EQ(d.frames(0), 1);
+    CHECK_EQ(d.frames(1), 2);
+    CHECK_EQ(d.frames(2), 1);
+    CHECK_EQ(d.frames(3), 0);                     /* past the table */
+    CHECK_EQ(d.first(1), 0x100);
+    CHECK_EQ(d.last(1), 0x10F);
+}
+
+TEST(candispatch, unowned_ids_are_left_to_the_caller) {
+    CanDispatch d;
+    Seen a = {};
+    REQUIRE(d.add(0x200, 0x201, record, &a));
+    const uint8_t frame[1] = { 0 };
+
+    CHECK(!d.dispatch(0x1FF, frame, 1));
+    CHECK(!d.dispatch(0x202, frame, 1));
+    CHECK(!d.dispatch(CAN_STD_ID_COUNT, frame, 1)); /* beyond 11 bits */
+    CHECK(!d.dispatch(0xFFFF, frame, 1));
+    CHECK_EQ(a.calls, 0);
+    CHECK_EQ(d.unhandled(), 4);
+}
+
+TEST(candispatch, one_owner_per_id) {
+    CanDispatch d;
+    Seen a = {}, b = {};
+    REQUIRE(d.add(0x300, 0x30F, record, &a));
+    CHECK(!d.add(0x30F, record, &b));             /* last ID of the range */
+    CHECK(!d.add(0x2F0, 0x300, record, &b));      /* overlaps the first */
+    CHECK(!d.add(0x200, 0x400, record, &b));      /* covers it */
+    CHECK_EQ(d.count(), 1);
+
+    /* A refused range leaves no partial claim behind */
+    CHECK(d.add(0x2F0, 0x2FF, record, &b));
+    CHECK(d.add(0x310, record, &b));
+    const uint8_t frame[1] = { 0 };
+    CHECK(d.dispatch(0x2F5, frame, 1));
+    CHECK(d.dispatch(0x305, frame, 1));
+    CHECK_EQ(a.calls, 1);
+    CHECK_EQ(b.calls, 1);
+}
+
+TEST(candispatch, invalid_registrations_are_refused) {
+    CanDispatch d;
+    Seen a = {};
+    CHECK(!d.add(0x10, NULL, &a));
+    CHECK(!d.add(0x20, 0x10, record, &a));        /* reversed */
+    CHECK(!d.add(0x7FF, CAN_STD_ID_COUNT, record, &a));
+    CHECK(!d.add(CAN_STD_ID_COUNT, record, &a));
+    CHECK_EQ(d.count(), 0);
+    CHECK(d.add(0x7FF, record, &a));              /* highest standard ID */
+}
+
+TEST(candispatch, table_is_bounded) {
+    CanDispatch d;
+    Seen a = {};
+    for (uint16_t i = 0; i < CAN_DISPATCH_MAX; i++) CHECK(d.add(i * 2, record, &a));
+    CHECK(!d.add(0x500, record, &a));
+    CHECK_EQ(d.count(), CAN_DISPATCH_MAX);
+
+    const uint8_t frame[1] = { 0 };
+    CHECK(d.dispatch((CAN_DISPATCH_MAX - 1) * 2, frame, 1));
+    CHECK(!d.dispatch(0x500, frame, 1));
+    CHECK_EQ(d.frames(CAN_DISPATCH_MAX - 1), 1);
+}
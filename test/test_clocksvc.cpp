@@ -0,0 +1,125 @@
+#include "hosttest.h"
+#include "clocksvc.h"
+
+/* test_clocksvc.cpp - sync states, free-running across the millis() wrap, digit diffs */
+
+#define SYNC_TIMEOUT_MS 30000
+#define REBASE_MS       60000
+#define SNTP_MS         (1760000000LL * 1000)  /**< A valid time, 2025-10 */
+
+/**
+ * @struct FakeTime
+ * @brief millis() plus a system clock that reads as 1970 + uptime until "SNTP" sets it
+ */
+struct FakeTime {
+    uint32_t ms    = 0xFFFF0000UL;               /* about 65 s before the wrap */
+    int64_t  sysMs = 0;
+
+    void advance(uint32_t d) { ms += d; sysMs += d; }
+};
+
+TEST(clocksvc, no_network_stays_unsynced) {
+    ClockService c(SYNC_TIMEOUT_MS, REBASE_MS);
+    FakeTime t;
+    int64_t w;
+    CHECK_EQ(c.state(), CLOCK_UNSYNCED);
+    CHECK(!c.now(t.ms, &w));
+    for (int i = 0; i < 10; i++) { t.advance(1000); CHECK(!c.poll(t.ms, t.sysMs)); }
+    CHECK_EQ(c.state(), CLOCK_UNSYNCED);
+    CHECK(!c.now(t.ms, &w));
+}
+
+TEST(clocksvc, syncing_times_out) {
+    ClockService c(SYNC_TIMEOUT_MS, REBASE_MS);
+    FakeTime t;
+    c.startSync(t.ms);
+    CHECK_EQ(c.state(), CLOCK_SYNCING);
+    for (int i = 0; i < 29; i++) { t.advance(1000); CHECK(!c.poll(t.ms, t.sysMs)); }
+    CHECK_EQ(c.state(), CLOCK_SYNCING);
+    t.advance(1000);                             /* across the wrap */
+    CHECK(c.poll(t.ms, t.sysMs));
+    CHECK_EQ(c.state(), CLOCK_UNSYNCED);
+    CHECK_EQ(c.syncs(), 0);
+}
+
+TEST(clocksvc, stop_sync_only_leaves_syncing) {
+    ClockService c(SYNC_TIMEOUT_MS, REBASE_MS);
+    FakeTime t;
+    c.startSync(t.ms);
+    c.stopSync();
+    CHECK_EQ(c.state(), CLOCK_UNSYNCED);
+
+    c.startSync(t.ms);
+    t.sysMs = SNTP_MS;
+    CHECK(c.poll(t.ms, t.sysMs));
+    c.stopSync();                                /* network drop keeps the time */
+    CHECK(c.synced());
+    c.startSync(t.ms);                           /* and so does reconnecting */
+    CHECK(c.synced());
+}
+
+TEST(clocksvc, free_runs_across_the_wrap) {
+    ClockService c(SYNC_TIMEOUT_MS, REBASE_MS);
+    FakeTime t;
+    int64_t w;
+    c.startSync(t.ms);
+    t.advance(1500);
+    t.sysMs = SNTP_MS + 250;                     /* set mid-second */
+    CHECK(c.poll(t.ms, t.sysMs));
+    CHECK(c.synced());
+    CHECK_EQ(c.syncs(), 1);
+    REQUIRE(c.now(t.ms, &w));
+    CHECK_EQ(w, t.sysMs);
+
+    c.stopSync();
+    int wrong = 0;
+    for (int i = 0; i < 200; i++) {
+        t.advance(333);
+        if (!c.now(t.ms, &w) || w != t.sysMs) wrong++;
+        c.poll(t.ms, t.sysMs);
+    }
+    CHECK_EQ(wrong, 0);
+    CHECK(t.ms < 0x10000000UL);                  /* wrapped */
+    CHECK_EQ(c.syncs(), 1);
+}
+
+TEST(clocksvc, correction_is_taken_at_the_next_rebase) {
+    ClockService c(SYNC_TIMEOUT_MS, REBASE_MS);
+    FakeTime t;
+    int64_t w;
+    t.sysMs = SNTP_MS;
+    CHECK(c.poll(t.ms, t.sysMs));                /* valid while UNSYNCED: straight to SYNCED */
+    CHECK(c.synced());
+
+    t.sysMs += 5000;                             /* SNTP steps the system clock */
+    t.advance(1000);
+    c.poll(t.ms, t.sysMs);
+    REQUIRE(c.now(t.ms, &w));
+    CHECK_EQ(t.sysMs - w, 5000);                 /* still on the old base */
+
+    t.advance(REBASE_MS);                        /* crosses the millis() wrap */
+    c.poll(t.ms, t.sysMs);
+    REQUIRE(c.now(t.ms, &w));
+    CHECK_EQ(w, t.sysMs);
+}
+
+TEST(clocksvc, format_hms) {
+    char text[CLOCK_TEXT_LEN + 1];
+    clockFormatHms(0, text);
+    CHECK(strcmp(text, "00:00:00") == 0);
+    clockFormatHms(86399, text);
+    CHECK(strcmp(text, "23:59:59") == 0);
+    clockFormatHms(86400 + 3723, text);          /* wraps to the next day */
+    CHECK(strcmp(text, "01:02:03") == 0);
+}
+
+TEST(clocksvc, digits_report_changed_characters) {
+    ClockDigits d;
+    CHECK_EQ(d.update("12:34:56"), 0xFF);
+    CHECK_EQ(d.update("12:34:57"), 0x80);
+    CHECK_EQ(d.update("12:35:00"), (1 << 4) | (1 << 6) | (1 << 7));
+    CHECK_EQ(d.update("12:35:00"), 0);
+    CHECK_EQ(d.update("--:--:--"), 0xDB);        /* colons stay */
+    d.invalidate();
+    CHECK_EQ(d.update("--:--:--"), 0xFF);
+}
@@ -0,0 +1,357 @@
+#include <vector>
+#include "hosttest.h"
+#include "fbcapture.h"
+#include "crc16.h"
+
+/* test_fbcapture.cpp - encoder against a reference decoder (as tools/fbcapture.py) */
+
+#define W 64
+#define H 40
+
+/**
+ * @class MockScreen
+ * @brief Framebuffer the encoder reads rows from
+ */
+class MockScreen : public FbcPixelSource {
+public:
+    uint16_t px[H][W];
+    void readRow(int y, uint16_t* out, int width) override { memcpy(out, px[y], width * 2); }
+};
+
+/**
+ * @class MockSink
+ * @brief Collects the byte stream; room() can be capped to model a slow port
+ */
+class MockSink : public FbcSink {
+public:
+    std::vector<uint8_t> bytes;
+    size_t roomPerStep = 100000;
+    size_t room() override { return roomPerStep; }
+    size_t write(const uint8_t* data, size_t len) override {
+        bytes.insert(bytes.end(), data, data + len);
+        return len;
+    }
+    void log(const char* text) { bytes.insert(bytes.end(), text, text + strlen(text)); }
+};
+
+/**
+ * @class Decoder
+ * @brief Chunk reader plus frame decoder; keeps the previous frame for SKIP
+ */
+class Decoder {
+public:
+    uint16_t rows[H][W];
+    bool     haveFrame = false;
+    int      frames = 0;
+    int      badChunks = 0;
+    int      badFrames = 0;
+    uint16_t lastSeq = 0;
+
+    void feed(const std::vector<uint8_t>& stream) {
+        size_t i = 0;
+        while (i + FBC_CHUNK_OVERHEAD <= stream.size()) {
+            if (stream[i] != FBC_SYNC0 || stream[i + 1] != FBC_SYNC1) { i++; continue; }
+            const size_t n = stream[i + 2] | (stream[i + 3] << 8);
+            if (n > FBC_CHUNK_MAX || i + FBC_CHUNK_OVERHEAD + n > stream.size()) { i++; continue; }
+            const uint16_t crc = stream[i + 4 + n] | (stream[i + 5 + n] << 8);
+            if (crc16Ccitt(&stream[i + 4], n) != crc) { badChunks++; i++; continue; }
+            _payload.insert(_payload.end(), stream.begin() + i + 4, stream.begin() + i + 4 + n);
+            i += FBC_CHUNK_OVERHEAD + n;
+        }
+        while (frame()) {}
+    }
+
+private:
+    std::vector<uint8_t> _payload;
+
+    static uint16_t u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+    /** @brief Decodes one complete frame from the front of the payload. */
+    bool frame() {
+        const std::vector<uint8_t>& p = _payload;
+        if (p.size() < FBC_HEADER_LEN) return false;
+        const uint32_t magic = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        if (magic != FBC_MAGIC || p[4] != FBC_VERSION) { badFrames++; _payload.clear(); return false; }
+        const uint8_t flags = p[5];
+        if (u16(&p[6]) != W || u16(&p[8]) != H) { badFrames++; _payload.clear(); return false; }
+
+        uint16_t out[H][W];
+        size_t pos = FBC_HEADER_LEN;
+        int y = 0;
+        while (y < H) {
+            if (pos >= p.size()) return false; /* wait for more */
+            const uint8_t op = p[pos++];
+            if (op == FBC_OP_SKIP) {
+                if (pos >= p.size()) return false;
+                for (int n = p[pos++]; n > 0 && y < H; n--, y++) memcpy(out[y], rows[y], W * 2);
+            } else if (op == FBC_OP_REPEAT) {
+                if (y == 0) { badFrames++; _payload.clear(); return false; }
+                memcpy(out[y], out[y - 1], W * 2);
+                y++;
+            } else if (op == FBC_OP_DATA) {
+                int x = 0;
+                while (x < W) {
+                    if (pos >= p.size()) return false;
+                    const uint8_t t = p[pos++];
+                    const int n = (t & 0x7F) + 1;
+                    if (t & 0x80) {
+                        if (pos + 2 > p.size()) return false;
+                        for (int k = 0; k < n && x < W; k++) out[y][x++] = u16(&p[pos]);
+                        pos += 2;
+                    } else {
+                        if (pos + 2 * n > p.size()) return false;
+                        for (int k = 0; k < n && x < W; k++) out[y][x++] = u16(&p[pos + 2 * k]);
+                        pos += 2 * n;
+                    }
+                }
+                y++;
+            } else {
+                badFrames++; _payload.clear(); return false;
+            }
+        }
+        if (pos + 3 > p.size()) return false;
+        if (p[pos] != FBC_OP_END) { badFrames++; _payload.clear(); return false; }
+        const uint16_t frameCrc = u16(&p[pos + 1]);
+        pos += 3;
+
+        uint16_t crc = 0xFFFF;
+        for (int r = 0; r < H; r++) {
+            const uint16_t rc = crc16Ccitt((const uint8_t*)out[r], W * 2);
+            uint8_t c[2] = { (uint8_t)(rc & 0xFF), (uint8_t)(rc >> 8) };
+            crc = crc16Ccitt(c, 2, crc);
+        }
+        if (crc != frameCrc || (!haveFrame && !(flags & FBC_FLAG_KEYFRAME))) {
+            badFrames++;
+        } else {
+            memcpy(rows, out, sizeof(rows));
+            haveFrame = true;
+            frames++;
+            lastSeq = u16(&p[10]);
+        }
+        _payload.erase(_payload.begin(), _payload.begin() + pos);
+        return true;
+    }
+};
+
+static uint32_t lcg = 12345;
+static uint16_t rnd() { lcg = lcg * 1103515245u + 12345u; return (uint16_t)(lcg >> 16); }
+
+/** @brief Something like a UI: flat background, runs, a noisy patch, repeated rows */
+static void paint(MockScreen& s) {
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) s.px[y][x] = 0x1082;
+    }
+    for (int x = 0; x < W; x++) s.px[0][x] = (uint16_t)x; /* all literals */
+    for (int y = 5; y < 20; y++) {
+        for (int x = 10; x < 50; x++) s.px[y][x] = rnd();
+    }
+    for (int y = 25; y < 30; y++) {
+        for (int x = 0; x < W; x++) s.px[y][x] = (x < 3) ? 0xF800 : 0x07E0;
+    }
+}
+
+/** @brief Chunk payloads joined, for checking the coded bytes themselves */
+static std::vector<uint8_t> payload(const std::vector<uint8_t>& stream) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i + FBC_CHUNK_OVERHEAD <= stream.size();) {
+        const size_t n = stream[i + 2] | (stream[i + 3] << 8);
+        out.insert(out.end(), stream.begin() + i + 4, stream.begin() + i + 4 + n);
+        i += FBC_CHUNK_OVERHEAD + n;
+    }
+    return out;
+}
+
+static bool sameAs(const Decoder& d, const MockScreen& s) {
+    return memcmp(d.rows, s.px, sizeof(s.px)) == 0;
+}
+
+/** @brief Runs a frame to completion, at most maxRows rows per step. */
+static int capture(FrameCapture& fc, MockScreen& s, MockSink& sink, bool keyframe, uint8_t maxRows = 4) {
+    if (!fc.begin(keyframe)) return -1;
+    int steps = 1;
+    while (!fc.step(s, sink, maxRows)) {
+        if (++steps > 10000) return -1;
+    }
+    return steps;
+}
+
+TEST(fbcapture, keyframe_round_trip) {
+    MockScreen s;
+    paint(s);
+    FrameCapture fc(W, H);
+    MockSink sink;
+    REQUIRE(capture(fc, s, sink, false) > 0); /* first frame is a keyframe regardless */
+
+    Decoder d;
+    d.feed(sink.bytes);
+    CHECK_EQ(d.frames, 1);
+    CHECK_EQ(d.badFrames, 0);
+    CHECK(sameAs(d, s));
+    CHECK_EQ(d.lastSeq, fc.sequence());
+    CHECK_EQ(fc.frameRowsSkipped(), 0);
+    CHECK(fc.frameCodedBytes() < fc.frameRawBytes());
+}
+
+TEST(fbcapture, delta_frame_skips_unchanged_rows) {
+    MockScreen s;
+    paint(s);
+    FrameCapture fc(W, H);
+    MockSink sink;
+    Decoder d;
+    REQUIRE(capture(fc, s, sink, false) > 0);
+    const uint32_t keyBytes = fc.frameCodedBytes();
+
+    s.px[33][7] = 0xFFFF;
+    s.px[2][0] = 0x001F;
+    REQUIRE(capture(fc, s, sink, false) > 0);
+    d.feed(sink.bytes);
+    CHECK_EQ(d.frames, 2);
+    CHECK_EQ(d.badFrames, 0);
+    CHECK(sameAs(d, s));
+    CHECK_EQ(fc.frameRowsSkipped(), H - 2);
+    CHECK(fc.frameCodedBytes() < keyBytes / 4);
+
+    /* Unchanged screen: one SKIP run and the end marker */
+    sink.bytes.clear();
+    REQUIRE(capture(fc, s, sink, false) > 0);
+    d.feed(sink.bytes);
+    CHECK_EQ(d.frames, 3);
+    CHECK(sameAs(d, s));
+    CHECK_EQ(fc.frameCodedBytes(), FBC_HEADER_LEN + 2 + 3);
+}
+
+TEST(fbcapture, long_runs_and_literals_split_at_128) {
+    /* Widest screen so tokens have to split */
+    static const int WIDE = FBC_MAX_WIDTH;
+    class WideScreen : public FbcPixelSource {
+    public:
+        void readRow(int y, uint16_t* out, int width) override {
+            for (int x = 0; x < width; x++) out[x] = (y & 1) ? (uint16_t)(x * 7 + y) : 0x5555;
+        }
+    } wide;
+    FrameCapture fc(WIDE, 4);
+    MockSink sink;
+    REQUIRE(fc.begin(true));
+    while (!fc.step(wide, sink, 4)) {}
+
+    /* Row 0 is one colour: DATA + 3 run tokens (128 + 128 + 64) */
+    const std::vector<uint8_t> coded = payload(sink.bytes);
+    REQUIRE(coded.size() > FBC_HEADER_LEN + 11 + 2 * 257);
+    const uint8_t* p = coded.data() + FBC_HEADER_LEN;
+    CHECK_EQ(p[0], FBC_OP_DATA);
+    CHECK_EQ(p[1], 0x80 | 127);
+    CHECK_EQ(p[4], 0x80 | 127);
+    CHECK_EQ(p[7], 0x80 | 63);
+    /* Row 1 is all different: literal tokens of 128, 128, 64 */
+    CHECK_EQ(p[10], FBC_OP_DATA);
+    CHECK_EQ(p[11], 127);
+    CHECK_EQ(p[11 + 1 + 256], 127);
+    CHECK_EQ(p[11 + 2 * 257], 63);
+}
+
+TEST(fbcapture, repeated_rows_cost_one_byte) {
+    MockScreen s;
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) s.px[y][x] = (uint16_t)(x * 3);
+    }
+    FrameCapture fc(W, H);
+    MockSink sink;
+    REQUIRE(capture(fc, s, sink, true) > 0);
+    /* header + one literal row (op + token + 2 * W) + H-1 REPEAT + END */
+    CHECK_EQ(fc.frameCodedBytes(), FBC_HEADER_LEN + 1 + 1 + 2 * W + (H - 1) + 3);
+
+    Decoder d;
+    d.feed(sink.bytes);
+    CHECK_EQ(d.frames, 1);
+    CHECK(sameAs(d, s));
+}
+
+TEST(fbcapture, slow_sink_throttles_without_loss) {
+    MockScreen s;
+    paint(s);
+    FrameCapture fc(W, H);
+    MockSink sink;
+    sink.roomPerStep = FBC_CHUNK_OVERHEAD + FBC_CHUNK_MIN;
+    const int steps = capture(fc, s, sink, true, 40);
+    REQUIRE(steps > 0);
+    CHECK(steps > 1); /* could not finish in one step with 38 bytes per chunk */
+
+    Decoder d;
+    d.feed(sink.bytes);
+    CHECK_EQ(d.frames, 1);
+    CHECK(sameAs(d, s));
+
+    /* Less room than a minimum chunk: nothing is written, nothing is lost */
+    FrameCapture fc2(W, H);
+    MockSink stalled;
+    stalled.roomPerStep = FBC_CHUNK_MIN;
+    REQUIRE(fc2.begin(true));
+    for (int i = 0; i < 20; i++) CHECK(!fc2.step(s, stalled, 4));
+    CHECK(stalled.bytes.empty());
+    stalled.roomPerStep = 100000;
+    while (!fc2.step(s, stalled, 4)) {}
+    Decoder d2;
+    d2.feed(stalled.bytes);
+    CHECK_EQ(d2.frames, 1);
+    CHECK(sameAs(d2, s));
+}
+
+TEST(fbcapture, log_text_between_chunks_is_ignored) {
+    MockScreen s;
+    paint(s);
+    FrameCapture fc(W, H);
+    MockSink sink;
+    sink.roomPerStep = 120;
+    REQUIRE(fc.begin(true));
+    while (!fc.step(s, sink, 2)) sink.log("CYD: log line\r\n");
+
+    Decoder d;
+    d.feed(sink.bytes);
+    CHECK_EQ(d.frames, 1);
+    CHECK_EQ(d.badChunks, 0);
+    CHECK(sameAs(d, s));
+}
+
+TEST(fbcapture, corrupt_chunk_is_dropped_and_frame_rejected) {
+    MockScreen s;
+    paint(s);
+    FrameCapture fc(W, H);
+    MockSink sink;
+    REQUIRE(capture(fc, s, sink, true) > 0);
+    sink.bytes[40] ^= 0x10; /* inside the first chunk's payload */
+
+    Decoder d;
+    d.feed(sink.bytes);
+    CHECK(d.badChunks >= 1);
+    CHECK_EQ(d.frames, 0);
+
+    /* After invalidate() the next frame is a keyframe the host can start from */
+    fc.invalidate();
+    sink.bytes.clear();
+    REQUIRE(capture(fc, s, sink, false) > 0);
+    Decoder fresh;
+    fresh.feed(sink.bytes);
+    CHECK_EQ(fresh.frames, 1);
+    CHECK(sameAs(fresh, s));
+}
+
+TEST(fbcapture, begin_refused_while_busy_and_abort_forces_keyframe) {
+    MockScreen s;
+    paint(s);
+    FrameCapture fc(W, H);
+    MockSink sink;
+    REQUIRE(capture(fc, s, sink, true) > 0);
+
+    REQUIRE(fc.begin(false));
+    CHECK(fc.busy());
+    CHECK(!fc.begin(false));
+    fc.abort();
+    CHECK(!fc.busy());
+
+    sink.bytes.clear();
+    REQUIRE(capture(fc, s, sink, false) > 0);
+    CHECK_EQ(fc.frameRowsSkipped(), 0);
+    const std::vector<uint8_t> coded = payload(sink.bytes);
+    REQUIRE(coded.size() > FBC_HEADER_LEN);
+    CHECK(coded[5] & FBC_FLAG_KEYFRAME);
+}
@@ -0,0 +1,203 @@
+#include <vector>
+#include "hosttest.h"
+#include "imgasset.h"
+#include "splash.h"
+
+/* test_imgasset.cpp - ImgDecoder against an encoder written after tools/imgasset.py */
+
+/**
+ * @brief Palette indices -> token stream, the same choices as imgasset.py encode():
+ *        runs of 3+ (or 2 with no literal open), literals otherwise, 128 per token.
+ */
+static std::vector<uint8_t> encode(const std::vector<uint8_t>& idx) {
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> literal;
+    auto flush = [&]() {
+        size_t i = 0;
+        while (i < literal.size()) {
+            const size_t n = (literal.size() - i < IMG_TOKEN_MAX) ? literal.size() - i : IMG_TOKEN_MAX;
+            out.push_back((uint8_t)(n - 1));
+            out.insert(out.end(), literal.begin() + i, literal.begin() + i + n);
+            i += n;
+        }
+        literal.clear();
+    };
+
+    size_t i = 0;
+    while (i < idx.size()) {
+        size_t j = i;
+        while (j < idx.size() && j - i < IMG_TOKEN_MAX && idx[j] == idx[i]) j++;
+        if (j - i >= 3 || (j - i == 2 && literal.empty())) {
+            flush();
+            out.push_back((uint8_t)(IMG_RUN_FLAG | (j - i - 1)));
+            out.push_back(idx[i]);
+        } else {
+            literal.insert(literal.end(), idx.begin() + i, idx.begin() + j);
+        }
+        i = j;
+    }
+    flush();
+    return out;
+}
+
+/** @brief Decodes the whole asset block pixels at a time. */
+static std::vector<uint16_t> decodeAll(const ImgAsset& a, size_t block, ImgDecoder& d) {
+    std::vector<uint16_t> out;
+    std::vector<uint16_t> buf(block);
+    d.begin(a);
+    size_t n;
+    while ((n = d.read(buf.data(), block)) > 0) out.insert(out.end(), buf.begin(), buf.begin() + n);
+    return out;
+}
+
+static uint32_t lcg = 777;
+static uint32_t rnd() { lcg = lcg * 1103515245u + 12345u; return lcg >> 16; }
+
+/**
+ * @struct TestImage
+ * @brief Palette, indices and the encoded asset built from them
+ */
+struct TestImage {
+    uint16_t w, h;
+    std::vector<uint16_t> palette;
+    std::vector<uint8_t>  idx;
+    std::vector<uint8_t>  data;
+    ImgAsset asset;
+
+    TestImage(uint16_t width, uint16_t height, uint16_t colours) : w(width), h(height) {
+        for (uint16_t c = 0; c < colours; c++) palette.push_back((uint16_t)(c * 0x0841 + 7));
+        /* Flat areas, long runs across rows, and noise */
+        for (uint32_t p = 0; p < (uint32_t)w * h; p++) {
+            const uint32_t y = p / w;
+            uint8_t v;
+            if (y < h / 3) v = 0;
+            else if (y < h / 2) v = (uint8_t)((p / 5) % colours);
+            else v = (uint8_t)(rnd() % colours);
+            idx.push_back(v);
+        }
+        seal();
+    }
+
+    void seal() {
+        data = encode(idx);
+        asset = { w, h, (uint16_t)palette.size(), palette.data(), data.data(), (uint32_t)data.size() };
+    }
+
+    std::vector<uint16_t> expected() const {
+        std::vector<uint16_t> px;
+        for (uint8_t i : idx) px.push_back(palette[i]);
+        return px;
+    }
+};
+
+TEST(imgasset, round_trip_at_every_block_size) {
+    TestImage img(57, 23, 13);
+    const std::vector<uint16_t> want = img.expected();
+    ImgDecoder d;
+    int bad = 0;
+    for (size_t block = 1; block <= 512; block++) {
+        if (decodeAll(img.asset, block, d) != want || !d.done() || d.failed()) bad++;
+    }
+    CHECK_EQ(bad, 0);
+}
+
+TEST(imgasset, tokens_split_at_128) {
+    TestImage img(300, 2, 1);                    /* 600 pixels of one colour */
+    CHECK_EQ(img.data.size(), 2 * 5);            /* 4 x 128 + 88 */
+    CHECK_EQ(img.data[0], IMG_RUN_FLAG | 127);
+    CHECK_EQ(img.data[8], IMG_RUN_FLAG | 87);
+
+    for (size_t i = 0; i < img.idx.size(); i++) img.idx[i] = (uint8_t)(i % 2); /* no runs */
+    img.palette.push_back(0xBEEF);
+    img.seal();
+    CHECK_EQ(img.data[0], 127);
+    CHECK_EQ(img.data[129], 127);
+    ImgDecoder d;
+    CHECK(decodeAll(img.asset, 100, d) == img.expected());
+}
+
+TEST(imgasset, full_palette) {
+    TestImage img(64, 64, 256);
+    ImgDecoder d;
+    CHECK(decodeAll(img.asset, 77, d) == img.expected());
+    CHECK(!d.failed());
+}
+
+TEST(imgasset, splash_asset_decodes_exactly) {
+    ImgDecoder d;
+    const std::vector<uint16_t> one = decodeAll(splashAsset, 1, d);
+    CHECK(!d.failed());
+    CHECK(d.done());
+    CHECK_EQ(one.size(), (size_t)SPLASH_WIDTH * SPLASH_HEIGHT);
+    CHECK(decodeAll(splashAsset, 256, d) == one);
+    CHECK(decodeAll(splashAsset, 509, d) == one);
+    CHECK_EQ(one[0], splashPalette[2]);          /* blue frame */
+    CHECK(imgAssetBytes(splashAsset) < 2UL * SPLASH_WIDTH * SPLASH_HEIGHT / 10);
+}
+
+TEST(imgasset, read_after_the_end_and_restart) {
+    TestImage img(10, 10, 4);
+    ImgDecoder d;
+    uint16_t buf[200];
+    d.begin(img.asset);
+    CHECK_EQ(d.remaining(), 100);
+    CHECK_EQ(d.read(buf, 200), 100);
+    CHECK_EQ(d.read(buf, 200), 0);
+    CHECK(d.done());
+
+    d.begin(img.asset);
+    CHECK_EQ(d.read(buf, 30), 30);
+    CHECK_EQ(d.remaining(), 70);
+
+    ImgDecoder idle;
+    CHECK_EQ(idle.read(buf, 10), 0);             /* no begin() */
+}
+
+TEST(imgasset, truncated_stream_fails) {
+    TestImage img(40, 20, 9);
+    const std::vector<uint16_t> want = img.expected();
+    ImgDecoder d;
+    int wrong = 0;
+    for (uint32_t cut = 0; cut < img.data.size(); cut++) {
+        ImgAsset a = img.asset;
+        a.length = cut;
+        const std::vector<uint16_t> got = decodeAll(a, 64, d);
+        if (!d.failed() || d.done()) wrong++;
+        /* Whatever came out before the cut is correct */
+        for (size_t i = 0; i < got.size(); i++) if (got[i] != want[i]) { wrong++; break; }
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+TEST(imgasset, index_outside_the_palette_fails) {
+    TestImage img(20, 4, 3);
+    ImgDecoder d;
+    uint16_t buf[128];
+
+    /* Run colour */
+    std::vector<uint8_t> run = { IMG_RUN_FLAG | 9, 3 };
+    ImgAsset a = { 10, 1, 3, img.palette.data(), run.data(), (uint32_t)run.size() };
+    d.begin(a);
+    CHECK_EQ(d.read(buf, 128), 0);
+    CHECK(d.failed());
+
+    /* Literal: the good pixels before the bad index are delivered */
+    std::vector<uint8_t> lit = { 4, 0, 1, 2, 7, 0 };
+    ImgAsset b = { 5, 1, 3, img.palette.data(), lit.data(), (uint32_t)lit.size() };
+    d.begin(b);
+    CHECK_EQ(d.read(buf, 128), 3);
+    CHECK(d.failed());
+    CHECK_EQ(buf[2], img.palette[2]);
+    CHECK_EQ(d.read(buf, 128), 0);               /* stays failed */
+}
+
+TEST(imgasset, trailing_bytes_are_ignored) {
+    TestImage img(16, 8, 5);
+    img.data.push_back(0x00);
+    img.data.push_back(0x00);
+    img.asset.data = img.data.data();
+    img.asset.length = (uint32_t)img.data.size();
+    ImgDecoder d;
+    CHECK(decodeAll(img.asset, 16, d) == img.expected());
+    CHECK(!d.failed());
+}
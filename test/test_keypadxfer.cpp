@@ -0,0 +1,307 @@
+#include "hosttest.h"
+#include "keypadxfer.h"
+#include "keypadlayout.h"
+#include "crc16.h"
+
+/* test_keypadxfer.cpp - layout download between KeypadXferTx and KeypadXferRx over an
+ * in-memory link that drops, duplicates and reorders frames in either direction */
+
+#define LINK_DEPTH   64
+#define XFER_BLOCK   8
+#define XFER_TIMEOUT 50
+#define XFER_RETRIES 20
+
+/**
+ * @class LossyLink
+ * @brief One direction of the bus. Faults are given in percent and drawn from a
+ *        fixed-seed generator, so every run of a test sees the same frames.
+ */
+class LossyLink {
+public:
+    LossyLink() : dropPct(0), dupPct(0), swapPct(0), corruptAt(-1), _count(0), _seen(0), _seed(1) {}
+
+    void seed(uint32_t s) { _seed = s ? s : 1; }
+
+    static void send(const uint8_t* frame, uint8_t len, void* ctx) {
+        static_cast<LossyLink*>(ctx)->push(frame, len);
+    }
+
+    void push(const uint8_t* frame, uint8_t len) {
+        Frame f;
+        memcpy(f.data, frame, len);
+        f.len = len;
+        if (_seen++ == corruptAt) f.data[len - 1] ^= 0x5A;
+        if (roll(dropPct)) return;
+        append(f);
+        if (roll(dupPct)) append(f);
+        if (_count >= 2 && roll(swapPct)) {
+            Frame t = _q[_count - 1];
+            _q[_count - 1] = _q[_count - 2];
+            _q[_count - 2] = t;
+        }
+    }
+
+    /** @brief Delivers everything queued so far to rx/tx. */
+    template <typename End>
+    void deliver(End& end, uint32_t now) {
+        const uint8_t n = _count;
+        Frame batch[LINK_DEPTH];
+        memcpy(batch, _q, sizeof(Frame) * n);
+        _count = 0;
+        for (uint8_t i = 0; i < n; i++) end.onFrame(batch[i].data, batch[i].len, now);
+    }
+
+    uint8_t dropPct;
+    uint8_t dupPct;
+    uint8_t swapPct;   /**< Frame swapped with the one queued before it */
+    int32_t corruptAt; /**< Index of a frame to damage, -1 for none */
+
+private:
+    struct Frame {
+        uint8_t data[KPX_FRAME_LEN];
+        uint8_t len;
+    };
+
+    bool roll(uint8_t pct) {
+        _seed = _seed * 1103515245u + 12345u;
+        return pct != 0 && ((_seed >> 16) % 100) < pct;
+    }
+
+    void append(const Frame& f) {
+        if (_count < LINK_DEPTH) _q[_count++] = f;
+    }
+
+    Frame   _q[LINK_DEPTH];
+    uint8_t _count;
+    int32_t _seen;
+    uint32_t _seed;
+};
+
+/**
+ * @struct XferRun
+ * @brief Sender, receiver and both link directions, stepped 1 ms at a time
+ */
+struct XferRun {
+    XferRun()
+        : rx(rxBuf, sizeof(rxBuf), XFER_BLOCK, XFER_TIMEOUT, XFER_RETRIES, LossyLink::send, &toTx),
+          tx(XFER_TIMEOUT, XFER_RETRIES, LossyLink::send, &toRx), now(0) {}
+
+    /** @brief Runs until both ends have finished, or limitMs */
+    void run(const uint8_t* blob, size_t len, uint32_t limitMs = 200000) {
+        tx.start(7, blob, len, now);
+        while (now < limitMs) {
+            toRx.deliver(rx, now);
+            toTx.deliver(tx, now);
+            const bool rxDone = (rx.state() == KeypadXferRx::COMPLETE || rx.state() == KeypadXferRx::FAILED);
+            const bool txDone = (tx.state() == KeypadXferTx::DONE || tx.state() == KeypadXferTx::FAILED);
+            if (rxDone && txDone) break;
+            now++;
+            rx.poll(now);
+            tx.poll(now);
+        }
+    }
+
+    bool received(const uint8_t* blob, size_t len) const {
+        return rx.complete() && rx.length() == len && memcmp(rx.data(), blob, len) == 0;
+    }
+
+    uint8_t      rxBuf[KPL_MAX_LEN];
+    LossyLink    toRx;
+    LossyLink    toTx;
+    KeypadXferRx rx;
+    KeypadXferTx tx;
+    uint32_t     now;
+};
+
+/** @brief Pseudo-random test blob */
+static void fillBlob(uint8_t* blob, size_t len, uint32_t seed) {
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        blob[i] = (uint8_t)(seed >> 24);
+    }
+}
+
+static uint16_t framesFor(size_t len) {
+    return (uint16_t)((len + KPX_BYTES_PER_FRAME - 1) / KPX_BYTES_PER_FRAME);
+}
+
+TEST(keypadxfer, clean_link_sends_each_frame_once) {
+    static uint8_t blob[1000];
+    fillBlob(blob, sizeof(blob), 1);
+    XferRun r;
+    r.run(blob, sizeof(blob));
+
+    CHECK(r.received(blob, sizeof(blob)));
+    CHECK_EQ(r.tx.state(), KeypadXferTx::DONE);
+    CHECK_EQ(r.tx.framesSent(), 1u + framesFor(sizeof(blob)));
+    CHECK_EQ(r.rx.gapCount(), 0u);
+    CHECK_EQ(r.rx.retryCount(), 0u);
+}
+
+TEST(keypadxfer, sizes_at_frame_edges) {
+    static uint8_t blob[KPL_MAX_LEN];
+    fillBlob(blob, sizeof(blob), 2);
+    const size_t sizes[] = { 1, 5, 6, 7, 48, 49, KPL_MAX_LEN };
+    for (size_t len : sizes) {
+        XferRun r;
+        r.run(blob, len);
+        CHECK(r.received(blob, len));
+    }
+}
+
+TEST(keypadxfer, duplicated_cts_does_not_resend_blocks) {
+    /* Every FLOW frame arrives twice: each block must still go out once */
+    static uint8_t blob[2000];
+    fillBlob(blob, sizeof(blob), 3);
+    XferRun r;
+    r.toTx.dupPct = 100;
+    r.run(blob, sizeof(blob));
+
+    CHECK(r.received(blob, sizeof(blob)));
+    CHECK_EQ(r.tx.framesSent(), 1u + framesFor(sizeof(blob)));
+    CHECK_EQ(r.rx.gapCount(), 0u);
+}
+
+TEST(keypadxfer, duplicated_data_is_ignored) {
+    static uint8_t blob[2000];
+    fillBlob(blob, sizeof(blob), 4);
+    XferRun r;
+    r.toRx.dupPct = 100;
+    r.run(blob, sizeof(blob));
+
+    CHECK(r.received(blob, sizeof(blob)));
+    CHECK_EQ(r.tx.framesSent(), 1u + framesFor(sizeof(blob)));
+    CHECK_EQ(r.rx.gapCount(), 0u); /* a repeat is not a gap */
+}
+
+TEST(keypadxfer, drops_in_both_directions) {
+    static uint8_t blob[3000];
+    fillBlob(blob, sizeof(blob), 5);
+    const uint8_t rates[] = { 5, 10, 20 };
+    for (uint8_t rate : rates) {
+        for (uint32_t seed = 1; seed <= 8; seed++) {
+            XferRun r;
+            r.toRx.seed(seed);
+            r.toTx.seed(seed * 7919);
+            r.toRx.dropPct = rate;
+            r.toTx.dropPct = rate;
+            r.run(blob, sizeof(blob));
+            CHECK(r.received(blob, sizeof(blob)));
+            CHECK_EQ(r.tx.state(), KeypadXferTx::DONE);
+        }
+    }
+}
+
+TEST(keypadxfer, reordering) {
+    static uint8_t blob[3000];
+    fillBlob(blob, sizeof(blob), 6);
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        XferRun r;
+        r.toRx.seed(seed);
+        r.toTx.seed(seed + 100);
+        r.toRx.swapPct = 20;
+        r.toTx.swapPct = 20;
+        r.run(blob, sizeof(blob));
+        CHECK(r.received(blob, sizeof(blob)));
+    }
+}
+
+TEST(keypadxfer, all_faults_stay_bounded) {
+    static uint8_t blob[KPL_MAX_LEN];
+    fillBlob(blob, sizeof(blob), 7);
+    for (uint32_t seed = 1; seed <= 16; seed++) {
+        XferRun r;
+        r.toRx.seed(seed);
+        r.toTx.seed(~seed);
+        r.toRx.dropPct = 5;  r.toRx.dupPct = 10; r.toRx.swapPct = 10;
+        r.toTx.dropPct = 5;  r.toTx.dupPct = 30; r.toTx.swapPct = 10;
+        r.run(blob, sizeof(blob));
+        CHECK(r.received(blob, sizeof(blob)));
+        /* Recovery resends blocks, but duplicates must not multiply them */
+        CHECK(r.tx.framesSent() < 3u * framesFor(sizeof(blob)));
+    }
+}
+
+TEST(keypadxfer, corrupted_payload_fails_crc) {
+    static uint8_t blob[500];
+    fillBlob(blob, sizeof(blob), 8);
+    XferRun r;
+    r.toRx.corruptAt = 10; /* FIRST is frame 0: damage DATA 9 */
+    r.run(blob, sizeof(blob));
+
+    CHECK_EQ(r.rx.state(), KeypadXferRx::FAILED);
+    CHECK_EQ(r.tx.state(), KeypadXferTx::FAILED); /* ABORT reached the sender */
+    CHECK(crc16Ccitt(r.rx.data(), r.rx.length()) != crc16Ccitt(blob, sizeof(blob)));
+}
+
+TEST(keypadxfer, oversized_transfer_rejected) {
+    static uint8_t blob[KPL_MAX_LEN + 6];
+    fillBlob(blob, sizeof(blob), 9);
+    XferRun r;
+    r.run(blob, sizeof(blob));
+    CHECK_EQ(r.rx.state(), KeypadXferRx::FAILED);
+    CHECK_EQ(r.tx.state(), KeypadXferTx::FAILED);
+    CHECK_EQ(r.tx.framesSent(), 1u);
+}
+
+TEST(keypadxfer, silent_sender_is_abandoned) {
+    static uint8_t blob[600];
+    fillBlob(blob, sizeof(blob), 10);
+    XferRun r;
+    r.tx.start(7, blob, sizeof(blob), 0);
+    r.toRx.deliver(r.rx, 0);                     /* FIRST only; the sender then vanishes */
+    for (uint32_t t = 1; t <= XFER_TIMEOUT * (XFER_RETRIES + 2); t++) r.rx.poll(t);
+    CHECK_EQ(r.rx.state(), KeypadXferRx::FAILED);
+    CHECK_EQ(r.rx.retryCount(), (uint32_t)XFER_RETRIES);
+}
+
+TEST(keypadxfer, received_layout_opens_and_busy_receiver_waits) {
+    uint8_t blob[KPL_MAX_LEN];
+    KeypadLayoutWriter w(blob, sizeof(blob), 2);
+    const uint8_t sw = 3;
+    CHECK(w.beginPage("LIGHTS"));
+    CHECK(w.addButton(10, 50, 145, 70, 0xF800, 0x120, KPL_ICON_LIGHTBAR, KPL_FLAG_STATEFUL, &sw, 1, "BAR"));
+    CHECK(w.addButton(165, 50, 145, 70, 0x07E0, 0x121, KPL_ICON_NONE, 0, NULL, 0, "AUX"));
+    CHECK(w.beginPage("CAB"));
+    CHECK(w.addButton(10, 130, 300, 70, 0x001F, 0x122, KPL_ICON_SEAT_WARMER, 0, NULL, 0, "SEAT"));
+    const size_t len = w.finish();
+    REQUIRE(len > 0);
+
+    XferRun r;
+    r.toRx.dropPct = 10;
+    r.toTx.dupPct = 20;
+    r.run(blob, len);
+    REQUIRE(r.received(blob, len));
+
+    /* What the CYD commits to flash: a layout that validates and reads back */
+    KeypadLayout layout;
+    REQUIRE(layout.open(r.rx.data(), r.rx.length()));
+    CHECK_EQ(layout.pageCount(), 2);
+    CHECK(strcmp(layout.page(0).title(), "LIGHTS") == 0);
+    CHECK_EQ(layout.page(0).buttonCount(), 2);
+    KeypadButtonView b = layout.page(0).button(0);
+    CHECK(strcmp(b.label(), "BAR") == 0);
+    CHECK_EQ(b.canId(), 0x120);
+    CHECK_EQ(b.payload()[0], 3);
+    CHECK(strcmp(layout.page(1).button(0).label(), "SEAT") == 0);
+
+    /* Not consumed yet: a new transfer is told to wait, then goes through after release() */
+    KeypadXferTx tx2(XFER_TIMEOUT, XFER_RETRIES, LossyLink::send, &r.toRx);
+    r.toRx.dropPct = 0;
+    r.toTx.dupPct = 0;
+    tx2.start(8, blob, len, r.now);
+    r.toRx.deliver(r.rx, r.now);
+    r.toTx.deliver(tx2, r.now);
+    CHECK_EQ(tx2.state(), KeypadXferTx::WAIT_FLOW);
+    CHECK_EQ(tx2.framesSent(), 1u);
+
+    r.rx.release();
+    for (uint32_t t = r.now; t < r.now + 10 * XFER_TIMEOUT && tx2.state() == KeypadXferTx::WAIT_FLOW; t++) {
+        tx2.poll(t);
+        r.rx.poll(t);
+        r.toRx.deliver(r.rx, t);
+        r.toTx.deliver(tx2, t);
+    }
+    CHECK_EQ(tx2.state(), KeypadXferTx::DONE);
+    CHECK(r.received(blob, len));
+}
@@ -0,0 +1,225 @@
+#include "hosttest.h"
+#include "nodelist.h"
+
+/* test_nodelist.cpp - sort, filter, paging, row geometry and dirty rows */
+
+#define SLOTS 20
+#define TOP   50
+#define PITCH 30
+#define ROWS  6
+
+/**
+ * @class FakeTable
+ * @brief Node table in plain arrays; ID 0 marks an empty slot
+ */
+class FakeTable : public NodeListSource {
+public:
+    uint32_t id[SLOTS] = {};
+    uint32_t seen[SLOTS] = {};
+    uint16_t activity[SLOTS] = {};
+    uint8_t  slots = SLOTS;
+
+    uint8_t  slotCount() const override { return slots; }
+    uint32_t nodeId(uint8_t s) const override { return id[s]; }
+    uint32_t nodeLastSeen(uint8_t s) const override { return seen[s]; }
+    uint16_t nodeActivity(uint8_t s) const override { return activity[s]; }
+};
+
+/**
+ * @struct Fixture
+ * @brief View with its buffers over a table of 14 nodes in scrambled slots
+ */
+struct Fixture {
+    FakeTable t;
+    uint8_t order[SLOTS];
+    uint8_t position[SLOTS];
+    NodeListView v;
+
+    Fixture() : v(order, position, SLOTS, TOP, PITCH, ROWS) {
+        /* IDs 0x1A000000 + 0x10 * k in reverse slot order over slots 4..19, with gaps */
+        uint32_t k = 0;
+        for (int s = SLOTS - 1; s >= 4; s--) {
+            if (s == 9 || (s >= 15 && s <= 17)) continue;
+            t.id[s] = 0x1A000000UL + 0x10 * k++;
+        }
+        t.id[0] = 0x2B000001UL;
+        t.id[1] = 0x1B000002UL;
+        v.rebuild(t, 1000);
+    }
+};
+
+/** @brief Slots listed in order, page by page */
+static int collect(NodeListView& v, int* out) {
+    int n = 0;
+    v.setPage(0);
+    for (uint8_t p = 0; p < v.pageCount(); p++) {
+        v.setPage(p);
+        for (uint8_t r = 0; r < v.visibleCount(); r++) out[n++] = v.slotAtRow(r);
+    }
+    v.setPage(0);
+    return n;
+}
+
+TEST(nodelist, pages_cover_every_node_once_in_id_order) {
+    Fixture f;
+    CHECK_EQ(f.v.count(), 14);         /* 12 in slots 4..19, plus slots 0 and 1 */
+    CHECK_EQ(f.v.pageCount(), 3);      /* 14 nodes, 6 rows */
+
+    int slots[SLOTS];
+    const int n = collect(f.v, slots);
+    REQUIRE(n == f.v.count());
+    for (int i = 1; i < n; i++) CHECK(f.t.id[slots[i - 1]] < f.t.id[slots[i]]);
+
+    f.v.setPage(2);
+    CHECK_EQ(f.v.visibleCount(), 2);
+    CHECK_EQ(f.v.slotAtRow(2), -1); /* past the last node */
+    CHECK_EQ(f.v.slotAtRow(1), 0);  /* 0x2B... sorts last */
+}
+
+TEST(nodelist, page_navigation_wraps_and_clears_dirty_rows) {
+    Fixture f;
+    CHECK(!f.v.setPage(0));        /* already there */
+    CHECK(!f.v.setPage(3));        /* does not exist */
+    CHECK(f.v.prevPage());
+    CHECK_EQ(f.v.page(), 2);
+    CHECK(f.v.nextPage());
+    CHECK_EQ(f.v.page(), 0);
+
+    f.v.markSlotDirty(f.v.slotAtRow(1));
+    CHECK(f.v.nextPage());
+    CHECK_EQ(f.v.takeDirtyRows(), 0); /* new page is painted whole */
+}
+
+TEST(nodelist, hit_test_uses_the_drawn_geometry) {
+    Fixture f;
+    CHECK_EQ(f.v.hitTest(TOP - 1), -1);
+    CHECK_EQ(f.v.hitTest(TOP), f.v.slotAtRow(0));
+    CHECK_EQ(f.v.hitTest(TOP + PITCH - 1), f.v.slotAtRow(0));
+    CHECK_EQ(f.v.hitTest(TOP + PITCH), f.v.slotAtRow(1));
+    CHECK_EQ(f.v.hitTest(f.v.bottom() - 1), f.v.slotAtRow(ROWS - 1));
+    CHECK_EQ(f.v.hitTest(f.v.bottom()), -1);
+
+    f.v.setPage(2); /* two rows: the empty rows below them are not touchable */
+    CHECK_EQ(f.v.hitTest(f.v.rowTop(1) + 5), f.v.slotAtRow(1));
+    CHECK_EQ(f.v.hitTest(f.v.rowTop(2) + 5), -1);
+}
+
+TEST(nodelist, row_of_slot_and_dirty_rows_follow_the_page) {
+    Fixture f;
+    const int onPage1 = (f.v.setPage(1), f.v.slotAtRow(3));
+    f.v.setPage(0);
+    CHECK_EQ(f.v.rowOfSlot(onPage1), -1);
+    f.v.markSlotDirty(onPage1);        /* not visible: no repaint */
+    CHECK_EQ(f.v.takeDirtyRows(), 0);
+
+    f.v.setPage(1);
+    CHECK_EQ(f.v.rowOfSlot(onPage1), 3);
+    f.v.markSlotDirty(onPage1);
+    f.v.markSlotDirty(f.v.slotAtRow(0));
+    f.v.markSlotDirty(3);              /* empty slot */
+    CHECK_EQ(f.v.takeDirtyRows(), (1 << 3) | (1 << 0));
+    CHECK_EQ(f.v.takeDirtyRows(), 0);
+    CHECK_EQ(f.v.rowOfSlot(-1), -1);
+    CHECK_EQ(f.v.rowOfSlot(SLOTS), -1);
+}
+
+TEST(nodelist, rebuild_keeps_the_page_or_clamps_it) {
+    Fixture f;
+    f.v.setPage(2);
+    f.v.rebuild(f.t, 2000);
+    CHECK_EQ(f.v.page(), 2);
+
+    /* Filter down to one page: the page clamps to the last one */
+    f.v.pushFilterDigit(0x2);
+    f.v.rebuild(f.t, 2000);
+    CHECK_EQ(f.v.count(), 1);
+    CHECK_EQ(f.v.pageCount(), 1);
+    CHECK_EQ(f.v.page(), 0);
+    CHECK_EQ(f.v.slotAtRow(0), 0);
+}
+
+TEST(nodelist, filter_by_hex_prefix) {
+    Fixture f;
+    char text[12];
+    CHECK(f.v.pushFilterDigit(0x1));
+    CHECK(f.v.pushFilterDigit(0xB));
+    CHECK(!f.v.pushFilterDigit(0x10));
+    f.v.formatFilter(text, sizeof(text));
+    CHECK(strcmp(text, "1B") == 0);
+    f.v.rebuild(f.t, 1000);
+    CHECK_EQ(f.v.count(), 1);
+    CHECK_EQ(f.v.slotAtRow(0), 1);
+
+    CHECK(f.v.popFilterDigit());
+    f.v.rebuild(f.t, 1000);
+    CHECK_EQ(f.v.count(), 13); /* every 0x1... node */
+
+    /* Eight digits is a full ID; a ninth is refused */
+    f.v.clearFilter();
+    for (int i = 0; i < 8; i++) CHECK(f.v.pushFilterDigit((uint8_t)((0x2B000001UL >> (28 - 4 * i)) & 0xF)));
+    CHECK(!f.v.pushFilterDigit(0));
+    f.v.rebuild(f.t, 1000);
+    CHECK_EQ(f.v.count(), 1);
+
+    /* Nothing matches: still one (empty) page */
+    f.v.clearFilter();
+    f.v.pushFilterDigit(0xF);
+    f.v.rebuild(f.t, 1000);
+    CHECK_EQ(f.v.count(), 0);
+    CHECK_EQ(f.v.pageCount(), 1);
+    CHECK_EQ(f.v.visibleCount(), 0);
+    CHECK_EQ(f.v.hitTest(TOP), -1);
+    CHECK_EQ(f.v.slotAfter(0), -1);
+}
+
+TEST(nodelist, last_seen_and_activity_orders) {
+    Fixture f;
+    f.t.seen[5] = 0xFFFFFF00UL; /* before the millis() wrap */
+    f.t.seen[7] = 0x00000080UL;
+    f.t.seen[0] = 0x00000050UL;
+    f.v.setSort(NODE_SORT_LAST_SEEN);
+    f.v.rebuild(f.t, 0x100);
+    CHECK_EQ(f.v.slotAtRow(0), 7);  /* 0x80 ms ago */
+    CHECK_EQ(f.v.slotAtRow(1), 0);  /* 0xB0 ms ago */
+    CHECK_EQ(f.v.slotAtRow(2), 5);  /* across the wrap, still the oldest */
+    /* Never-seen nodes follow in ID order */
+    CHECK(f.t.id[f.v.slotAtRow(3)] < f.t.id[f.v.slotAtRow(4)]);
+
+    f.t.activity[12] = 40;
+    f.t.activity[1] = 40;
+    f.t.activity[8] = 90;
+    f.v.setSort(NODE_SORT_ACTIVITY);
+    f.v.rebuild(f.t, 0x100);
+    CHECK_EQ(f.v.slotAtRow(0), 8);
+    /* Tie on activity: lower ID first */
+    CHECK_EQ(f.v.slotAtRow(1), (f.t.id[12] < f.t.id[1]) ? 12 : 1);
+
+    f.v.setSort((NodeSortKey)7);
+    CHECK_EQ(f.v.sort(), NODE_SORT_ID);
+}
+
+TEST(nodelist, slot_after_cycles_in_list_order) {
+    Fixture f;
+    int slots[SLOTS];
+    const int n = collect(f.v, slots);
+    for (int i = 0; i < n; i++) CHECK_EQ(f.v.slotAfter(slots[i]), slots[(i + 1) % n]);
+    CHECK_EQ(f.v.slotAfter(3), slots[0]);  /* unlisted slot: start over */
+    CHECK_EQ(f.v.slotAfter(-1), slots[0]);
+}
+
+TEST(nodelist, capacity_and_row_limits) {
+    uint8_t order[255];
+    uint8_t position[255];
+    NodeListView big(order, position, 255, 0, 10, 40);
+    CHECK_EQ(big.rows(), NODELIST_MAX_ROWS);
+
+    /* Source with more slots than the view: the extra slots are ignored */
+    FakeTable t;
+    for (int s = 0; s < SLOTS; s++) t.id[s] = 100 + s;
+    uint8_t o[8], p[8];
+    NodeListView small(o, p, 8, 0, 10, 3);
+    small.rebuild(t, 0);
+    CHECK_EQ(small.count(), 8);
+    CHECK_EQ(small.pageCount(), 3);
+    CHECK_EQ(small.rowOfSlot(9), -1);
+}
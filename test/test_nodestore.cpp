@@ -0,0 +1,215 @@
+#include "hosttest.h"
+#include "nodestore.h"
+
+/* test_nodestore.cpp - blob format and the persister's debounce, rate limit and CRC skip */
+
+#define NS_MAX      8
+#define NS_DEBOUNCE 5000
+#define NS_INTERVAL 60000
+
+/** @brief In-memory backend that counts writes and can be made to fail */
+class MemNodeStore : public NodeStore {
+public:
+    MemNodeStore() : len(0), saves(0), failNext(false) {}
+
+    size_t load(uint8_t* buf, size_t cap) override {
+        if (len > cap) return 0;
+        memcpy(buf, blob, len);
+        return len;
+    }
+
+    bool save(const uint8_t* buf, size_t n) override {
+        if (failNext) { failNext = false; return false; }
+        memcpy(blob, buf, n);
+        len = n;
+        saves++;
+        return true;
+    }
+
+    uint8_t blob[NODESTORE_BLOB_LEN(NS_MAX)];
+    size_t  len;
+    int     saves;
+    bool    failNext;
+};
+
+static const NodeRecord sampleNodes[3] = {
+    { 0xDEADBEEF, 5, 2, { 0, 0 } },
+    { 0x00001234, -1, 0, { 0, 0 } },
+    { 0x0A0B0C0D, 31, 8, { 0, 0 } },
+};
+
+TEST(nodestore, encode_decode_round_trip) {
+    uint8_t blob[NODESTORE_BLOB_LEN(NS_MAX)];
+    const size_t len = nodeStoreEncode(sampleNodes, 3, blob, sizeof(blob));
+    CHECK_EQ(len, NODESTORE_BLOB_LEN(3));
+
+    NodeRecord out[NS_MAX];
+    REQUIRE(nodeStoreDecode(blob, len, out, NS_MAX) == 3);
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQ(out[i].id, sampleNodes[i].id);
+        CHECK_EQ(out[i].lastColorIdx, sampleNodes[i].lastColorIdx);
+        CHECK_EQ(out[i].stripCount, sampleNodes[i].stripCount);
+    }
+
+    /* Records beyond maxRecs are dropped, not an error */
+    CHECK_EQ(nodeStoreDecode(blob, len, out, 2), 2);
+}
+
+TEST(nodestore, decode_rejects_damage) {
+    uint8_t blob[NODESTORE_BLOB_LEN(NS_MAX)];
+    const size_t len = nodeStoreEncode(sampleNodes, 3, blob, sizeof(blob));
+    NodeRecord out[NS_MAX];
+
+    CHECK_EQ(nodeStoreEncode(sampleNodes, 3, blob, len - 1), 0u);
+    CHECK_EQ(nodeStoreDecode(blob, len - 1, out, NS_MAX), -1);   /* truncated */
+
+    blob[NODESTORE_HEADER_LEN + 1] ^= 0x01;                       /* payload bit flip */
+    CHECK_EQ(nodeStoreDecode(blob, len, out, NS_MAX), -1);
+    blob[NODESTORE_HEADER_LEN + 1] ^= 0x01;
+
+    blob[4] = NODESTORE_VERSION + 1;                              /* old firmware's layout */
+    CHECK_EQ(nodeStoreDecode(blob, len, out, NS_MAX), -1);
+}
+
+TEST(nodestore, debounce_waits_for_quiet) {
+    MemNodeStore store;
+    uint8_t buf[NODESTORE_BLOB_LEN(NS_MAX)];
+    NodeTablePersister p(store, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+
+    p.markDirty(1000);
+    CHECK(!p.service(sampleNodes, 2, 1000 + NS_DEBOUNCE - 1));
+    p.markDirty(4000);                                            /* another change restarts the wait */
+    CHECK(!p.service(sampleNodes, 2, 1000 + NS_DEBOUNCE));
+    CHECK(p.service(sampleNodes, 2, 4000 + NS_DEBOUNCE));
+    CHECK_EQ(store.saves, 1);
+    CHECK(!p.isDirty());
+
+    /* Clean table: nothing to do however late it gets */
+    CHECK(!p.service(sampleNodes, 2, 1000000));
+    CHECK_EQ(store.saves, 1);
+}
+
+TEST(nodestore, rate_limit_between_writes) {
+    MemNodeStore store;
+    uint8_t buf[NODESTORE_BLOB_LEN(NS_MAX)];
+    NodeTablePersister p(store, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+
+    p.markDirty(0);
+    CHECK(p.service(sampleNodes, 2, NS_DEBOUNCE));
+
+    p.markDirty(NS_DEBOUNCE + 100);
+    CHECK(!p.service(sampleNodes, 3, NS_DEBOUNCE + 100 + NS_DEBOUNCE));  /* debounced, but too soon */
+    CHECK(p.isDirty());
+    CHECK(p.service(sampleNodes, 3, NS_DEBOUNCE + NS_INTERVAL));
+    CHECK_EQ(store.saves, 2);
+}
+
+TEST(nodestore, unchanged_table_skips_write) {
+    MemNodeStore store;
+    uint8_t buf[NODESTORE_BLOB_LEN(NS_MAX)];
+    NodeTablePersister p(store, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+
+    p.markDirty(0);
+    CHECK(p.service(sampleNodes, 3, NS_DEBOUNCE));
+
+    /* Marked dirty (e.g. a node re-announced itself) but the content is the same */
+    p.markDirty(100000);
+    CHECK(!p.service(sampleNodes, 3, 100000 + NS_DEBOUNCE));
+    CHECK(!p.isDirty());
+    CHECK_EQ(store.saves, 1);
+    CHECK_EQ(p.writeCount(), 1u);
+
+    /* A fresh persister learns the stored CRC from restore() */
+    MemNodeStore copy = store;
+    NodeTablePersister q(copy, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+    NodeRecord out[NS_MAX];
+    CHECK_EQ(q.restore(out, NS_MAX), 3);
+    q.markDirty(0);
+    CHECK(!q.service(out, 3, NS_DEBOUNCE));
+    CHECK_EQ(copy.saves, 1);
+}
+
+TEST(nodestore, failed_write_retries) {
+    MemNodeStore store;
+    uint8_t buf[NODESTORE_BLOB_LEN(NS_MAX)];
+    NodeTablePersister p(store, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+
+    store.failNext = true;
+    p.markDirty(0);
+    CHECK(!p.service(sampleNodes, 2, NS_DEBOUNCE));
+    CHECK(p.isDirty());
+    CHECK_EQ(p.failCount(), 1u);
+
+    CHECK(!p.service(sampleNodes, 2, NS_DEBOUNCE + 1000));       /* failures are rate limited too */
+    CHECK(p.service(sampleNodes, 2, NS_DEBOUNCE + NS_INTERVAL));
+    CHECK_EQ(store.saves, 1);
+}
+
+TEST(nodestore, restore_ignores_corrupt_blob) {
+    MemNodeStore store;
+    uint8_t buf[NODESTORE_BLOB_LEN(NS_MAX)];
+    store.len = nodeStoreEncode(sampleNodes, 2, store.blob, sizeof(store.blob));
+    store.blob[store.len - 1] ^= 0xFF;
+
+    NodeTablePersister p(store, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+    NodeRecord out[NS_MAX];
+    CHECK_EQ(p.restore(out, NS_MAX), 0);
+
+    /* Nothing valid stored, so even the same content gets written */
+    p.markDirty(0);
+    CHECK(p.service(sampleNodes, 2, NS_DEBOUNCE));
+}
+
+/**
+ * @struct Node
+ * @brief The ARGBNode members eviction looks at
+ */
+struct Node {
+    uint32_t id;
+    uint32_t lastSeen;
+    bool     active;
+    bool     confirmed;
+};
+
+TEST(nodestore, full_table_evicts_unconfirmed_then_longest_silent) {
+    const uint32_t now = 0x00000100UL;
+    Node t[NS_MAX] = {};
+    for (int i = 0; i < NS_MAX; i++) t[i] = { 0x100u + i, now - 10, true, true };
+    CHECK_EQ(nodeStoreEvictSlot(t, NS_MAX, now), -1);  /* all heard: nothing to evict */
+
+    t[2] = { 0x102, 0xFFFFFF00UL, false, true };       /* timed out before the millis() wrap */
+    t[6] = { 0x106, 0x00000010UL, false, true };
+    CHECK_EQ(nodeStoreEvictSlot(t, NS_MAX, now), 2);
+
+    t[5] = { 0x105, 0, false, false };                 /* restored, never heard since boot */
+    t[7] = { 0x107, 0, false, false };
+    CHECK_EQ(nodeStoreEvictSlot(t, NS_MAX, now), 5);
+
+    t[5].id = 0;                                       /* empty slots are not candidates */
+    CHECK_EQ(nodeStoreEvictSlot(t, NS_MAX, now), 7);
+}
+
+TEST(nodestore, evicted_slot_is_persisted_on_the_next_service) {
+    /* A full table restored from flash, then one node the store has not seen */
+    MemNodeStore store;
+    uint8_t buf[NODESTORE_BLOB_LEN(NS_MAX)];
+    NodeTablePersister p(store, buf, sizeof(buf), NS_DEBOUNCE, NS_INTERVAL);
+    NodeRecord recs[NS_MAX];
+    for (int i = 0; i < NS_MAX; i++) recs[i] = { 0x200u + i, 0, 1, { 0, 0 } };
+    p.markDirty(0);
+    REQUIRE(p.service(recs, NS_MAX, NS_DEBOUNCE));
+    REQUIRE(p.restore(recs, NS_MAX) == NS_MAX);
+
+    Node t[NS_MAX];
+    for (int i = 0; i < NS_MAX; i++) t[i] = { recs[i].id, 0, false, false };
+    const int slot = nodeStoreEvictSlot(t, NS_MAX, 2 * NS_INTERVAL);
+    REQUIRE(slot == 0);
+    recs[slot].id = 0x0BADF00D;
+    p.markDirty(2 * NS_INTERVAL);
+    CHECK(p.service(recs, NS_MAX, 2 * NS_INTERVAL + NS_DEBOUNCE));
+
+    NodeRecord back[NS_MAX];
+    REQUIRE(p.restore(back, NS_MAX) == NS_MAX);
+    CHECK_EQ(back[0].id, 0x0BADF00D);
+    CHECK_EQ(store.saves, 2);
+}
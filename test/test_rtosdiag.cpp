@@ -0,0 +1,231 @@
+#include <string>
+#include <vector>
+#include "hosttest.h"
+#include "rtosdiag.h"
+
+/* test_rtosdiag.cpp - DiagAggregator fed by a stubbed task table */
+
+#define TICK_US 1000000 /**< Run-time units per core per sample */
+
+/**
+ * @class FakeRtos
+ * @brief Task table with cumulative run-time counters, as uxTaskGetSystemState() reports it
+ */
+class FakeRtos {
+public:
+    DiagTaskInput tasks[DIAG_MAX_TASKS + 4];
+    uint8_t  count = 0;
+    uint32_t total = 0;
+    uint32_t counters[DIAG_COUNTER_COUNT] = {};
+
+    int add(const char* name, uint32_t stackFree, int8_t core = 1) {
+        tasks[count] = { name, 0, stackFree, core };
+        return count++;
+    }
+
+    /** @brief Advances one sample period; share[i] is task i's permille of it */
+    void run(const uint16_t* share) {
+        total += TICK_US;
+        for (uint8_t i = 0; i < count; i++) tasks[i].runTime += (uint32_t)share[i] * (TICK_US / 1000);
+    }
+
+    void sample(DiagAggregator& a, const uint16_t* fill = NULL, uint8_t only = 0xFF) {
+        a.sample(tasks, (only == 0xFF) ? count : only, total, fill, counters);
+    }
+};
+
+static void collect(const char* text, void* ctx) {
+    ((std::vector<std::string>*)ctx)->push_back(text);
+}
+
+TEST(rtosdiag, cpu_share_per_task_from_the_second_sample) {
+    DiagAggregator a;
+    FakeRtos r;
+    r.add("DisplayTask", 3000);
+    r.add("TouchTask", 1800);
+    r.add("IDLE1", 900);
+    const uint16_t share[3] = { 250, 50, 700 };
+
+    r.sample(a);                                 /* base only */
+    CHECK_EQ(a.task(0).cpu.size(), 0);
+    for (int s = 0; s < 5; s++) { r.run(share); r.sample(a); }
+
+    CHECK(a.hasRunTime());
+    CHECK_EQ(a.samples(), 6);
+    CHECK_EQ(a.taskCount(), 3);
+    CHECK_EQ(a.task(0).cpu.size(), 5);
+    CHECK_EQ(a.task(0).cpu.latest(), 250);
+    CHECK_EQ(a.task(1).cpu.mean(), 50);
+    CHECK_EQ(a.task(2).cpu.max(), 700);
+    CHECK_EQ(a.task(0).core, 1);
+}
+
+TEST(rtosdiag, vanished_task_is_absent_then_restarts_its_base) {
+    DiagAggregator a;
+    FakeRtos r;
+    r.add("DisplayTask", 3000);
+    r.add("CanRx", 1200, 0);
+    const uint16_t share[2] = { 100, 300 };
+    r.sample(a);
+    r.run(share);
+    r.sample(a);
+    CHECK_EQ(a.task(1).cpu.size(), 1);
+
+    /* CanRx missing for two samples (deleted and recreated) */
+    for (int s = 0; s < 2; s++) { r.run(share); r.sample(a, NULL, 1); }
+    CHECK(!a.task(1).present);
+    CHECK_EQ(a.tightestStack(), 0);              /* absent tasks do not count */
+
+    /* Back: its counter ran on meanwhile, so the first sample is a base, not 3 periods */
+    r.run(share);
+    r.sample(a);
+    CHECK(a.task(1).present);
+    CHECK_EQ(a.task(1).cpu.size(), 1);
+    r.run(share);
+    r.sample(a);
+    CHECK_EQ(a.task(1).cpu.size(), 2);
+    CHECK_EQ(a.task(1).cpu.latest(), 300);
+    CHECK_EQ(a.taskCount(), 2);                  /* same slot, found by name */
+    CHECK_EQ(a.tightestStack(), 1);
+}
+
+TEST(rtosdiag, run_time_counter_wrap) {
+    DiagAggregator a;
+    DiagTaskInput t = { "T", 0xFFFFFF00UL, 100, -1 };
+    a.sample(&t, 1, 0xFFFFF000UL, NULL, NULL);
+    t.runTime = 0x100;
+    a.sample(&t, 1, 0x1000, NULL, NULL);
+    CHECK_EQ(a.task(0).cpu.latest(), 62);        /* 0x200 of 0x2000 */
+
+    t.runTime += 0x10000;                        /* more than the period: capped */
+    a.sample(&t, 1, 0x2000, NULL, NULL);
+    CHECK_EQ(a.task(0).cpu.latest(), 1000);
+}
+
+TEST(rtosdiag, stack_low_water_is_kept_for_life) {
+    DiagAggregator a;
+    FakeRtos r;
+    r.add("DisplayTask", 3000);
+    r.add("TouchTask", 1800);
+    r.sample(a);
+    r.tasks[0].stackFree = 700;
+    r.sample(a);
+    r.tasks[0].stackFree = 2500;                 /* the RTOS figure never rises; ignore if it does */
+    r.sample(a);
+    CHECK_EQ(a.task(0).stackFree, 700);
+    CHECK_EQ(a.task(1).stackFree, 1800);
+    CHECK_EQ(a.tightestStack(), 0);
+}
+
+TEST(rtosdiag, without_run_time_stats_only_stacks) {
+    DiagAggregator a;
+    FakeRtos r;
+    r.add("DisplayTask", 3000);
+    for (int s = 0; s < 3; s++) a.sample(r.tasks, r.count, 0, NULL, NULL);
+    CHECK(!a.hasRunTime());
+    CHECK_EQ(a.task(0).cpu.size(), 0);
+
+    std::vector<std::string> lines;
+    a.report(collect, &lines);
+    REQUIRE(lines.size() == 1 + DIAG_COUNTER_COUNT);
+    CHECK(lines[0].find("cpu") == std::string::npos);
+    CHECK(lines[0].find("stack free 3000") != std::string::npos);
+}
+
+TEST(rtosdiag, queue_fill_and_peak) {
+    DiagAggregator a;
+    CHECK_EQ(a.addQueue("touch", 5), 0);
+    CHECK_EQ(a.addQueue("big", 1000), 1);
+    for (int i = 2; i < DIAG_MAX_QUEUES; i++) CHECK_EQ(a.addQueue("q", 4), i);
+    CHECK_EQ(a.addQueue("extra", 4), -1);
+
+    FakeRtos r;
+    for (int s = 0; s < 12; s++) {
+        uint16_t fill[DIAG_MAX_QUEUES] = { (uint16_t)(s % 6), (uint16_t)(s * 100) };
+        r.sample(a, fill);
+    }
+    CHECK_EQ(a.queue(0).peak, 5);
+    CHECK_EQ(a.queue(0).fill.latest(), 5);
+    CHECK_EQ(a.queue(1).peak, 1100);
+    CHECK_EQ(a.queue(1).fill.latest(), 255);     /* ring stores a byte */
+
+    r.sample(a, NULL);                           /* no fill figures: empty */
+    CHECK_EQ(a.queue(0).fill.latest(), 0);
+    CHECK_EQ(a.queue(0).peak, 5);
+}
+
+TEST(rtosdiag, counter_deltas_per_sample) {
+    DiagAggregator a;
+    FakeRtos r;
+    r.sample(a);
+    r.counters[DIAG_SPI_TIMEOUT] += 3;
+    r.sample(a);
+    r.sample(a);
+    r.counters[DIAG_TOUCH_QUEUE_FULL] += 70000;
+    r.sample(a);
+
+    CHECK_EQ(a.counterTotal(DIAG_SPI_TIMEOUT), 3);
+    CHECK_EQ(a.counterHistory(DIAG_SPI_TIMEOUT).max(), 3);
+    CHECK_EQ(a.counterHistory(DIAG_SPI_TIMEOUT).latest(), 0);
+    CHECK_EQ(a.counterTotal(DIAG_TOUCH_QUEUE_FULL), 70000);
+    CHECK_EQ(a.counterHistory(DIAG_TOUCH_QUEUE_FULL).latest(), 0xFFFF);
+
+    std::vector<std::string> lines;
+    a.report(collect, &lines);
+    REQUIRE(lines.size() == DIAG_COUNTER_COUNT);
+    CHECK(lines[DIAG_SPI_TIMEOUT].find("spi wait   3 (+0 last sample)") != std::string::npos);
+    CHECK(strcmp(diagCounterName(DIAG_COUNTER_COUNT), "?") == 0);
+}
+
+TEST(rtosdiag, task_table_is_bounded_and_names_truncated) {
+    DiagAggregator a;
+    FakeRtos r;
+    static char names[DIAG_MAX_TASKS + 2][8];
+    for (int i = 0; i < DIAG_MAX_TASKS + 2; i++) {
+        snprintf(names[i], sizeof(names[i]), "t%d", i);
+        r.add(names[i], 1000 + i);
+    }
+    r.sample(a);
+    CHECK_EQ(a.taskCount(), DIAG_MAX_TASKS);
+
+    DiagAggregator b;
+    DiagTaskInput t = { "AVeryLongTaskNameIndeed", 0, 500, 0 };
+    b.sample(&t, 1, 0, NULL, NULL);
+    b.sample(&t, 1, 0, NULL, NULL);
+    CHECK_EQ(b.taskCount(), 1);                  /* matched again despite the truncation */
+    CHECK_EQ(strlen(b.task(0).name), DIAG_NAME_LEN - 1);
+}
+
+TEST(rtosdiag, ring_keeps_the_newest) {
+    DiagRing<uint16_t> ring;
+    CHECK_EQ(ring.latest(), 0);
+    CHECK_EQ(ring.mean(), 0);
+    for (uint16_t i = 1; i <= DIAG_HISTORY + 5; i++) ring.push(i);
+    CHECK_EQ(ring.size(), DIAG_HISTORY);
+    CHECK_EQ(ring.at(0), 6);
+    CHECK_EQ(ring.latest(), DIAG_HISTORY + 5);
+    CHECK_EQ(ring.max(), DIAG_HISTORY + 5);
+    CHECK_EQ(ring.mean(), (6 + DIAG_HISTORY + 5) / 2);
+}
+
+TEST(rtosdiag, report_with_cpu) {
+    DiagAggregator a;
+    a.addQueue("touch", 5);
+    FakeRtos r;
+    r.add("DisplayTask", 3000, 1);
+    r.add("timer", 1500, -1);
+    const uint16_t share[2] = { 125, 5 };
+    uint16_t fill[1] = { 2 };
+    r.sample(a, fill);
+    r.run(share);
+    r.sample(a, fill);
+
+    std::vector<std::string> lines;
+    a.report(collect, &lines);
+    REQUIRE(lines.size() == 2 + 1 + DIAG_COUNTER_COUNT);
+    CHECK(lines[0].find("DisplayTask") != std::string::npos);
+    CHECK(lines[0].find("core 1 cpu  12.5%") != std::string::npos);
+    CHECK(lines[1].find("core - cpu   0.5%") != std::string::npos);
+    CHECK(lines[2].find("touch") != std::string::npos);
+    CHECK(lines[2].find("2/5 peak 2") != std::string::npos);
+}
@@ -0,0 +1,73 @@
+#include "hosttest.h"
+#include "screens.h"
+
+/* test_screens.cpp - refresh policy and the navigation stack */
+
+enum { SCR_A = 1, SCR_B, SCR_C, SCR_D, SCR_E, SCR_F, SCR_G, SCR_H };
+
+static void testDraw() {}
+static void testUpdate(uint32_t) {}
+
+static const ScreenDef testScreens[] = {
+    { SCR_A, "A", NULL, NULL, NULL, testDraw, testUpdate, 0,    UI_EVT_NETWORK },
+    { SCR_B, "B", NULL, NULL, NULL, testDraw, NULL,       1000, 0 },
+    { SCR_C, "C", NULL, NULL, NULL, testDraw, NULL,       0,    UI_EVT_NODES },
+    { SCR_D, "D", NULL, NULL, NULL, testDraw, NULL,       0,    0 },
+    { SCR_E, "E", NULL, NULL, NULL, testDraw, NULL,       0,    0 },
+    { SCR_F, "F", NULL, NULL, NULL, testDraw, NULL,       0,    0 },
+    { SCR_G, "G", NULL, NULL, NULL, testDraw, NULL,       0,    0 },
+};
+
+TEST(screens, work_follows_policy) {
+    const ScreenDef& a = testScreens[0];
+    CHECK_EQ(screenWorkFor(a, 0, 5000, 0), SCREEN_WORK_NONE);
+    CHECK_EQ(screenWorkFor(a, UI_EVT_NETWORK, 5000, 0), SCREEN_WORK_UPDATE);
+    CHECK_EQ(screenWorkFor(a, UI_EVT_SELECTION, 5000, 0), SCREEN_WORK_HEADER);
+    CHECK_EQ(screenWorkFor(testScreens[2], UI_EVT_NETWORK, 5000, 0), SCREEN_WORK_NONE); /* not its business */
+
+    /* Returning via back: every screen repaints its body, whatever its dirtyOn */
+    CHECK_EQ(screenWorkFor(testScreens[3], UI_EVT_SCREEN, 5000, 0), SCREEN_WORK_UPDATE);
+}
+
+TEST(screens, tick_interval) {
+    const ScreenDef& b = testScreens[1];
+    CHECK_EQ(screenWorkFor(b, 0, 1999, 1000), SCREEN_WORK_NONE);
+    CHECK_EQ(screenWorkFor(b, 0, 2000, 1000), SCREEN_WORK_TICK);
+    CHECK_EQ(screenWorkFor(b, UI_EVT_HEADER, 2000, 1000), SCREEN_WORK_TICK);  /* tick first */
+    CHECK_EQ(screenWorkFor(b, 0, 0x00000100u, 0xFFFFFF00u), SCREEN_WORK_NONE); /* millis() wrap */
+    CHECK_EQ(screenWorkFor(b, 0, 0x000002E0u, 0xFFFFFF00u), SCREEN_WORK_NONE); /* 992 ms */
+    CHECK_EQ(screenWorkFor(b, 0, 0x000002E8u, 0xFFFFFF00u), SCREEN_WORK_TICK);  /* 1000 ms */
+}
+
+TEST(screens, nav_push_back_replace) {
+    ScreenNav nav(testScreens, 7);
+    CHECK(!nav.reset(SCR_H));                 /* unregistered */
+    CHECK(nav.current() == NULL);
+
+    REQUIRE(nav.reset(SCR_A));
+    CHECK(!nav.back());                       /* root stays */
+    CHECK(nav.push(SCR_B));
+    CHECK(nav.push(SCR_B));                   /* already on top: no second entry */
+    CHECK_EQ(nav.depth(), 2);
+    CHECK(nav.replace(SCR_C));                /* e.g. menu -> picked screen */
+    CHECK_EQ(nav.currentId(), SCR_C);
+    CHECK(nav.back());
+    CHECK_EQ(nav.currentId(), SCR_A);         /* back lands on the opener */
+    CHECK(strcmp(nav.current()->title, "A") == 0);
+}
+
+TEST(screens, nav_overflow_keeps_root) {
+    ScreenNav nav(testScreens, 7);
+    nav.reset(SCR_A);
+    for (uint8_t id = SCR_B; id <= SCR_G; id++) CHECK(nav.push(id));
+    CHECK_EQ(nav.depth(), SCREEN_NAV_DEPTH);
+    CHECK_EQ(nav.currentId(), SCR_G);
+
+    /* The oldest entry above the root was dropped */
+    uint8_t seen[SCREEN_NAV_DEPTH];
+    uint8_t n = 0;
+    do { seen[n++] = nav.currentId(); } while (nav.back());
+    CHECK_EQ(n, SCREEN_NAV_DEPTH);
+    CHECK_EQ(seen[n - 1], SCR_A);
+    CHECK_EQ(seen[n - 2], SCR_C);
+}
@@ -0,0 +1,170 @@
+#include <thread>
+#include <atomic>
+#include "hosttest.h"
+#include "spsc.h"
+
+/* test_spsc.cpp - the CAN -> UI channels under two real threads */
+
+#define QUEUE_LEN   64
+#define ITEMS       200000
+
+/**
+ * @struct Item
+ * @brief Queue payload with a check word, so a half-copied slot shows up
+ */
+struct Item {
+    uint32_t seq;
+    uint32_t check; /**< ~seq */
+};
+
+/**
+ * @struct Wide
+ * @brief Latest-value payload wider than one word; every field derives from n
+ */
+struct Wide {
+    uint32_t n;
+    uint32_t twice;
+    uint32_t inverted;
+    uint16_t low;
+    uint8_t  tag;
+};
+
+static Wide wideFor(uint32_t n) {
+    Wide w = { n, n * 2, ~n, (uint16_t)n, (uint8_t)(n * 7) };
+    return w;
+}
+
+static bool consistent(const Wide& w) {
+    return w.twice == w.n * 2 && w.inverted == ~w.n && w.low == (uint16_t)w.n && w.tag == (uint8_t)(w.n * 7);
+}
+
+TEST(spsc, queue_fifo_and_full) {
+    SpscQueue<Item, 4> q;
+    Item it;
+    CHECK(q.empty());
+    CHECK(!q.pop(it));
+    for (uint32_t i = 0; i < 4; i++) CHECK(q.push(Item{ i, ~i }));
+    CHECK(!q.push(Item{ 4, ~4u }));
+    CHECK_EQ(q.size(), 4);
+
+    /* Wrap the indices a few times */
+    for (uint32_t i = 0; i < 20; i++) {
+        REQUIRE(q.pop(it));
+        CHECK_EQ(it.seq, i);
+        CHECK(q.push(Item{ i + 4, ~(i + 4) }));
+    }
+    CHECK_EQ(q.size(), 4);
+}
+
+TEST(spsc, queue_threads_keep_order_and_lose_nothing) {
+    SpscQueue<Item, QUEUE_LEN> q;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < ITEMS; i++) {
+            /* A full queue is the only reason to refuse; retry the same item */
+            while (!q.push(Item{ i, ~i })) std::this_thread::yield();
+        }
+    });
+
+    uint32_t expect = 0;
+    uint32_t bad = 0;
+    Item it;
+    while (expect < ITEMS) {
+        if (!q.pop(it)) { std::this_thread::yield(); continue; }
+        if (it.seq != expect || it.check != ~it.seq) bad++;
+        expect = it.seq + 1;
+    }
+    producer.join();
+
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(expect, ITEMS);
+    CHECK(q.empty());
+}
+
+TEST(spsc, queue_threads_no_loss_below_capacity) {
+    /* Bursts of at most capacity items per round: every push must succeed first time */
+    SpscQueue<Item, QUEUE_LEN> q;
+    std::atomic<uint32_t> consumed(0);
+    std::atomic<uint32_t> refused(0);
+    const uint32_t rounds = 2000;
+
+    std::thread producer([&]() {
+        uint32_t sent = 0;
+        for (uint32_t r = 0; r < rounds; r++) {
+            while (sent - consumed.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+            const uint32_t burst = 1 + (r % QUEUE_LEN);
+            for (uint32_t k = 0; k < burst; k++, sent++) {
+                if (!q.push(Item{ sent, ~sent })) refused.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    uint32_t expect = 0;
+    uint32_t bad = 0;
+    uint32_t total = 0;
+    for (uint32_t r = 0; r < rounds; r++) total += 1 + (r % QUEUE_LEN);
+    Item it;
+    while (expect < total && refused.load(std::memory_order_relaxed) == 0) {
+        if (!q.pop(it)) { std::this_thread::yield(); continue; }
+        if (it.seq != expect || it.check != ~it.seq) bad++;
+        expect++;
+        consumed.store(expect, std::memory_order_release);
+    }
+    producer.join();
+
+    CHECK_EQ(refused.load(), 0);
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(expect, total);
+}
+
+TEST(spsc, latest_single_thread) {
+    SpscLatest<Wide> slot;
+    uint32_t seen = 0;
+    Wide w;
+    CHECK(!slot.read(w, seen));
+    slot.publish(wideFor(1));
+    slot.publish(wideFor(2));
+    REQUIRE(slot.read(w, seen));
+    CHECK_EQ(w.n, 2);
+    CHECK(consistent(w));
+    CHECK(!slot.read(w, seen)); /* nothing newer */
+}
+
+TEST(spsc, latest_threads_never_tear_or_go_back) {
+    SpscLatest<Wide> slot;
+    std::atomic<bool> done(false);
+
+    std::thread producer([&]() {
+        for (uint32_t n = 1; n <= ITEMS; n++) {
+            slot.publish(wideFor(n));
+            if ((n & 63) == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t seen = 0;
+    uint32_t last = 0;
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    Wide w;
+    for (;;) {
+        const bool finished = done.load(std::memory_order_acquire);
+        if (slot.read(w, seen)) {
+            reads++;
+            if (!consistent(w)) torn++;
+            if (w.n <= last) backwards++;
+            last = w.n;
+        } else if (finished) {
+            break;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    CHECK_EQ(torn, 0);
+    CHECK_EQ(backwards, 0);
+    CHECK_EQ(last, ITEMS); /* the newest value is always delivered */
+    CHECK(reads > 1);
+}
@@ -0,0 +1,225 @@
+#include "hosttest.h"
+#include "statemodel.h"
+
+/* test_statemodel.cpp - status decoding, the receive gate and dirty widget sets */
+
+#define PENDING_MS 1500
+
+static const uint8_t NODE[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+/** @brief Status frame for switch key; dlc 8 unless short is asked for */
+static uint8_t frame(uint8_t* out, uint8_t key, bool on, bool fault = false, uint8_t level = 0, uint8_t dlc = 8) {
+    memcpy(out, NODE, 4);
+    out[4] = key;
+    out[5] = on ? 1 : 0;
+    out[6] = fault ? 1 : 0;
+    out[7] = level;
+    return dlc;
+}
+
+static StateValue value(uint8_t flags, uint8_t level = 0) {
+    StateValue v = { (uint8_t)(flags | STATE_FLAG_KNOWN), level };
+    return v;
+}
+
+TEST(statemodel, decode_status_frame) {
+    uint8_t d[8];
+    uint8_t key = 0;
+    StateValue v;
+
+    CHECK(!decodeStatusFrame(d, frame(d, 4, true, false, 0, 5), &key, &v));
+    CHECK(!decodeStatusFrame(NULL, 8, &key, &v));
+
+    REQUIRE(decodeStatusFrame(d, frame(d, 4, true, true, 200, 6), &key, &v));
+    CHECK_EQ(key, 4);
+    CHECK_EQ(v.flags, STATE_FLAG_KNOWN | STATE_FLAG_ON); /* fault byte beyond dlc */
+    CHECK_EQ(v.level, 0);
+
+    REQUIRE(decodeStatusFrame(d, frame(d, 9, false, true, 200, 7), &key, &v));
+    CHECK_EQ(key, 9);
+    CHECK_EQ(v.flags, STATE_FLAG_KNOWN | STATE_FLAG_FAULT);
+    CHECK_EQ(v.level, 0);
+
+    REQUIRE(decodeStatusFrame(d, frame(d, 200, true, false, 128), &key, &v));
+    CHECK_EQ(key, 200);
+    CHECK_EQ(v.flags, STATE_FLAG_KNOWN | STATE_FLAG_ON);
+    CHECK_EQ(v.level, 128);
+}
+
+TEST(statemodel, visual_rounds_level_to_ten_percent) {
+    CHECK_EQ(stateVisual(value(STATE_FLAG_ON)), STATE_FLAG_KNOWN | STATE_FLAG_ON);
+    CHECK_EQ(stateVisualLevel(stateVisual(value(0, 255))), 10);
+    CHECK_EQ(stateVisualLevel(stateVisual(value(0, 1))), 0);   /* dimmable, below 5 % */
+    CHECK_EQ(stateVisualLevel(stateVisual(value(0, 128))), 5);
+    CHECK_EQ(stateVisual(value(0, 120)), stateVisual(value(0, 127))); /* same step */
+    CHECK(stateVisual(value(0, 100)) != stateVisual(value(0, 140)));
+}
+
+TEST(statemodel, gate_drops_repeats_per_key) {
+    StateGate g;
+    CHECK(g.pass(1, value(STATE_FLAG_ON)));
+    CHECK(!g.pass(1, value(STATE_FLAG_ON)));
+    CHECK(g.pass(2, value(STATE_FLAG_ON)));      /* other key, own history */
+    CHECK(!g.pass(1, value(STATE_FLAG_ON, 0)));
+    CHECK(g.pass(1, value(0)));
+    CHECK(!g.pass(2, value(STATE_FLAG_ON)));
+    CHECK(g.pass(3, value(0, 120)));
+    CHECK(!g.pass(3, value(0, 127)));            /* level inside the step */
+    CHECK_EQ(g.passed(), 4);
+    CHECK_EQ(g.dropped(), 4);
+
+    g.forget(1);
+    CHECK(g.pass(1, value(0)));
+}
+
+TEST(statemodel, gate_passes_one_unchanged_echo_after_expect) {
+    StateGate g;
+    CHECK(g.pass(7, value(STATE_FLAG_ON)));
+    g.expect(7);
+    g.expect(40);
+    CHECK(g.pass(8, value(0)));
+    CHECK(!g.pass(8, value(0)));                 /* a key nobody pressed stays gated */
+    CHECK(g.pass(7, value(STATE_FLAG_ON)));      /* unchanged, but answers the press */
+    CHECK(!g.pass(7, value(STATE_FLAG_ON)));     /* only once */
+    CHECK(g.pass(40, value(0)));
+    CHECK(!g.pass(40, value(0)));
+    g.expect(255);
+    CHECK(g.pass(255, value(0)));
+    CHECK(!g.pass(255, value(0)));
+}
+
+/**
+ * @struct Page
+ * @brief Model with widgets 0 and 3 on key 5, widget 1 on key 6, widget 31 on key 200
+ */
+struct Page {
+    StateModel m;
+    Page() {
+        m.subscribe(0, 5);
+        m.subscribe(3, 5);
+        m.subscribe(1, 6);
+        m.subscribe(31, 200);
+    }
+};
+
+TEST(statemodel, apply_marks_exactly_the_subscribers) {
+    Page p;
+    CHECK(!p.m.subscribe(STATE_MAX_WIDGETS, 5));
+
+    CHECK(p.m.apply(5, value(STATE_FLAG_ON)));
+    CHECK_EQ(p.m.takeDirtyWidgets(), (1UL << 0) | (1UL << 3));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 0);
+
+    CHECK(p.m.apply(200, value(0, 255)));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 1UL << 31);
+
+    CHECK(!p.m.apply(9, value(STATE_FLAG_ON)));  /* nobody on key 9 */
+    CHECK_EQ(p.m.takeDirtyWidgets(), 0);
+    CHECK(p.m.value(9).flags & STATE_FLAG_ON);   /* still stored */
+
+    CHECK(!p.m.apply(5, value(STATE_FLAG_ON)));  /* same rendering */
+    CHECK(!p.m.apply(200, value(0, 250)));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 0);
+    CHECK_EQ(p.m.suppressed(), 2);
+
+    CHECK(p.m.apply(6, value(STATE_FLAG_FAULT)));
+    CHECK(p.m.apply(5, value(0)));
+    CHECK_EQ(p.m.takeDirtyWidgets(), (1UL << 0) | (1UL << 1) | (1UL << 3));
+    CHECK_EQ(p.m.changes(), 5); /* key 9 changed too, it just had nobody to tell */
+}
+
+TEST(statemodel, pending_until_status_or_timeout) {
+    Page p;
+    p.m.apply(5, value(STATE_FLAG_ON));
+    p.m.takeDirtyWidgets();
+
+    CHECK(p.m.setPending(5, 1000, PENDING_MS));
+    CHECK(p.m.visual(5) & STATE_FLAG_PENDING);
+    CHECK_EQ(p.m.takeDirtyWidgets(), (1UL << 0) | (1UL << 3));
+
+    /* The echo reports the same state: pending still clears, so the widgets repaint */
+    CHECK(p.m.apply(5, value(STATE_FLAG_ON)));
+    CHECK(!(p.m.visual(5) & STATE_FLAG_PENDING));
+    CHECK_EQ(p.m.takeDirtyWidgets(), (1UL << 0) | (1UL << 3));
+
+    /* No echo: the deadline restores the last reported state */
+    CHECK(p.m.setPending(6, 2000, PENDING_MS));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 1UL << 1);
+    p.m.service(2000 + PENDING_MS - 1);
+    CHECK_EQ(p.m.takeDirtyWidgets(), 0);
+    p.m.service(2000 + PENDING_MS);
+    CHECK(!(p.m.visual(6) & STATE_FLAG_PENDING));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 1UL << 1);
+}
+
+TEST(statemodel, press_again_extends_and_deadlines_survive_wrap) {
+    Page p;
+    const uint32_t t0 = 0xFFFFFF00UL;
+    CHECK(p.m.setPending(5, t0, PENDING_MS));
+    p.m.takeDirtyWidgets();
+    CHECK(!p.m.setPending(5, t0 + 1000, PENDING_MS)); /* already pending: no repaint */
+
+    p.m.service(t0 + PENDING_MS);                     /* past the first deadline, after the wrap */
+    CHECK(p.m.visual(5) & STATE_FLAG_PENDING);
+    CHECK_EQ(p.m.takeDirtyWidgets(), 0);
+    p.m.service(t0 + 1000 + PENDING_MS);
+    CHECK(!(p.m.visual(5) & STATE_FLAG_PENDING));
+    CHECK_EQ(p.m.takeDirtyWidgets(), (1UL << 0) | (1UL << 3));
+}
+
+TEST(statemodel, pending_slots_are_bounded) {
+    Page p;
+    for (uint8_t k = 0; k < STATE_MAX_PENDING; k++) CHECK(!p.m.setPending(100 + k, 0, PENDING_MS)); /* unsubscribed */
+    for (uint8_t k = 0; k < STATE_MAX_PENDING; k++) CHECK(p.m.visual(100 + k) & STATE_FLAG_PENDING);
+    CHECK(!p.m.setPending(6, 0, PENDING_MS));         /* table full: shown as a plain press */
+    CHECK(!(p.m.visual(6) & STATE_FLAG_PENDING));
+
+    p.m.apply(100, value(0));                         /* frees a slot */
+    CHECK(p.m.setPending(6, 0, PENDING_MS));
+    p.m.service(PENDING_MS);
+    for (uint8_t k = 1; k < STATE_MAX_PENDING; k++) CHECK(!(p.m.visual(100 + k) & STATE_FLAG_PENDING));
+    CHECK(!(p.m.visual(6) & STATE_FLAG_PENDING));
+}
+
+TEST(statemodel, subscriptions_and_invalidate) {
+    Page p;
+    p.m.invalidate(3);
+    p.m.invalidate(STATE_MAX_WIDGETS);                /* ignored */
+    CHECK_EQ(p.m.takeDirtyWidgets(), 1UL << 3);
+
+    p.m.clearSubscriptions();                         /* page change */
+    CHECK(!p.m.apply(5, value(STATE_FLAG_ON)));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 0);
+
+    p.m.subscribe(2, 5);                              /* new page sees the stored state */
+    CHECK(p.m.visual(5) & STATE_FLAG_ON);
+    CHECK(p.m.apply(5, value(0)));
+    CHECK_EQ(p.m.takeDirtyWidgets(), 1UL << 2);
+}
+
+TEST(statemodel, unchanged_echo_reaches_the_model_through_the_gate) {
+    /* The receive task gate and the display task model, as wired in espcyd.cpp */
+    StateGate g;
+    Page p;
+    uint8_t d[8];
+    uint8_t key;
+    StateValue v;
+
+    REQUIRE(decodeStatusFrame(d, frame(d, 5, true), &key, &v));
+    REQUIRE(g.pass(key, v));
+    p.m.apply(key, v);
+    p.m.takeDirtyWidgets();
+
+    /* Press: the switch is already on and the node echoes "on" */
+    g.expect(5);
+    p.m.setPending(5, 0, PENDING_MS);
+    p.m.takeDirtyWidgets();
+    REQUIRE(decodeStatusFrame(d, frame(d, 5, true), &key, &v));
+    REQUIRE(g.pass(key, v));
+    CHECK(p.m.apply(key, v));
+    CHECK(!(p.m.visual(5) & STATE_FLAG_PENDING));
+    CHECK_EQ(p.m.takeDirtyWidgets(), (1UL << 0) | (1UL << 3));
+
+    /* Later repeats are gated again */
+    CHECK(!g.pass(key, v));
+}
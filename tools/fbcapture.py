@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""Decodes espcyd screen captures (see src/fbcapture.h) into PPM or PNG files.
+
+Reads the raw byte stream from a file or a serial device node, picks the
+capture chunks out of the surrounding log text (which is echoed to stderr)
+and writes one image per complete frame. Delta frames are applied to the
+previous frame; until the first keyframe arrives they are skipped.
+
+Only the standard library is used. Set the serial port up beforehand, e.g.
+    stty -F /dev/ttyUSB0 115200 raw
+    python3 tools/fbcapture.py /dev/ttyUSB0 -o shots --format png
+
+Usage: fbcapture.py INPUT [-o DIR] [--format ppm|png] [--prefix NAME]
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = 0x42465943
+VERSION = 1
+FLAG_KEYFRAME = 1 << 0
+FLAG_SWAPPED = 1 << 1
+OP_SKIP, OP_REPEAT, OP_DATA, OP_END = 0x01, 0x02, 0x03, 0xFF
+SYNC = b"\xfb\xc5"
+CHUNK_MAX = 256
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, same as src/crc16.h"""
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def chunks(stream, log):
+    """Yields chunk payloads; bytes that are not part of a valid chunk go to log."""
+    buf = bytearray()
+    while True:
+        data = stream.read(4096)
+        if not data:
+            break
+        buf += data
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                keep = 1 if buf[-1:] == SYNC[:1] else 0
+                log(buf[:len(buf) - keep])
+                del buf[:len(buf) - keep]
+                break
+            if i > 0:
+                log(buf[:i])
+                del buf[:i]
+            if len(buf) < 4:
+                break
+            n = buf[2] | (buf[3] << 8)
+            if n == 0 or n > CHUNK_MAX:
+                log(buf[:1])
+                del buf[:1]
+                continue
+            if len(buf) < n + 6:
+                break
+            payload = bytes(buf[4:4 + n])
+            if crc16(payload) == (buf[4 + n] | (buf[5 + n] << 8)):
+                yield payload
+                del buf[:n + 6]
+            else:
+                log(buf[:1])
+                del buf[:1]
+
+
+class Decoder:
+    """Rebuilds frames from the codec byte stream, one payload at a time."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.frame = None        # list of rows (lists of RGB565 ints)
+        self.have_base = False
+        self.width = self.height = 0
+
+    def feed(self, data):
+        """Returns the frames completed by this data as (seq, flags, rows, ok)."""
+        self.pending += data
+        done = []
+        while True:
+            res = self._frame()
+            if res is None:
+                break
+            done.append(res)
+        return done
+
+    def _frame(self):
+        p = self.pending
+        # Resynchronise on the frame magic
+        start = p.find(struct.pack("<I", MAGIC))
+        if start < 0:
+            del p[:max(0, len(p) - 3)]
+            return None
+        del p[:start]
+        if len(p) < 12:
+            return None
+        magic, ver, flags, w, h, seq = struct.unpack_from("<IBBHHH", p, 0)
+        if ver != VERSION or w == 0 or h == 0:
+            del p[:1]
+            return None
+
+        pos = 12
+        rows = []
+        prev_rows = self.frame if (self.have_base and (w, h) == (self.width, self.height)) else None
+        y = 0
+        while y < h:
+            if pos >= len(p):
+                return None
+            op = p[pos]
+            pos += 1
+            if op == OP_SKIP:
+                if pos >= len(p):
+                    return None
+                n = p[pos]
+                pos += 1
+                for _ in range(n):
+                    rows.append(list(prev_rows[y]) if prev_rows else [0] * w)
+                    y += 1
+            elif op == OP_REPEAT:
+                rows.append(list(rows[-1]) if rows else [0] * w)
+                y += 1
+            elif op == OP_DATA:
+                row = []
+                while len(row) < w:
+                    if pos >= len(p):
+                        return None
+                    t = p[pos]
+                    pos += 1
+                    if t & 0x80:
+                        if pos + 2 > len(p):
+                            return None
+                        row += [p[pos] | (p[pos + 1] << 8)] * ((t & 0x7F) + 1)
+                        pos += 2
+                    else:
+                        n = t + 1
+                        if pos + 2 * n > len(p):
+                            return None
+                        row += list(struct.unpack_from("<%dH" % n, p, pos))
+                        pos += 2 * n
+                rows.append(row[:w])
+                y += 1
+            else:
+                # Corrupt stream: drop this frame and look for the next header
+                del p[:1]
+                self.have_base = False
+                return None
+        if pos + 3 > len(p):
+            return None
+        if p[pos] != OP_END:
+            del p[:1]
+            self.have_base = False
+            return None
+        frame_crc = p[pos + 1] | (p[pos + 2] << 8)
+        del p[:pos + 3]
+
+        crc = 0xFFFF
+        for row in rows:
+            rc = crc16(struct.pack("<%dH" % w, *row))
+            crc = crc16(struct.pack("<H", rc), crc)
+        ok = (crc == frame_crc) and (prev_rows is not None or flags & FLAG_KEYFRAME)
+
+        self.frame, self.width, self.height = rows, w, h
+        self.have_base = ok
+        return seq, flags, rows, ok
+
+
+def to_rgb(rows, swapped):
+    out = bytearray()
+    for row in rows:
+        for c in row:
+            if swapped:
+                c = ((c & 0xFF) << 8) | (c >> 8)
+            r, g, b = (c >> 11) & 0x1F, (c >> 5) & 0x3F, c & 0x1F
+            out += bytes(((r * 527 + 23) >> 6, (g * 259 + 33) >> 6, (b * 527 + 23) >> 6))
+    return bytes(out)
+
+
+def write_ppm(path, w, h, rgb):
+    with open(path, "wb") as f:
+        f.write(b"P6\n%d %d\n255\n" % (w, h))
+        f.write(rgb)
+
+
+def write_png(path, w, h, rgb):
+    def chunk(tag, data):
+        return struct.pack(">I", len(data)) + tag + data + struct.pack(">I", zlib.crc32(tag + data) & 0xFFFFFFFF)
+
+    raw = b"".join(b"\x00" + rgb[y * w * 3:(y + 1) * w * 3] for y in range(h))
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 6)))
+        f.write(chunk(b"IEND", b""))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("input", help="capture file or serial device")
+    ap.add_argument("-o", "--outdir", default=".")
+    ap.add_argument("--format", choices=("ppm", "png"), default="png")
+    ap.add_argument("--prefix", default="cyd")
+    args = ap.parse_args()
+
+    os.makedirs(args.outdir, exist_ok=True)
+    dec = Decoder()
+    log = lambda b: sys.stderr.write(b.decode("utf-8", "replace")) if b else None
+    written = 0
+
+    with open(args.input, "rb", buffering=0) as stream:
+        for payload in chunks(stream, log):
+            for seq, flags, rows, ok in dec.feed(payload):
+                if not ok:
+                    sys.stderr.write("fbcapture: frame %d dropped (no base or CRC mismatch)\n" % seq)
+                    continue
+                rgb = to_rgb(rows, flags & FLAG_SWAPPED)
+                path = os.path.join(args.outdir, "%s_%05d.%s" % (args.prefix, seq, args.format))
+                (write_png if args.format == "png" else write_ppm)(path, dec.width, dec.height, rgb)
+                written += 1
+                print(path)
+
+    sys.stderr.write("fbcapture: %d frame(s) written\n" % written)
+
+
+if __name__ == "__main__":
+    main()
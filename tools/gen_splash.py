@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Generates src/splash.h, the boot splash for espcyd as an ImgAsset.
+
+The logo is drawn procedurally (no image libraries needed) and encoded
+with imgasset.py (palette + RLE, see src/imgasset.h).
+
+Usage: python3 tools/gen_splash.py > src/splash.h
+"""
+
+import imgasset
+
+W, H = 160, 80
+
+# RGB565 colours the drawing uses, index 0 is the screen background
+PALETTE = [
+    0x0000,  # 0 black
+    0xFFFF,  # 1 white
+    0xFFE0,  # 2 yellow
+    0x001F,  # 3 blue
+    0x7BEF,  # 4 dark grey
+    0x07E0,  # 5 green
+    0xF800,  # 6 red
+] + [0x0000] * 9
+
+# 5x7 glyphs for the letters used in the title
+GLYPHS = {
+    'C': ["01110", "10001", "10000", "10000", "10000", "10001", "01110"],
+    'A': ["01110", "10001", "10001", "11111", "10001", "10001", "10001"],
+    'N': ["10001", "11001", "10101", "10011", "10001", "10001", "10001"],
+    'Y': ["10001", "10001", "01010", "00100", "00100", "00100", "00100"],
+    'D': ["11110", "10001", "10001", "10001", "10001", "10001", "11110"],
+    ' ': ["00000"] * 7,
+}
+
+img = [[0] * W for _ in range(H)]
+
+
+def rect(x, y, w, h, c):
+    for yy in range(y, y + h):
+        for xx in range(x, x + w):
+            img[yy][xx] = c
+
+
+def text(s, x, y, scale, c):
+    for ch in s:
+        for row, bits in enumerate(GLYPHS[ch]):
+            for col, bit in enumerate(bits):
+                if bit == '1':
+                    rect(x + col * scale, y + row * scale, scale, scale, c)
+        x += 6 * scale
+
+
+# Frame
+rect(0, 0, W, 2, 3)
+rect(0, H - 2, W, 2, 3)
+rect(0, 0, 2, H, 3)
+rect(W - 2, 0, 2, H, 3)
+
+# Bus lines (CAN_H / CAN_L) with four nodes hanging off them
+rect(10, 14, W - 20, 2, 2)
+rect(10, 20, W - 20, 2, 1)
+for i, c in enumerate([5, 6, 5, 5]):
+    nx = 22 + i * 34
+    rect(nx + 6, 22, 2, 6, 4)
+    rect(nx, 28, 14, 8, c)
+
+# Title
+title = "CAN CYD"
+scale = 3
+tx = (W - (len(title) * 6 * scale - scale)) // 2
+text(title, tx, 44, scale, 1)
+
+pixels = [PALETTE[c] for row in img for c in row]
+print(imgasset.convert("splash", W, H, pixels, "a drawing", 16, stem="splash", tool="tools/gen_splash.py"), end="")
@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""Converts images into palette + RLE RGB565 assets for espcyd (see src/imgasset.h).
+
+Reads PNG (non-interlaced, any colour type, 1-8 bits per channel) or binary
+PPM (P6) files with the standard library only. Pixels are converted to
+RGB565; if that leaves more than --colours distinct values, low bits are
+dropped until it fits. The palette is ordered by frequency and the indices
+are run-length coded in raster order. A summary (flash bytes against raw
+RGB565 and the number of tokens the decoder walks) goes to stderr.
+
+Alpha is composited onto --background (RGB hex, default 000000).
+
+Usage: imgasset.py IMAGE [-n NAME] [-o HEADER] [--colours N] [--background RRGGBB]
+       python3 tools/imgasset.py art/logo.png -n logo -o src/asset_logo.h
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+RUN_FLAG = 0x80
+TOKEN_MAX = 128
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def read_ppm(data):
+    """Binary PPM (P6), maxval up to 255."""
+    fields = []
+    pos = 2
+    while len(fields) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos) + 1
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(int(data[pos:end]))
+        pos = end
+    w, h, maxval = fields
+    if maxval > 255:
+        raise ValueError("16-bit PPM not supported")
+    pos += 1
+    raw = data[pos:pos + w * h * 3]
+    scale = 255.0 / maxval
+    px = [(int(raw[i] * scale), int(raw[i + 1] * scale), int(raw[i + 2] * scale), 255)
+          for i in range(0, len(raw), 3)]
+    return w, h, px
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(data):
+    """PNG decoder for the cases image editors produce; no interlace, no 16-bit."""
+    pos = 8
+    idat = bytearray()
+    plte = []
+    trns = b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            w, h, depth, ctype, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            plte = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    if interlace:
+        raise ValueError("interlaced PNG not supported")
+    if depth > 8:
+        raise ValueError("16-bit PNG not supported")
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[ctype]
+    stride = (w * channels * depth + 7) // 8
+    bpp = max(1, channels * depth // 8)
+    raw = zlib.decompress(bytes(idat))
+
+    rows = []
+    prev = bytearray(stride)
+    for y in range(h):
+        f = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            c = prev[i - bpp] if i >= bpp else 0
+            if f == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif f == 2:
+                line[i] = (line[i] + prev[i]) & 0xFF
+            elif f == 3:
+                line[i] = (line[i] + ((a + prev[i]) >> 1)) & 0xFF
+            elif f == 4:
+                line[i] = (line[i] + paeth(a, prev[i], c)) & 0xFF
+        rows.append(line)
+        prev = line
+
+    px = []
+    maxval = (1 << depth) - 1
+    for line in rows:
+        if depth < 8:
+            per = 8 // depth
+            samples = [(line[x // per] >> (8 - depth * (x % per + 1))) & maxval for x in range(w * channels)]
+        else:
+            samples = line
+        for x in range(w):
+            s = samples[x * channels:(x + 1) * channels]
+            if ctype == 3:
+                r, g, b = plte[s[0]]
+                a = trns[s[0]] if s[0] < len(trns) else 255
+            else:
+                s = [v * 255 // maxval for v in s]
+                if ctype in (0, 4):
+                    r = g = b = s[0]
+                else:
+                    r, g, b = s[0], s[1], s[2]
+                a = s[-1] if ctype in (4, 6) else 255
+            px.append((r, g, b, a))
+    return w, h, px
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] == b"\x89PNG\r\n\x1a\n":
+        return read_png(data)
+    if data[:2] == b"P6":
+        return read_ppm(data)
+    raise ValueError("%s: not a PNG or binary PPM" % path)
+
+
+def to_rgb565(px, background=(0, 0, 0)):
+    out = []
+    for r, g, b, a in px:
+        if a < 255:
+            r = (r * a + background[0] * (255 - a)) // 255
+            g = (g * a + background[1] * (255 - a)) // 255
+            b = (b * a + background[2] * (255 - a)) // 255
+        out.append(rgb565(r, g, b))
+    return out
+
+
+def quantize(pixels, colours):
+    """Drops low bits of each channel until at most `colours` values remain."""
+    for drop in range(0, 5):
+        mask = (((0x1F << drop) & 0x1F) << 11) | (((0x3F << drop) & 0x3F) << 5) | ((0x1F << drop) & 0x1F)
+        reduced = [p & mask for p in pixels]
+        if len(set(reduced)) <= colours:
+            return reduced, drop
+    raise ValueError("cannot reduce the image to %d colours" % colours)
+
+
+def encode(pixels, colours=256):
+    """RGB565 list -> (palette, token bytes, token count, bits dropped)."""
+    pixels, drop = quantize(pixels, colours)
+    freq = {}
+    for p in pixels:
+        freq[p] = freq.get(p, 0) + 1
+    palette = sorted(freq, key=lambda c: (-freq[c], c))
+    index = {c: i for i, c in enumerate(palette)}
+    idx = [index[p] for p in pixels]
+
+    out = bytearray()
+    tokens = 0
+    i = 0
+    literal = []
+
+    def flush():
+        nonlocal tokens
+        while literal:
+            n = min(len(literal), TOKEN_MAX)
+            out.append(n - 1)
+            out.extend(literal[:n])
+            del literal[:n]
+            tokens += 1
+
+    while i < len(idx):
+        j = i
+        while j < len(idx) and j - i < TOKEN_MAX and idx[j] == idx[i]:
+            j += 1
+        if j - i >= 3 or (j - i == 2 and not literal):
+            flush()
+            out.append(RUN_FLAG | (j - i - 1))
+            out.append(idx[i])
+            tokens += 1
+        else:
+            literal.extend(idx[i:j])
+        i = j
+    flush()
+    return palette, bytes(out), tokens, drop
+
+
+def decode(w, h, palette, data):
+    """Reference decoder, mirrors ImgDecoder::read()."""
+    out = []
+    pos = 0
+    while len(out) < w * h:
+        t = data[pos]
+        n = (t & 0x7F) + 1
+        if t & RUN_FLAG:
+            out.extend([palette[data[pos + 1]]] * n)
+            pos += 2
+        else:
+            out.extend(palette[i] for i in data[pos + 1:pos + 1 + n])
+            pos += 1 + n
+    return out[:w * h]
+
+
+def header(name, w, h, palette, data, source, stem=None, tool="tools/imgasset.py"):
+    stem = stem or "asset_" + name
+    guard = "%s_H_" % stem.upper()
+    out = []
+    out.append("#ifndef %s" % guard)
+    out.append("#define %s" % guard)
+    out.append("")
+    out.append('#include "imgasset.h"')
+    out.append("")
+    out.append("/* %s.h - generated by %s from %s, do not edit */" % (stem, tool, source))
+    out.append("")
+    out.append("#define %s_WIDTH  %d" % (name.upper(), w))
+    out.append("#define %s_HEIGHT %d" % (name.upper(), h))
+    out.append("")
+    out.append("/** RGB565 palette, most used colour first */")
+    out.append("static const uint16_t %sPalette[%d] = {" % (name, len(palette)))
+    for i in range(0, len(palette), 8):
+        out.append("    " + ", ".join("0x%04X" % c for c in palette[i:i + 8]) + ",")
+    out.append("};")
+    out.append("")
+    out.append("/** Run-length coded palette indices, %d x %d pixels */" % (w, h))
+    out.append("static const uint8_t %sData[%d] = {" % (name, len(data)))
+    for i in range(0, len(data), 16):
+        out.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+    out.append("};")
+    out.append("")
+    out.append("static const ImgAsset %sAsset = { %d, %d, %d, %sPalette, %sData, %d };"
+               % (name, w, h, len(palette), name, name, len(data)))
+    out.append("")
+    out.append("#endif /* END %s */" % guard)
+    return "\n".join(out) + "\n"
+
+
+def convert(name, w, h, pixels, source, colours=256, **kw):
+    """Encodes, checks the round trip and returns the header text; summary to stderr."""
+    palette, data, tokens, drop = encode(pixels, colours)
+    if drop:
+        sys.stderr.write("%s: %d low bit(s) per channel dropped to fit %d colours\n" % (name, drop, colours))
+    if decode(w, h, palette, data) != quantize(pixels, colours)[0]:
+        raise AssertionError("%s: round trip mismatch" % name)
+    flash = len(data) + 2 * len(palette)
+    raw = 2 * w * h
+    sys.stderr.write("%s: %dx%d, %d colours, %d tokens, %d bytes flash (raw RGB565 %d, %.1f%%)\n"
+                     % (name, w, h, len(palette), tokens, flash, raw, 100.0 * flash / raw))
+    return header(name, w, h, palette, data, source, **kw)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Convert an image into an espcyd ImgAsset header")
+    ap.add_argument("image")
+    ap.add_argument("-n", "--name", help="C identifier prefix (default: file name)")
+    ap.add_argument("-o", "--output", help="header to write (default: stdout)")
+    ap.add_argument("--colours", type=int, default=256, help="palette size limit, 1..256")
+    ap.add_argument("--background", default="000000", help="RGB hex that alpha is blended onto")
+    args = ap.parse_args()
+
+    name = args.name or args.image.rsplit("/", 1)[-1].rsplit(".", 1)[0]
+    bg = int(args.background, 16)
+    w, h, px = load(args.image)
+    text = convert(name, w, h, to_rgb565(px, ((bg >> 16) & 0xFF, (bg >> 8) & 0xFF, bg & 0xFF)),
+                   args.image.rsplit("/", 1)[-1], max(1, min(256, args.colours)))
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()